@@ -41,9 +41,15 @@
  *  - rstscr()
  *  - delline()
  *  - dellines(cpos_t, cpos_t)
+ *  - insline()
+ *  - deletelines(cpos_t)
+ *  - scroll_region(cpos_t, cpos_t)
  *  - getch()
  *  - getche()
+ *  - getch_timeout(int)
+ *  - getch_n(char*, size_t, int)
  *  - kbhit()
+ *  - kbhit_timeout(int)
  *  - gotox(cpos_t)
  *  - gotoy(cpos_t)
  *  - gotoxy(cpos_t, cpos_t)
@@ -51,29 +57,103 @@
  *  - ungetch(int)
  *  - cputs(const char*)
  *  - cgets(char*)
+ *  - conio_readline(char*)
  *  - cscanf(const char*, ...)
  *  - wherex()
  *  - wherey()
  *  - wherexy(cpos_t*, cpos_t*)
+ *  - conio_cursor_query(), conio_cursor_reply(cpos_t*, cpos_t*, int)
+ *  - conio_session_begin()
+ *  - conio_session_end()
+ *  - conio_cursor_track(int)
+ *  - conio_cursor_sync()
+ *  - conio_flush()
+ *  - conio_setflush(int, unsigned long)
+ *  - conio_setbuf(size_t)
+ *  - conio_frame_begin(), conio_frame_end()
+ *  - conio_setcaps(unsigned int), conio_getcaps()
+ *  - conio_probe(conio_probe_t*)
+ *  - conio_getsize(cpos_t*, cpos_t*)
+ *  - conio_on_resize(conio_size_cb, void*)
+ *  - conio_screen_init(cpos_t, cpos_t)
+ *  - conio_screen_free()
+ *  - conio_screen_clear(uint32_t)
+ *  - conio_screen_invalidate()
+ *  - conio_screen_putc(cpos_t, cpos_t, uint32_t, uint32_t)
+ *  - conio_screen_puts(cpos_t, cpos_t, const char*, uint32_t)
+ *  - conio_present()
+ *  - conio_grid_init(conio_grid_t*, cpos_t, cpos_t), conio_grid_free(conio_grid_t*)
+ *  - conio_grid_at(const conio_grid_t*, cpos_t, cpos_t)
+ *  - conio_grid_diff(const conio_grid_t*, const conio_grid_t*, conio_span_t*)
+ *  - conio_read_event(conio_event_t*)
+ *  - conio_read_events(conio_event_t*, int)
+ *  - conio_loop_new(), conio_loop_free(conio_loop_t*)  (Linux only)
+ *  - conio_loop_on_key(conio_loop_t*, conio_key_cb, void*)
+ *  - conio_loop_on_resize(conio_loop_t*, conio_resize_cb, void*)
+ *  - conio_loop_add_timer(conio_loop_t*, unsigned long, int, conio_timer_cb, void*)
+ *  - conio_loop_remove_timer(conio_loop_t*, int)
+ *  - conio_loop_add_fd(conio_loop_t*, int, int, conio_fd_cb, void*)
+ *  - conio_loop_remove_fd(conio_loop_t*, int)
+ *  - conio_loop_run(conio_loop_t*), conio_loop_run_once(conio_loop_t*, int)
+ *  - conio_loop_stop(conio_loop_t*)
+ *  - conio_loop_add_term(conio_loop_t*, conio_term_t*, conio_term_cb, void*)
+ *  - conio_loop_remove_term(conio_loop_t*, conio_term_t*)
+ *  - conio_set_backend(conio_backend_t*)
+ *  - conio_vterm_init(conio_vterm_t*, cpos_t, cpos_t), conio_vterm_free(conio_vterm_t*)
+ *  - conio_vterm_write(conio_vterm_t*, const char*, size_t)
+ *  - conio_vterm_feed(conio_vterm_t*, const char*, size_t)
+ *  - conio_vterm_cell(conio_vterm_t*, cpos_t, cpos_t)
+ *  - conio_vterm_row(conio_vterm_t*, cpos_t, char*, size_t)
+ *  - conio_term_new(int, int), conio_term_free(conio_term_t*), conio_term_default()
+ *
+ * Every function operating on the terminal also has a `_ctx` variant taking a
+ * terminal context (`conio_term_t*`) as its first argument, for example
+ * `gotoxy_ctx(term, x, y)`, `cscanf_ctx(term, fmt, ...)` or `conio_loop_new_ctx(term)`.
  *
  * @author    Ryuu Mitsuki <dhefam31@gmail.com>
- * @version   0.3.0-beta
- * @date      05 Des 2024
- * @copyright &copy; 2023 - 2024 Ryuu Mitsuki.
+ * @version   0.4.0
+ * @date      16 Okt 2026
+ * @copyright &copy; 2023 - 2026 Ryuu Mitsuki.
  *            Licensed under the GNU General Public License 3.0. All rights reserved.
  */
 
+/* A system header included first under a strict standard has already hidden the POSIX
+ * interfaces; the rest of the header is skipped rather than failing line after line */
+#if defined(__linux__) && defined(_FEATURES_H) && defined(__STRICT_ANSI__) && !defined(CONIO_LT_H_) \
+    && !defined(_DEFAULT_SOURCE) && !defined(_POSIX_C_SOURCE) && !defined(_XOPEN_SOURCE) && !defined(_GNU_SOURCE)
+# error "conio_lt.h: include it before any system header, or compile with -D_DEFAULT_SOURCE"
+# define CONIO_LT_H_
+#endif
+
 #ifndef CONIO_LT_H_
 #define CONIO_LT_H_
 
 /* Header Version */
 #undef  __CONIO_LT_VER__
 /** Represents the version of this header file (`conio_lt.h`) in hexadecimal value */
-#define __CONIO_LT_VER__  0x030
+#define __CONIO_LT_VER__  0x040
+
+/* Feature test macros for the POSIX and Linux interfaces used here (`sigaction()`,
+ * `CLOCK_MONOTONIC`, `SIGWINCH`, epoll and timerfd), which a strict `-std=c99` or
+ * `-std=c11` hides. They only take effect when this header is included before any
+ * system header, otherwise compile with `-D_DEFAULT_SOURCE`.
+ */
+#if defined(__linux__) || defined(__CYGWIN__)
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE  200809L
+# endif  /* _POSIX_C_SOURCE */
+# ifndef _DEFAULT_SOURCE
+#  define _DEFAULT_SOURCE
+# endif  /* _DEFAULT_SOURCE */
+#endif  /* __linux__ || __CYGWIN__ */
 
 /* C standard I/O header */
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>  /* For `atexit()` */
+#include <string.h>
+#include <errno.h>
+#include <time.h>
 
 /* To ensure compatibility between C and C++, preventing name mangling in C++ */
 #ifdef __cplusplus
@@ -265,7 +345,14 @@ typedef unsigned int            uint32_t;  /**< unsigned 32-bit */
  * Because they are only designed for Unix-like (POSIX) environment and not part of standard C libraries.
  */
 #  include <unistd.h>
+#  include <signal.h>   /* Restoring the terminal on fatal signals */
 #  include <termios.h>  /* POSIX header for terminal I/O control */
+#  include <sys/ioctl.h>  /* For `TIOCGWINSZ` */
+#  include <poll.h>
+#  ifdef __linux__
+#    include <sys/epoll.h>    /* For the event loop */
+#    include <sys/timerfd.h>
+#  endif  /* __linux__ */
 #endif  /* _WIN32 || __WIN32__ || __MINGW32__ */
 
 /* Include the 'fcntl.h' header if the compiler have it */
@@ -273,6 +360,20 @@ typedef unsigned int            uint32_t;  /**< unsigned 32-bit */
 # include <fcntl.h>
 #endif
 
+/* x86 intrinsics for the row comparison, the instruction set is chosen at run time */
+#if (defined(__x86_64__) || defined(__i386__)) && ! defined(CONIO_NO_SIMD) \
+    && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+# include <immintrin.h>
+/**
+ * Defined if rows of cells are compared with SSE2 or AVX2 instructions, see
+ * @ref conio_grid_diff(). Define `CONIO_NO_SIMD` before including this header
+ * to use the portable implementation only.
+ *
+ * @since 0.4.0
+ */
+# define CONIO_HAVE_SIMD  1
+#endif  /* x86 && ! CONIO_NO_SIMD && (Clang || GCC >= 4.9) */
+
 /** @{ */
 /**
  * @brief Represents the cursor position type.
@@ -317,764 +418,7614 @@ typedef enum {
     GETCH_USE_ECHO   /**< Represents the option to read a character with send buffer to the terminal. */
 } GETCH_ECHO;
 
+/** Type of an I/O backend, see @ref conio_backend. */
+typedef struct conio_backend conio_backend_t;
+
 /**
- * @brief Retrieves a single character from the standard input without echoing.
+ * @brief An I/O backend replacing the terminal.
  *
- * This function retrieves a character from the standard input without echoing it
- * to the console. It is designed for use in console-based applications
- * where user input needs to be read without displaying the entered characters.
+ * Once installed with @ref conio_set_backend(), every byte written by this library
+ * is passed to @ref output and input is read with @ref input, instead of using the
+ * standard output and input. The terminal settings are left untouched. See
+ * @ref conio_vterm_t for the built-in in-memory terminal.
  *
- * This is designed for internal use only and it is used by these two API functions:
- *   - `getch()` - is an alias for `__getch(GETCH_NO_ECHO)` (without buffer)
- *   - `getche()` - is an alias for `__getch(GETCH_USE_ECHO)` (with buffer)
+ * @since 0.4.0
+ */
+struct conio_backend {
+    /** Receives output bytes. Returns 0 on success, or -1 on error. */
+    int (*output)(conio_backend_t* be, const char* s, size_t n);
+    /**
+     * Reads up to `n` input bytes, waiting up to `timeout_ms` milliseconds (negative
+     * to wait indefinitely). Returns the number of bytes read, 0 if the timeout
+     * expired, or -1 on end of input.
+     */
+    int (*input)(conio_backend_t* be, unsigned char* buf, size_t n, int timeout_ms);
+    /** Stores the screen size. Returns 0 on success, or -1 if unknown. May be `NULL`. */
+    int (*getsize)(conio_backend_t* be, cpos_t* cols, cpos_t* rows);
+};
+
+/**
+ * @brief Internal state of the raw-mode session.
  *
- * @param[in] __echo  Flag indicating whether to echo the input, see @ref GETCH_ECHO enum.
- * @return            The retrieved character from the standard input.
+ * A session keeps the terminal in non-canonical mode (no line buffering and no echo)
+ * between @ref conio_session_begin() and @ref conio_session_end(), so the input
+ * functions do not need to reconfigure the terminal on every call.
  *
- * @note This function is platform-dependent. On Unix systems, it uses `termios.h` header
- *       to customize the terminal settings, while on Windows, it manipulates the
- *       console mode using Windows API (`windows.h`).
+ * @since 0.4.0
+ */
+struct __conio_sess_state {
+    int depth;      /**< Nesting level of `conio_session_begin()` calls, zero if no session. */
+    int virt;       /**< Non-zero if the session runs on a backend, nothing to restore. */
+#ifdef __HAVE_WINDOWS_API
+    DWORD saved;    /**< Console mode to restore when the session ends. */
+#else
+    struct termios saved;  /**< Terminal settings to restore when the session ends. */
+#endif  /* __HAVE_WINDOWS_API */
+};
+
+/**
+ * @brief Internal state of the output buffer.
  *
- * @warning This function may not behave as expected on non-terminal input streams.
- *          It is intended for console-based applications.
+ * Every output function of this library appends its bytes to this buffer, which
+ * is written to the terminal with a single `write(2)` call per flush. The buffer
+ * grows on demand up to @ref limit bytes.
  *
- * @since 0.1.0
+ * @since 0.4.0
  */
-static int __getch(GETCH_ECHO const __echo) {
-    int __c;
+struct __conio_out_state {
+    char*         data;      /**< Buffered bytes, allocated on first use. */
+    size_t        len;       /**< Number of buffered bytes. */
+    size_t        cap;       /**< Allocated size of @ref data. */
+    size_t        limit;     /**< Maximum size before the buffer is flushed, zero for default. */
+    int           policy;    /**< Combination of `CONIO_FLUSH_*` flags. */
+    int           custom;    /**< Non-zero if the policy has been set with `conio_setflush()`. */
+    int           hold;      /**< Nesting level of compound operations that defer flushing. */
+    unsigned long interval;  /**< Flush interval in milliseconds for `CONIO_FLUSH_ON_TIMER`. */
+    unsigned long last;      /**< Time of the last flush in milliseconds. */
+    int           nonblock;  /**< Non-zero if the bytes the terminal does not accept yet are kept. */
+    int           overrun;   /**< Non-zero if output was lost because the backlog was full. */
+    int           frame;     /**< Nesting level of `conio_frame_begin()`. */
+    int           sync;      /**< Non-zero if the current frame is wrapped in synchronized output. */
+};
 
-#if defined(__UNIX_PLATFORM) || ! defined(__HAVE_WINDOWS_API)
-    /* Internal '__getch' function implementation for Unix systems and unimplemented Windows API */
-    struct termios __oldterm, __newterm;
+/**
+ * @brief Internal state of the shadow cursor model.
+ *
+ * When cursor tracking is enabled (see @ref conio_cursor_track()), the library keeps
+ * its own copy of the cursor position, updated by every output function of this
+ * library. The coordinates are 1-based, like the ones reported by the terminal.
+ *
+ * @since 0.4.0
+ */
+struct __conio_cur_state {
+    int    enabled;  /**< Non-zero if tracking is enabled. */
+    int    valid;    /**< Non-zero if @ref x and @ref y match the terminal cursor. */
+    cpos_t x;        /**< Current column (1-based). */
+    cpos_t y;        /**< Current row (1-based). */
+    cpos_t cols;     /**< Terminal width, zero if unknown. */
+    cpos_t rows;     /**< Terminal height, zero if unknown. */
+    int    wrap;     /**< Non-zero if the next printable character wraps to the next line. */
+    int    crlf;     /**< Non-zero if the terminal translates `'\n'` to `"\r\n"`. */
+    int    esc;      /**< Escape sequence parser state, see @ref __conio_cur_advance. */
+    cpos_t top;      /**< First row of the scrolling region set with `scroll_region()`, zero if none. */
+    cpos_t bottom;   /**< Last row of that scrolling region, zero if none. */
+};
 
-    tcgetattr(STDIN_FILENO, &__oldterm);
-    __newterm = __oldterm;  /* Copy the original terminal setting */
-    __newterm.c_lflag &= ~ICANON;
+#ifndef CONIO_INBUF_SIZE
+/**
+ * Size of the input read-ahead buffer in bytes. The default matches the input
+ * buffer of the terminal driver, so a paste is drained with one read per 4 KB.
+ */
+#  define CONIO_INBUF_SIZE  4096
+#endif  /* CONIO_INBUF_SIZE */
 
-    if (__echo) __newterm.c_lflag &= ECHO;   /* With echo */
-    else __newterm.c_lflag &= ~ECHO;  /* Without echo */
+#ifndef CONIO_QUERY_TIMEOUT
+/** Time in milliseconds to wait for the terminal to answer a query before giving up. */
+#  define CONIO_QUERY_TIMEOUT  500
+#endif  /* CONIO_QUERY_TIMEOUT */
 
-    tcsetattr(STDIN_FILENO, TCSANOW, &__newterm);  /* Apply the customized terminal setting */
-    __c = getchar();                               /* Retrieve the character */
-    tcsetattr(STDIN_FILENO, TCSANOW, &__oldterm);  /* Restore original terminal setting */
-#else  /* '__getch' function implementation for Windows */
-    HANDLE handler = GetStdHandle(STD_INPUT_HANDLE);
-    DWORD console_mode, original_mode;
+/**
+ * Time in milliseconds to wait for the rest of an escape sequence before a lone
+ * escape byte is reported as the Escape key.
+ */
+#ifndef CONIO_ESC_DELAY
+#  define CONIO_ESC_DELAY  25
+#endif  /* CONIO_ESC_DELAY */
 
-    GetConsoleMode(handler, &console_mode);
-    original_mode = console_mode;  /* Copy the original console setting */
+#ifndef CONIO_CPR_MAX
+/** Maximum number of cursor position queries awaiting their reply (at most 32), see @ref conio_cursor_query(). */
+#  define CONIO_CPR_MAX  8
+#endif  /* CONIO_CPR_MAX */
 
-    /* Set the console mode to disable line input and optionally disable echo input */
-    console_mode &= ~ENABLE_LINE_INPUT;
-    /* If echoing is required, include echo input in the console mode */
-    if (__echo) console_mode &= ENABLE_ECHO_INPUT;
-    /* If echoing is not required, exclude echo input from the console mode */
-    else console_mode &= ~ENABLE_ECHO_INPUT;
+#ifndef CONIO_HISTORY_SIZE
+/** Number of lines remembered by @ref conio_readline(), the oldest one is forgotten first. */
+#  define CONIO_HISTORY_SIZE  64
+#endif  /* CONIO_HISTORY_SIZE */
 
-    /* Apply the customized console setting */
-    SetConsoleMode(handler, console_mode);
+/**
+ * @brief Internal state of the input read-ahead buffer.
+ *
+ * Bytes in `buf[head .. tail)` have been read from the terminal but not yet
+ * consumed. The buffer is filled with a single `read(2)` of everything that is
+ * available, so a burst of input (an escape sequence, pasted text) is read
+ * with one system call.
+ *
+ * @since 0.4.0
+ */
+struct __conio_in_state {
+    unsigned char buf[CONIO_INBUF_SIZE];  /**< Buffered bytes. */
+    size_t        head;                   /**< Index of the first unconsumed byte. */
+    size_t        tail;                   /**< Index past the last buffered byte. */
+    int           pending;                /**< Cursor position queries whose reply has not arrived yet. */
+    int           replies;                /**< Replies received but not retrieved yet. */
+    int           first;                  /**< Index of the oldest of them in @ref rx and @ref ry. */
+    cpos_t        rx[CONIO_CPR_MAX];      /**< Columns of the received replies. */
+    cpos_t        ry[CONIO_CPR_MAX];      /**< Rows of the received replies. */
+    unsigned int  drop;                   /**< Entries of abandoned queries, one bit per index. */
+    unsigned long drop_at;                /**< When the last query was abandoned, see @ref __conio_now_ms. */
+    int           late;                   /**< Replies to a timed out probe that may still arrive. */
+};
 
-    /* Read a single character from the console input buffer */
-    DWORD dwRead = 0;
-    char buffer[1];
-    ReadConsole(handler, buffer, 1, &dwRead, NULL);
-    __c = buffer[0];  /* Extract the retrieved character */
+/**
+ * @brief Internal state of the off-screen buffer.
+ *
+ * The back buffer is drawn into by the application, the front buffer holds what
+ * has been presented to the terminal. @ref conio_present() writes the difference.
+ *
+ * @since 0.4.0
+ */
+struct __conio_scr_state {
+    struct conio_cell* back;   /**< Cells drawn by the application. */
+    struct conio_cell* front;  /**< Cells currently displayed by the terminal. */
+    uint32_t*          bhash;  /**< Hash of every row of the back buffer, see @ref __conio_scr_scroll. */
+    uint32_t*          fhash;  /**< Hash of every row of the front buffer, zero if not known. */
+    uint64_t*          dirty;  /**< One bit per row, set if the row may differ from the front buffer. */
+    cpos_t*            dmin;   /**< First column (0-based) written in every dirty row. */
+    cpos_t*            dmax;   /**< Last column (0-based) written in every dirty row. */
+    cpos_t             cols;   /**< Width of the buffers. */
+    cpos_t             rows;   /**< Height of the buffers. */
+    cpos_t             tcols;  /**< Width of the terminal when the buffers were allocated, zero if unknown. */
+    cpos_t             trows;  /**< Height of the terminal when the buffers were allocated, zero if unknown. */
+};
 
-    /* Restore original console mode */
-    SetConsoleMode(handler, original_mode);
-#endif  /* (__unix__ || __unix) || __ANDROID__ */
-    return __c;  /* Return the retrieved character */
-}
+/** Type of a terminal context, see @ref conio_term_new(). */
+typedef struct conio_term conio_term_t;
 
+/**
+ * @name Terminal capabilities
+ *
+ * Optional control sequences the terminal understands, see @ref conio_setcaps().
+ *
+ * @since 0.4.0
+ * @{
+ */
+#define CONIO_CAP_EL       0x01  /**< Erase in line (`EL`, `"\033[K"`), every VT100 compatible terminal. */
+#define CONIO_CAP_ECH      0x02  /**< Erase characters (`ECH`, `"\033[{n}X"`), VT220 and later. */
+#define CONIO_CAP_REP      0x04  /**< Repeat the preceding character (`REP`, `"\033[{n}b"`), xterm and ECMA-48. */
+#define CONIO_CAP_SYNC     0x08  /**< Synchronized output (mode 2026, `"\033[?2026h"`), see `conio_frame_begin()`. */
+#define CONIO_CAP_DEFAULT  CONIO_CAP_EL  /**< Capabilities assumed until @ref conio_setcaps() is called. */
+/** @} */
 
 /**
- * @brief Retrieves the current coordinates of the cursor on the terminal screen.
+ * @brief What the terminal reported about itself, see @ref conio_probe().
  *
- * This function is designed to work on both Unix-like systems and Windows. On Unix-like
- * systems, it uses ANSI escape sequences to query the cursor position. On Windows, it
- * utilizes the Windows Console API to obtain the cursor coordinates.
+ * The modes hold the state reported by `DECRQM`: 0 if the mode is not recognized
+ * (or not reported), 1 if set, 2 if reset, 3 if permanently set, 4 if permanently reset.
  *
- * This function is designed for internal use only and it is being used by these API functions:
- *   - `wherex()`                  - Retrieves the current X-coordinate of the cursor position
- *   - `wherey()`                  - Retrieves the current Y-coordinate of the cursor position
- *   - `wherexy(cpos_t*, cpos_t*)` - Retrieves the current both coordinates of the cursor position
- *                                   stored in provided pointer variables
+ * @since 0.4.0
+ */
+typedef struct conio_probe {
+    int          done;       /**< Non-zero once the terminal has been probed. */
+    int          answered;   /**< Non-zero if the terminal answered. */
+    unsigned int level;      /**< Conformance level from `DA1` (1 for a VT100, 62 for a VT220, ...), zero if unknown. */
+    int          type;       /**< Terminal type from `DA2` (1 for a VT220, 41 for xterm, ...), -1 if unknown. */
+    int          version;    /**< Firmware version from `DA2`, -1 if unknown. */
+    char         name[64];   /**< Name and version from `XTVERSION`, such as `"xterm(390)"`, empty if unknown. */
+    int          sync;       /**< Synchronized output, mode 2026. */
+    int          paste;      /**< Bracketed paste, mode 2004. */
+    int          altscreen;  /**< Alternate screen, mode 1049. */
+    int          focus;      /**< Focus events, mode 1004. */
+    cpos_t       x;          /**< Cursor column at the time of the probe, zero if unknown. */
+    cpos_t       y;          /**< Cursor row at the time of the probe, zero if unknown. */
+    unsigned int caps;       /**< The `CONIO_CAP_*` capabilities deduced from the replies. */
+} conio_probe_t;
+
+/** Callback for terminal resizes, see @ref conio_on_resize(). */
+typedef void (*conio_size_cb)(conio_term_t* term, cpos_t cols, cpos_t rows, void* user);
+
+/**
+ * @brief Internal state of the cached terminal size.
  *
- * @param[in,out] __px  Pointer to a variable where the X-coordinate of the cursor will be stored.
- * @param[in,out] __py  Pointer to a variable where the Y-coordinate of the cursor will be stored.
+ * See @ref conio_getsize().
  *
- * @note For Unix-like systems, this function sends the ANSI escape sequence `"\033[6n"`
- *       to the terminal and parses the response to obtain cursor coordinates. On Windows,
- *       it uses the Windows Console API to get the cursor position.
+ * @since 0.4.0
+ */
+struct __conio_win_state {
+    cpos_t        cols;     /**< Cached number of columns, zero if unknown. */
+    cpos_t        rows;     /**< Cached number of rows, zero if unknown. */
+    int           valid;    /**< Non-zero once the size has been read. */
+    int           hooked;   /**< Non-zero if the context holds a reference to the `SIGWINCH` handler. */
+    long          gen;      /**< Number of `SIGWINCH` received when the size was read. */
+    conio_size_cb on_size;  /**< Resize callback, `NULL` if none. */
+    void*         user;     /**< User data of @ref on_size. */
+};
+
+/**
+ * @brief Internal state of the line editor history.
  *
- * @warning This function may not work correctly in all terminal emulators or environments,
- *          especially if the terminal does not support ANSI escape sequences. Ensure that your
- *          target environment supports the necessary features.
+ * See @ref conio_readline(). The lines are kept in a ring of fixed-size slots, each
+ * holding a length byte and up to 255 bytes of text. Two more slots hold the text
+ * killed last and the new line while the history is browsed.
  *
- * @since 0.1.0
- * @see   wherexy(cpos_t*, cpos_t*)
+ * @since 0.4.0
  */
-static void __whereis_xy(cpos_t* __px, cpos_t* __py) {
-    cpos_t x = 0, y = 0;  /* Variables to hold the coordinates */
+struct __conio_hist_state {
+    unsigned char* slots;  /**< `CONIO_HISTORY_SIZE + 2` slots of 256 bytes, allocated on first use. */
+    int            first;  /**< Slot of the oldest line. */
+    int            count;  /**< Number of lines. */
+};
+
+#define __CONIO_HIST_KILL   CONIO_HISTORY_SIZE        /**< Slot of the text killed last. */
+#define __CONIO_HIST_SAVED  (CONIO_HISTORY_SIZE + 1)  /**< Slot of the new line while the history is browsed. */
+
+/**
+ * @brief Internal state of a context served by an event loop.
+ *
+ * See @ref conio_loop_add_term().
+ *
+ * @since 0.4.0
+ */
+struct __conio_srv_state {
+    struct conio_loop*    loop;    /**< The event loop serving the context, `NULL` if none. */
+    struct __conio_watch* watch;   /**< Watch of the input file descriptor. */
+    conio_term_t**        list;    /**< Head of the list of contexts with output to write. */
+    conio_term_t*         next;    /**< Next context in that list. */
+    int                   queued;  /**< Non-zero if the context is in that list. */
+};
+
+/**
+ * @brief A terminal context.
+ *
+ * Holds everything this library keeps about one terminal: its file descriptors or
+ * backend, the raw-mode session, the output and input buffers, the cursor model and
+ * the off-screen buffer. The functions without the `_ctx` suffix operate on the
+ * default context, which uses the standard input and output.
+ *
+ * @since 0.4.0
+ */
+struct conio_term {
+    int                       in_fd;    /**< Input file descriptor. */
+    int                       out_fd;   /**< Output file descriptor. */
+    conio_backend_t*          be;       /**< The installed backend, `NULL` if the file descriptors are used. */
+    struct __conio_sess_state sess;     /**< The raw-mode session. */
+    struct __conio_out_state  out;      /**< The output buffer. */
+    struct __conio_cur_state  cur;      /**< The shadow cursor model. */
+    struct __conio_in_state   in;       /**< The input read-ahead buffer. */
+    struct __conio_scr_state  scr;      /**< The off-screen buffer. */
+    struct __conio_srv_state  srv;      /**< The event loop serving the context. */
+    struct __conio_win_state  win;      /**< The cached terminal size. */
+    struct __conio_hist_state hist;     /**< The line editor history. */
+    unsigned int              caps;     /**< The `CONIO_CAP_*` capabilities of the terminal. */
+    unsigned int              known;    /**< The capabilities that have been set or probed, the others are assumed. */
+    conio_probe_t             probe;    /**< The results of @ref conio_probe(). */
+    conio_term_t*             next;     /**< Next context in @ref __conio_terms. */
+};
+
+/** The default context, using the standard input and output. */
+static conio_term_t __conio_def = {
+#ifdef __cplusplus
+    STDIN_FILENO, STDOUT_FILENO, NULL, {}, {}, {}, {}, {}, {}, {}, {}, CONIO_CAP_DEFAULT, 0, {}, NULL
+#else
+    STDIN_FILENO, STDOUT_FILENO, NULL, { 0 }, { 0 }, { 0 }, { { 0 }, 0, 0, 0, 0, 0, { 0 }, { 0 }, 0, 0, 0 }, { 0 }, { 0 }, { 0 }, { 0 }, CONIO_CAP_DEFAULT, 0, { 0 }, NULL
+#endif  /* __cplusplus */
+};
+
+/** All contexts, so they can be restored and flushed on exit. */
+static conio_term_t* __conio_terms = &__conio_def;
 
+#ifndef __HAVE_WINDOWS_API
+/** Signals that terminate the process, the terminal is restored before they take effect. */
+static int const __conio_fatal_sigs[] = {
+    SIGHUP, SIGINT, SIGQUIT, SIGTERM, SIGABRT, SIGSEGV, SIGBUS, SIGFPE, SIGILL
+};
+
+/** Number of entries in @ref __conio_fatal_sigs. */
+#define __CONIO_NFATAL  (sizeof(__conio_fatal_sigs) / sizeof(__conio_fatal_sigs[0]))
+
+/** Signal dispositions that were installed before the first session began. */
+static struct sigaction __conio_old_sigs[__CONIO_NFATAL];
+#endif  /* ! __HAVE_WINDOWS_API */
+
+/** Number of contexts with an active session that changed the terminal settings. */
+static int __conio_nsess;
+
+/** Non-zero once the `atexit` handler of the sessions has been registered. */
+static int __conio_sess_hooked;
+
+/**
+ * @brief Restores the terminal settings saved by @ref conio_session_begin().
+ *
+ * Only uses async-signal-safe calls, so it can be called from the signal handler.
+ *
+ * @since 0.4.0
+ */
+static void __conio_sess_restore(conio_term_t* __t) {
+    if (__t->sess.virt) return;
 #ifdef __HAVE_WINDOWS_API
-    HANDLE handler = GetStdHandle(STD_OUTPUT_HANDLE);
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    SetConsoleMode(GetStdHandle(STD_INPUT_HANDLE), __t->sess.saved);
+#else
+    tcsetattr(__t->in_fd, TCSANOW, &__t->sess.saved);
+#endif  /* __HAVE_WINDOWS_API */
+}
 
-    if (GetConsoleScreenBufferInfo(handler, &csbi)) {
-        /* The coordinates are zero-based, it is unnecessary
-         * to add one to each coordinate
-         */
-        x = csbi.dwCursorPosition.X;
-        y = csbi.dwCursorPosition.Y;
+/**
+ * @brief Handler registered with `atexit()` to restore the terminals on normal exit.
+ *
+ * @since 0.4.0
+ */
+static void __conio_sess_atexit(void) {
+    conio_term_t* t;
+    for (t = __conio_terms; t; t = t->next) {
+        if (t->sess.depth <= 0) continue;
+        __conio_sess_restore(t);
+        t->sess.depth = 0;
     }
-#else  /* Body function for Unix-like systems */
-    printf("%s[6n", ESC);
-
-    /* If the input character neither equal with '0x1B' (escape character)
-     * nor '0x5B' ('['), then return (leaving the '__px' and '__py' references
-     * unmodified) because it was unable to get current position of cursor.
-     */
-    if ((__getch(GETCH_NO_ECHO) != 0x1B)
-        ^ (__getch(GETCH_NO_ECHO) != 0x5B)) return;
+    __conio_nsess = 0;
+}
 
-    int temp;
-    while ((temp = __getch(GETCH_NO_ECHO)) != 0x3B /* ';' */) {
-        y = y * 10 + (temp - '0');
+#ifndef __HAVE_WINDOWS_API
+/**
+ * @brief Handler for fatal signals received while a session is active.
+ *
+ * Restores the terminals, reinstates the disposition that was in effect before
+ * the first session began and raises the signal again, so the process terminates
+ * (or the application handler runs) as if `conio_lt` was not involved.
+ *
+ * @param[in] __sig  The received signal number.
+ *
+ * @since 0.4.0
+ */
+static void __conio_sess_on_signal(int __sig) {
+    unsigned int i;
+    conio_term_t* t;
+    for (t = __conio_terms; t; t = t->next) {
+        if (t->sess.depth <= 0) continue;
+        __conio_sess_restore(t);
+        t->sess.depth = 0;
     }
+    __conio_nsess = 0;
 
-    while ((temp = __getch(GETCH_NO_ECHO)) != 0x52 /* 'R' */) {
-        x = x * 10 + (temp - '0');
+    for (i = 0; i < __CONIO_NFATAL; i++) {
+        if (__conio_fatal_sigs[i] == __sig) {
+            sigaction(__sig, &__conio_old_sigs[i], NULL);
+            break;
+        }
     }
-#endif  /* __HAVE_WINDOWS_API */
-    /* Store and assign the cursor position */
-    *__px = x;
-    *__py = y;
+    raise(__sig);
 }
+#endif  /* ! __HAVE_WINDOWS_API */
+
+/**
+ * @brief Same as @ref conio_session_begin(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_session_begin_ctx(conio_term_t* term) {
+    if (term->sess.depth > 0) {
+        term->sess.depth++;
+        return 0;
+    }
+    /* A backend has no terminal settings */
+    term->sess.virt = (term->be != NULL);
+    if (term->sess.virt) {
+        term->sess.depth = 1;
+        return 0;
+    }
+
+#ifdef __HAVE_WINDOWS_API
+    HANDLE handler = GetStdHandle(STD_INPUT_HANDLE);
+    DWORD console_mode;
+
+    if (!GetConsoleMode(handler, &term->sess.saved)) return -1;
+    console_mode = term->sess.saved & ~(ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT);
+    if (!SetConsoleMode(handler, console_mode)) return -1;
+#else
+    struct termios rawterm;
+    struct sigaction action;
+    unsigned int i;
+
+    if (tcgetattr(term->in_fd, &term->sess.saved) != 0) return -1;
+    rawterm = term->sess.saved;  /* Copy the original terminal setting */
+    rawterm.c_lflag &= ~(ICANON | ECHO);
+    rawterm.c_cc[VMIN]  = 1;  /* Block until at least one byte is available */
+    rawterm.c_cc[VTIME] = 0;
+    if (tcsetattr(term->in_fd, TCSANOW, &rawterm) != 0) return -1;
 
+    /* Restore the terminals before any fatal signal takes effect */
+    if (__conio_nsess == 0) {
+        action.sa_handler = __conio_sess_on_signal;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = 0;
+        for (i = 0; i < __CONIO_NFATAL; i++) {
+            sigaction(__conio_fatal_sigs[i], &action, &__conio_old_sigs[i]);
+        }
+    }
+#endif  /* __HAVE_WINDOWS_API */
 
+    if (!__conio_sess_hooked) {
+        atexit(__conio_sess_atexit);
+        __conio_sess_hooked = 1;
+    }
+    __conio_nsess++;
+    term->sess.depth = 1;
+    return 0;
+}
 
 /**
- * @brief Moves the cursor to the specified coordinates on the terminal screen.
+ * @brief Puts the terminal into non-canonical, no-echo mode until @ref conio_session_end().
  *
- * This function moves the cursor to the specified (`x`, `y`) position on the terminal screen.
- * On Windows, it utilizes the [`SetConsoleCursorPosition`](https://learn.microsoft.com/en-us/windows/console/setconsolecursorposition)
- * function provided by `windows.h`, and on Unix-like systems, it uses ANSI escape sequences
- * to achieve the same effect.
+ * Without a session every call to `getch()`, `getche()`, `kbhit()` or `wherexy()`
+ * switches the terminal into non-canonical mode and back again. Inside a session the
+ * terminal is configured once, so these functions only read from the already
+ * configured terminal, and bytes typed between two calls are never echoed in
+ * canonical mode.
  *
- * @param[in] x  The horizontal (column) position to move the cursor to.
- * @param[in] y  The vertical (row) position to move the cursor to.
+ * Sessions can be nested, only the outermost call changes the terminal settings.
+ * The original settings are restored exactly once: by the matching outermost
+ * @ref conio_session_end(), on normal process exit, or when a fatal signal
+ * (`SIGINT`, `SIGTERM`, `SIGSEGV`, ...) is received.
  *
  * Example
  * -------
  * ```c
- * // Move the cursor to the top-left
- * gotoxy(0, 0);
+ * conio_session_begin();
+ * while ((c = getch()) != 'q') {
+ *     // handle key
+ * }
+ * conio_session_end();
  * ```
  *
- * @note On Unix-like systems, this function uses the ANSI escape sequence `"\033[{y};{x}H"`
- *       to move the cursor to the specified position. It supports both **MSYS2** and
- *       **Cygwin** environments. However, the behavior may vary across different terminals.
+ * @return Returns 0 on success, or -1 if the standard input is not a terminal.
  *
- * @attention The ANSI escape sequence used on Unix-like systems might not be supported
- *            by all terminals.
+ * @note In C++, the @ref conio_session_guard class begins the session in its
+ *       constructor and ends it in its destructor.
  *
- * @since 0.1.0
+ * @since 0.4.0
+ * @see   conio_session_end(void)
  */
-void gotoxy(cpos_t const x, cpos_t const y) {
-#ifdef __HAVE_WINDOWS_API  /* For Windows */
-    HANDLE handler = GetStdHandle(STD_OUTPUT_HANDLE);
-    if (handler != INVALID_HANDLE_VALUE) {
-        COORD coord;
-        coord.X = (SHORT)x;
-        coord.Y = (SHORT)y;
-        SetConsoleCursorPosition(handler, coord);
-    }
-#else
-    printf("%s[%u;%uH", ESC, y, x);  /* Use the correct ANSI escape sequence */
-#endif  /* __HAVE_WINDOWS_API */
+int conio_session_begin(void) {
+    return conio_session_begin_ctx(&__conio_def);
 }
 
 /**
- * @brief Clears without resetting the terminal screen.
- *
- * This function provides a platform-dependent way to clear the terminal screen.
- * On Windows, it uses the system command `"cls"` for Command Prompt or PowerShell.
- * On Unix-like systems, it uses ANSI escape sequences for clearing the screen
- * (including the **MSYS2** and **Cygwin** environment).
+ * @brief Same as @ref conio_session_end(), on the given terminal context.
  *
- * On Windows systems, this function uses the Windows API `cls` command. On Unix-like
- * systems, this function uses the following control sequences.
+ * @param[in] term  The terminal context.
  *
- * | Control sequence | Description                                                            |
- * | ---------------- | ---------------------------------------------------------------------- |
- * | `"\033[0m"`      | Resets any text formatting or color attributes.                        |
- * | `"\033[1J"`      | Clears the screen from the cursor position to the end of the screen.   |
- * | `"\033[H"`       | Moves the cursor to the top-left corner of the screen (home position). |
+ * @since 0.4.0
+ */
+void conio_session_end_ctx(conio_term_t* term) {
+    if (term->sess.depth <= 0) return;
+    if (--term->sess.depth > 0) return;
+    if (term->sess.virt) return;
+
+    __conio_sess_restore(term);
+    if (--__conio_nsess > 0) return;
+
+#ifndef __HAVE_WINDOWS_API
+    {
+        unsigned int i;
+        for (i = 0; i < __CONIO_NFATAL; i++) {
+            sigaction(__conio_fatal_sigs[i], &__conio_old_sigs[i], NULL);
+        }
+    }
+#endif  /* ! __HAVE_WINDOWS_API */
+}
+
+/**
+ * @brief Ends the session started by @ref conio_session_begin().
  *
- * By combining these control sequences in a single `printf` statement,
- * the function achieves the effect of clearing the terminal screen.
+ * Restores the terminal settings that were in effect before the outermost
+ * @ref conio_session_begin() call. Calls matching an inner (nested) begin only
+ * decrement the nesting level; calling this function without an active session
+ * does nothing.
  *
- * @note
- * - On Unix-like systems, ANSI escape sequences are used. Some terminals may not
- *   support these sequences, affecting the clearing functionality.
- * - This function does not prevent the screen from scrolling. If you want to reset
- *   entire the screen, use the @ref rstscr() instead.
+ * @since 0.4.0
+ * @see   conio_session_begin(void)
+ */
+void conio_session_end(void) {
+    conio_session_end_ctx(&__conio_def);
+}
+
+/**
+ * @name Output flush policies
  *
- * @attention This function relies on system-specific commands and escape sequences, and
- *            its behavior may not be consistent across all terminals or environments.
- *            Usage in environments like **Cygwin** or **MSYS2** on Windows may use control
- *            sequences instead, but it might not behave as expected.
+ * Flags for @ref conio_setflush() that control when the output buffer is written
+ * to the terminal. The buffer is always flushed when it is full, when the cursor
+ * position is queried, and by @ref conio_flush().
  *
- * @since 0.1.0
- * @see   rstscr(void)
+ * @since 0.4.0
+ * @{
  */
-void clrscr(void) {
-/* Windows system but not using the Cygwin neither MSYS2 environment,
- * which means it uses the Command Prompt or PowerShell
+#define CONIO_FLUSH_IMMEDIATE  0x01  /**< Flush at the end of every output function (default). */
+#define CONIO_FLUSH_ON_INPUT   0x02  /**< Flush before waiting for input (default). */
+#define CONIO_FLUSH_ON_TIMER   0x04  /**< Flush when the configured interval has passed since the last flush. */
+/** @} */
+
+/** Default maximum size of the output buffer in bytes, see @ref conio_setbuf(). */
+#define CONIO_OUTBUF_DEFAULT   4096
+
+#ifndef CONIO_OUTBUF_BACKLOG
+/**
+ * Maximum number of bytes kept for a terminal served by an event loop that does not
+ * accept its output fast enough, see @ref conio_loop_add_term().
  */
-#if defined(__WIN_PLATFORM_32) && ! defined(__CYGWIN_ENV)
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    if (hConsole != INVALID_HANDLE_VALUE) {
-        CONSOLE_SCREEN_BUFFER_INFO csbi;
-        if (GetConsoleScreenBufferInfo(hConsole, &csbi)) {
-            COORD lineStart = { 0, 0 };  /* Start of the current line */
-            DWORD dw;
+#  define CONIO_OUTBUF_BACKLOG  (256 * 1024)
+#endif  /* CONIO_OUTBUF_BACKLOG */
 
-            FillConsoleOutputCharacter(hConsole, ' ', csbi.dwSize.X * csbi.dwSize.Y, lineStart, &dw);
-            SetConsoleCursorPosition(hConsole, lineStart);
-        }
-    }
-/* Windows system but using Cygwin or MSYS2 environment, or Unix-like systems */
+/**
+ * @brief Returns a monotonic timestamp in milliseconds.
+ *
+ * @since 0.4.0
+ */
+static unsigned long __conio_now_ms(void) {
+#ifdef __HAVE_WINDOWS_API
+    return (unsigned long)GetTickCount();
 #else
-    printf("%s[0m%s[1J%s[H", ESC, ESC, ESC);
-#endif  /* __WIN_PLATFORM_32 && ! __CYGWIN_ENV */
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000UL + (unsigned long)(ts.tv_nsec / 1000000L);
+#endif  /* __HAVE_WINDOWS_API */
 }
 
 /**
- * @brief Resets and clears the terminal screen.
+ * @brief Writes bytes directly to the standard output file descriptor.
  *
- * This function provides a platform-dependent way to reset and clear the terminal screen.
- * On Windows, it uses the system command `"cls"` for Command Prompt or PowerShell.
- * On Unix-like systems, it uses ANSI escape sequences for clearing the screen
- * (including the **MSYS2** and **Cygwin** environment).
+ * Retries on interrupted and partial writes. If a backend is installed, the
+ * bytes are passed to it instead.
  *
- * On Windows systems, there is no difference between this function and @ref clrscr(),
- * because they both function are used `"cls"` command, which is Windows built-in
- * command and utilizes the `system` function to execute shell command within C code
- * from `windows.h` header.
+ * @param[in] __s  The bytes to write.
+ * @param[in] __n  The number of bytes.
+ * @return         Returns 0 on success, or -1 on error.
  *
- * On Unix-like systems, this function uses the following control sequences.
+ * @since 0.4.0
+ */
+static int __conio_write(conio_term_t* __t, const char* __s, size_t __n) {
+    if (__t->be) return __t->be->output(__t->be, __s, __n);
+
+    /* Keep the order with anything already written through `stdout` */
+    if (__t->out_fd == STDOUT_FILENO) fflush(stdout);
+
+#ifdef __HAVE_WINDOWS_API
+    if (fwrite(__s, 1, __n, stdout) != __n) return -1;
+    return fflush(stdout) == 0 ? 0 : -1;
+#else
+    while (__n > 0) {
+        ssize_t w = write(__t->out_fd, __s, __n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        __s += w;
+        __n -= (size_t)w;
+    }
+    return 0;
+#endif  /* __HAVE_WINDOWS_API */
+}
+
+/**
+ * @brief Writes as much of the buffered output as a non-blocking terminal accepts.
  *
- * | Control sequence | Description                                     |
- * | ---------------- | ----------------------------------------------- |
- * | `"\033[0m"`      | Resets any text formatting or color attributes. |
- * | `"\033c"`        | Resets and clears the entire terminal screen.   |
+ * The bytes that are not accepted are kept at the start of the buffer.
  *
- * By combining these control sequences in a single `printf` statement,
- * the function achieves the effect of resetting and clearing the terminal
- * screen.
+ * @return Returns 0 on success, or -1 if writing failed (the buffer is discarded).
  *
- * @note
- * - On Unix-like systems, ANSI escape sequences are used. Some terminals may not
- *   support these sequences, affecting the clearing functionality. However on Windows,
- *   this function utilizes the Windows API `cls` command.
- * - This function prevents the screen from scrolling by clearing the entire screen.
- *   If you only want to clear the screen without preventing scrolling and resetting,
- *   consider using the @ref clrscr() function. But in Windows systems, both
- *   functions will behave the same due to use of `"cls"` command in both functions.
+ * @since 0.4.0
+ */
+static int __conio_out_drain(conio_term_t* __t) {
+#ifdef __HAVE_WINDOWS_API
+    int ret = __conio_write(__t, __t->out.data, __t->out.len);
+    __t->out.len = 0;
+    return ret;
+#else
+    size_t done = 0;
+    while (done < __t->out.len) {
+        ssize_t w = write(__t->out_fd, __t->out.data + done, __t->out.len - done);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            __t->out.len = 0;
+            return -1;
+        }
+        done += (size_t)w;
+    }
+    if (done > 0) {
+        memmove(__t->out.data, __t->out.data + done, __t->out.len - done);
+        __t->out.len -= done;
+    }
+    return 0;
+#endif  /* __HAVE_WINDOWS_API */
+}
+
+/**
+ * @brief Writes the buffered output to the terminal.
  *
- * @attention This function relies on system-specific commands and escape sequences, and
- *            its behavior may not be consistent across all terminals or environments.
- *            Usage in environments like **Cygwin** or **MSYS2** on Windows may use control
- *            sequences instead, but it might not behave as expected.
+ * @return Returns 0 on success, or -1 if writing failed (the buffer is discarded).
  *
- * @since 0.2.0
- * @see   clrscr(void)
- */
-void rstscr(void) {
-/* Windows system but not using the Cygwin neither MSYS2 environment,
- * which means it uses the Command Prompt or PowerShell
+ * @since 0.4.0
  */
-#if defined(__WIN_PLATFORM_32) && ! defined(__CYGWIN_ENV)
-    system("cls");
-/* Unix-like systems (including the MSYS2 and Cygwin environment) */
-#else
-    printf("%s[0m%sc", ESC, ESC);  /* "\033[0m\033c" */
-#endif  /* __WIN_PLATFORM_32 && ! __CYGWIN_ENV */
+static int __conio_out_flush(conio_term_t* __t) {
+    int ret = 0;
+    if (__t->out.len > 0) {
+        if (__t->out.nonblock && !__t->be) {
+            ret = __conio_out_drain(__t);
+        } else {
+            ret = __conio_write(__t, __t->out.data, __t->out.len);
+            __t->out.len = 0;
+        }
+    }
+    __t->out.last = __conio_now_ms();
+    return ret;
 }
 
+/** Non-zero once the `atexit` handler of the output buffers has been registered. */
+static int __conio_out_hooked;
 
 /**
- * @brief Pushes a character back onto the input stream.
+ * @brief Handler registered with `atexit()` to write any output still buffered.
  *
- * This function pushes a character back onto the input stream.
- * It takes an integer parameter `c`, representing the character to be pushed back.
+ * @since 0.4.0
+ */
+static void __conio_out_atexit(void) {
+    conio_term_t* t;
+    for (t = __conio_terms; t; t = t->next) {
+        __conio_out_flush(t);
+        if (t->out.sync) __conio_write(t, ESC "[?2026l", 8);  /* Ends an unfinished frame */
+        free(t->out.data);
+        t->out.data = NULL;
+        t->out.cap = 0;
+    }
+}
+
+/**
+ * @brief Adds the context to the list of contexts whose output its event loop writes.
  *
- * @param[in] c  The character to be pushed back.
- * @return       Returns the pushed-back character on success, or `EOF` on failure.
+ * Does nothing unless the context is served by an event loop.
  *
- * @since 0.1.0
- * @see   getch(void)
- * @see   getche(void)
+ * @since 0.4.0
  */
-int ungetch(int const c) {
-    return ungetc(c, stdin);
+static void __conio_out_queue(conio_term_t* __t) {
+    if (!__t->srv.list || __t->srv.queued) return;
+    __t->srv.queued = 1;
+    __t->srv.next = *__t->srv.list;
+    *__t->srv.list = __t;
 }
 
 /**
- * @brief Reads a single character from the standard input without buffer.
+ * @brief Makes room for more bytes in the output buffer.
  *
- * This function reads a single character from the standard input without buffer.
- *
- * Example
- * -------
- * ```c
- * // You can either use `char` or `int`, it is up to your preference
- * char c = getch();  // Wait until user input a character
- * ```
+ * The buffer is flushed first if the bytes would not fit within its limit,
+ * and grown if they do not fit into the allocated space. A non-blocking
+ * terminal keeps what it does not accept yet, up to @ref CONIO_OUTBUF_BACKLOG bytes.
  *
- * @return Returns the character read from the standard input.
+ * @param[in] __n  The number of bytes to make room for.
+ * @return         Returns 0 on success, or -1 if the bytes are larger than the
+ *                 limit or the buffer cannot be grown.
  *
- * @since  0.1.0
- * @see    getche(void)
- * @see    ungetch(int)
+ * @since 0.4.0
  */
-int getch(void) {
-    return __getch(GETCH_NO_ECHO);  /* GETCH_NO_ECHO means no echoing input */
+static int __conio_out_room(conio_term_t* __t, size_t __n) {
+    size_t limit = __t->out.limit ? __t->out.limit : CONIO_OUTBUF_DEFAULT;
+    size_t max = __t->out.nonblock ? CONIO_OUTBUF_BACKLOG : limit;
+
+    __conio_out_queue(__t);
+    if (__t->out.len + __n > limit) __conio_out_flush(__t);
+    if (__t->out.len + __n <= __t->out.cap) return 0;
+    if (__t->out.len + __n > max) {
+        if (__t->out.nonblock) __t->out.overrun = 1;
+        return -1;
+    }
+
+    size_t cap = __t->out.cap ? __t->out.cap : 256;
+    char* data;
+    while (cap < __t->out.len + __n) cap *= 2;
+    if (cap > max) cap = max;
+
+    data = (char*)realloc(__t->out.data, cap);
+    if (!data) return -1;
+    __t->out.data = data;
+    __t->out.cap = cap;
+
+    if (!__conio_out_hooked) {
+        atexit(__conio_out_atexit);
+        __conio_out_hooked = 1;
+    }
+    return 0;
 }
 
 /**
- * @brief Reads a single character from the standard input with buffer.
- *
- * This function reads a single character from the standard input with buffer.
+ * @brief Appends bytes to the output buffer.
  *
- * Example
- * -------
- * ```c
- * // You can either use `char` or `int`, it is up to your preference
- * char c = getche();  // Wait until user input a character
- * ```
+ * Chunks larger than the buffer limit are written directly, after the
+ * buffered bytes.
  *
- * @return Returns the character read from the standard input.
+ * @param[in] __s  The bytes to append.
+ * @param[in] __n  The number of bytes.
  *
- * @since  0.1.0
- * @see    getch(void)
- * @see    ungetch(int)
+ * @since 0.4.0
  */
-int getche(void) {
-    return __getch(GETCH_USE_ECHO);  /* GETCH_USE_ECHO means with echoing input */
+static void __conio_out_put(conio_term_t* __t, const char* __s, size_t __n) {
+    if (__conio_out_room(__t, __n) != 0) {  /* Too large or out of memory, write it unbuffered */
+        if (__t->out.nonblock) {
+            __t->out.overrun = 1;  /* Cannot block, the output is lost */
+            return;
+        }
+        __conio_out_flush(__t);
+        __conio_write(__t, __s, __n);
+        return;
+    }
+    memcpy(__t->out.data + __t->out.len, __s, __n);
+    __t->out.len += __n;
 }
 
+/** Space returned by @ref __conio_out_reserve if the output buffer cannot be grown. */
+static char __conio_out_scratch[256];
+
 /**
- * @brief Checks if a keyboard key has been pressed.
- *
- * This function provides cross-platform support for detecting key presses.
- * On Windows, it can detect all input events, including non-character keys
- * like *Num Lock* and *Scroll Lock*. On Unix-like systems, it checks for input
- * availability on the standard input stream (`stdin`), so it won't detect
- * non-character key events.
+ * @brief Reserves space at the end of the output buffer.
  *
- * On Windows, the function uses the Windows Console API to check for key events
- * in the console input buffer. It peeks at the console input events and checks
- * if there is a key press event. If a key press event is detected, it consumes
- * the event from the buffer and returns a non-zero value.
+ * Used to encode escape sequences directly into the output buffer. The caller
+ * writes at most @p __n bytes at the returned address and then passes the number
+ * of bytes actually written to @ref __conio_out_commit.
  *
- * On Unix-like systems, the function uses the `termios` library to temporarily
- * disable canonical mode and echo, making the terminal input non-blocking. It
- * then checks if a character is available in the input buffer. If a character
- * is available, it pushes the character back onto the input stream and returns
- * a non-zero value.
+ * @param[in] __n  The number of bytes to reserve, at most 256.
+ * @return         The address of the reserved space.
  *
- * @note
- * For more advanced key detection (e.g., *Num Lock*, *Scroll Lock*) on Unix-like
- * systems, consider using libraries like [`libevdev`](https://www.freedesktop.org/wiki/Software/libevdev/)
- * or accessing `/dev/input` devices directly (requires root permissions).
+ * @since 0.4.0
+ */
+static char* __conio_out_reserve(conio_term_t* __t, size_t __n) {
+    if (__conio_out_room(__t, __n) != 0) return __conio_out_scratch;
+    return __t->out.data + __t->out.len;
+}
+
+/**
+ * @brief Appends the bytes written into the space returned by @ref __conio_out_reserve.
  *
- * @return Non-zero value if a key has been pressed; zero otherwise.
+ * @param[in] __p  The address returned by @ref __conio_out_reserve.
+ * @param[in] __n  The number of bytes written.
  *
- * @since  0.3.0
+ * @since 0.4.0
  */
-int kbhit(void) {
-#if defined(__HAVE_WINDOWS_API)
-    /* Windows-specific implementation using Windows API */
-    HANDLE hConsole = GetStdHandle(STD_INPUT_HANDLE);
-    if (hConsole == INVALID_HANDLE_VALUE) return 0;
-
-    DWORD events = 0;
-    INPUT_RECORD inputRecord;
-    if (!GetNumberOfConsoleInputEvents(hConsole, &events) || events == 0) return 0;  /* No input events */
-
-    /* Peek at console input events */
-    PeekConsoleInput(hConsole, &inputRecord, 1, &events);
-
-    /* Check if the event is a key press */
-    if (events > 0 && inputRecord.EventType == KEY_EVENT && inputRecord.Event.KeyEvent.bKeyDown) {
-        /* Consume the event from the buffer */
-        ReadConsoleInput(hConsole, &inputRecord, 1, &events);
-        return 1;
+static void __conio_out_commit(conio_term_t* __t, const char* __p, size_t __n) {
+    if (__p == __conio_out_scratch) {
+        if (__t->out.nonblock) {
+            __t->out.overrun = 1;  /* Cannot block, the output is lost */
+            return;
+        }
+        __conio_out_flush(__t);
+        __conio_write(__t, __p, __n);
+        return;
     }
+    __t->out.len += __n;
+}
 
-    /* Clear the input buffer of any other events */
-    FlushConsoleInputBuffer(hConsole);
-#else
-    /* Unix-specific implementation using termios */
-    struct termios oldt, newt;
-    int ch;
-    int oldf;
-
-    /* Save the old terminal settings */
-    tcgetattr(STDIN_FILENO, &oldt);
-    newt = oldt;
-
-    /* Disable canonical mode and echo */
-    newt.c_lflag &= ~(ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-
-    /* Set the file descriptor to non-blocking */
-    oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
-    fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
-
-    ch = getchar();
+/**
+ * @brief Returns the effective flush policy.
+ *
+ * @since 0.4.0
+ */
+static int __conio_out_policy(conio_term_t* __t) {
+    return __t->out.custom ? __t->out.policy
+                              : (CONIO_FLUSH_IMMEDIATE | CONIO_FLUSH_ON_INPUT);
+}
 
-    /* Restore the old settings */
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-    fcntl(STDIN_FILENO, F_SETFL, oldf);
+/**
+ * @brief Applies the flush policy at the end of an output function.
+ *
+ * @since 0.4.0
+ */
+static void __conio_out_end(conio_term_t* __t) {
+    int policy = __conio_out_policy(__t);
+    if (__t->out.hold > 0 || __t->out.len == 0) return;
 
-    if (ch != EOF) {
-        ungetc(ch, stdin);
-        return 1;
+    if ((policy & CONIO_FLUSH_IMMEDIATE)
+        || ((policy & CONIO_FLUSH_ON_TIMER)
+            && __conio_now_ms() - __t->out.last >= __t->out.interval)) {
+        __conio_out_flush(__t);
     }
-#endif
-
-    return 0;
 }
 
 /**
- * @brief Retrieves the current X-coordinate of the cursor on the terminal screen.
+ * @brief Applies the flush policy before waiting for input.
  *
- * This function retrieves the current X-coordinate of the cursor on the terminal screen.
- * The returned coordinate value always positive value.
- *
- * Example
- * -------
- * ```c
- * cpos_t cur_x = wherex();
- * ```
+ * @since 0.4.0
+ */
+static void __conio_out_input(conio_term_t* __t) {
+    if (__conio_out_policy(__t) & CONIO_FLUSH_ON_INPUT) __conio_out_flush(__t);
+}
+
+/**
+ * @brief Same as @ref conio_flush(), on the given terminal context.
  *
- * @return Returns the X-coordinate of the cursor.
+ * @param[in] term  The terminal context.
  *
- * @since  0.1.0
- * @see    wherey(void)
- * @see    wherexy(cpos_t*, cpos_t*)
+ * @since 0.4.0
  */
-cpos_t wherex(void) {
-    cpos_t __x = 0, __y = 0;
-    __whereis_xy(&__x, &__y);
-
-    return __x;  /* only return the X-coordinate */
+int conio_flush_ctx(conio_term_t* term) {
+    return __conio_out_flush(term);
 }
 
 /**
- * @brief Retrieves the current Y-coordinate of the cursor on the terminal screen.
+ * @brief Writes all buffered output to the terminal.
  *
- * This function retrieves the current Y-coordinate of the cursor on the terminal screen.
- * The returned coordinate value always positive value.
+ * The whole buffer is written with a single `write(2)` call, which makes it
+ * possible to compose a screen update from many calls to `gotoxy()`, `putch()`,
+ * `cputs()`, ... and send it as one frame.
  *
  * Example
  * -------
  * ```c
- * cpos_t cur_y = wherey();
+ * conio_setflush(CONIO_FLUSH_ON_INPUT, 0);
+ * gotoxy(1, 1); cputs("CPU: 42%");
+ * gotoxy(1, 2); cputs("MEM: 17%");
+ * conio_flush();  // Both lines are written at once
  * ```
  *
- * @return Returns the Y-coordinate of the cursor.
+ * @return Returns 0 on success, or -1 if writing to the terminal failed.
  *
- * @since  0.1.0
- * @see    wherex(void)
- * @see    wherexy(cpos_t*, cpos_t*)
+ * @since 0.4.0
+ * @see   conio_setflush(int, unsigned long)
+ * @see   conio_setbuf(size_t)
  */
-cpos_t wherey(void) {
-    cpos_t __x = 0, __y = 0;
-    __whereis_xy(&__x, &__y);
-
-    return __y;  /* only return the Y-coordinate */
+int conio_flush(void) {
+    return conio_flush_ctx(&__conio_def);
 }
 
 /**
- * @brief Retrieves the current X and Y coordinates of the cursor on the terminal screen.
+ * @brief Same as @ref conio_setflush(int, unsigned long), on the given terminal context.
  *
- * This function stores the current X-coordinate in the variable pointed
- * to by `x`, and the Y-coordinate in the variable pointed to by `y`.
+ * @param[in] term  The terminal context.
  *
- * To use this function, provide the addresses of variables for X and Y
- * to store the coordinates.
+ * @since 0.4.0
+ */
+void conio_setflush_ctx(conio_term_t* term, int const policy, unsigned long const interval_ms) {
+    term->out.policy = policy;
+    term->out.interval = interval_ms;
+    term->out.custom = 1;
+    __conio_out_end(term);
+}
+
+/**
+ * @brief Sets when the output buffer is flushed.
  *
- * Example
- * -------
- * ```c
- * cpos_t cur_x, cur_y;
- * wherexy(&cur_x, &cur_y);
- * ```
+ * @param[in] policy       Combination of @ref CONIO_FLUSH_IMMEDIATE, @ref CONIO_FLUSH_ON_INPUT
+ *                         and @ref CONIO_FLUSH_ON_TIMER flags. Zero means that output is
+ *                         only written by @ref conio_flush() or when the buffer is full.
+ * @param[in] interval_ms  The flush interval in milliseconds for @ref CONIO_FLUSH_ON_TIMER.
+ *                         The interval is checked whenever an output function is called.
  *
- * @param[in,out] px  Pointer to the variable where the X-coordinate will be stored.
- * @param[in,out] py  Pointer to the variable where the Y-coordinate will be stored.
+ * @attention Unless @ref CONIO_FLUSH_IMMEDIATE is set, output written with `printf()` or
+ *            other `stdio` functions can overtake output still held in the buffer.
+ *            Call @ref conio_flush() before using them.
  *
- * @since 0.2.0.
+ * @since 0.4.0
+ * @see   conio_flush(void)
  */
-void wherexy(cpos_t* px, cpos_t* py) {
-    __whereis_xy(px, py);
+void conio_setflush(int const policy, unsigned long const interval_ms) {
+    conio_setflush_ctx(&__conio_def, policy, interval_ms);
 }
 
 /**
- * @brief Writes a character to the standard output.
+ * @brief Same as @ref conio_setbuf(size_t), on the given terminal context.
  *
- * This function writes a character to the standard output.
- * It takes an integer parameter `c`, representing the character to be written.
- *
- * @param[in] c  The character to be written.
- * @return       Returns the written character as an integer.
+ * @param[in] term  The terminal context.
  *
- * @since 0.1.0
+ * @since 0.4.0
  */
-int putch(int const c) {
-    return putchar(c);
+void conio_setbuf_ctx(conio_term_t* term, size_t const size) {
+    __conio_out_flush(term);
+    free(term->out.data);
+    term->out.data = NULL;
+    term->out.cap = 0;
+    term->out.limit = size;
 }
 
 /**
- * @brief Sets the cursor position to the specified X-coordinate,
- *        maintaining the current Y-coordinate.
+ * @brief Sets the maximum size of the output buffer.
  *
- * This function serves as an alias for:
- * ```c
- * gotoxy(x, wherey());
- * ```
+ * The buffer starts small and grows as needed up to @p size bytes; once full,
+ * it is flushed. Pending output is flushed before the size is changed.
  *
- * It allows for flexible cursor manipulation by allowing the user to set the
- * X-coordinate while keeping the current Y-coordinate unchanged.
+ * @param[in] size  The maximum size in bytes, zero for @ref CONIO_OUTBUF_DEFAULT.
  *
- * @param[in] x  The desired X-coordinate to set the cursor to.
+ * @since 0.4.0
+ * @see   conio_flush(void)
+ */
+void conio_setbuf(size_t const size) {
+    conio_setbuf_ctx(&__conio_def, size);
+}
+
+/**
+ * @brief Same as @ref conio_setcaps(unsigned int), on the given terminal context.
  *
- * @since 0.2.0
- * @see   gotoy(cpos_t)
- * @see   gotoxy(cpos_t, cpos_t)
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
  */
-void gotox(cpos_t const x) {
-    gotoxy(x, wherey());
+void conio_setcaps_ctx(conio_term_t* term, unsigned int const caps) {
+    term->caps = caps;
+    term->known = ~0u;  /* Nothing is probed anymore */
 }
 
 /**
- * @brief Sets the cursor position to the specified Y-coordinate,
- *        maintaining the current X-coordinate.
+ * @brief Declares which optional control sequences the terminal understands.
  *
- * This function serves as an alias for:
+ * @ref conio_present() uses them to shorten its output: runs of blanks are erased
+ * with `EL` or `ECH` instead of being written, and runs of the same character (box
+ * borders, separators) are written once and repeated with `REP`. Without a
+ * capability, the cells are written literally. This matters most on slow links such
+ * as serial consoles. By default only @ref CONIO_CAP_EL is assumed, and
+ * @ref CONIO_CAP_SYNC is probed by the first @ref conio_frame_begin(). Once the
+ * capabilities are set with this function, nothing is probed anymore;
+ * @ref conio_probe() detects all of them.
+ *
+ * Example
+ * -------
  * ```c
- * gotoxy(wherex(), y);
+ * conio_setcaps(CONIO_CAP_EL | CONIO_CAP_ECH | CONIO_CAP_REP);  // xterm and compatibles
+ * ```
+ *
+ * @param[in] caps  Combination of the `CONIO_CAP_*` flags.
+ *
+ * @since 0.4.0
+ * @see   conio_getcaps(void)
+ */
+void conio_setcaps(unsigned int const caps) {
+    conio_setcaps_ctx(&__conio_def, caps);
+}
+
+/**
+ * @brief Same as @ref conio_getcaps(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+unsigned int conio_getcaps_ctx(conio_term_t* term) {
+    return term->caps;
+}
+
+/**
+ * @brief Returns the capabilities set by @ref conio_setcaps().
+ *
+ * @return The `CONIO_CAP_*` flags.
+ *
+ * @since 0.4.0
+ */
+unsigned int conio_getcaps(void) {
+    return conio_getcaps_ctx(&__conio_def);
+}
+
+
+/**
+ * @brief Represents a single character cell of the off-screen buffer.
+ *
+ * A cell holds the Unicode code point displayed in it and its attributes (colors and
+ * text styles), see @ref CONIO_FG, @ref CONIO_BG and the `CONIO_ATTR_*` macros.
+ *
+ * @since 0.4.0
+ * @see   conio_screen_init(cpos_t, cpos_t)
+ */
+typedef struct conio_cell {
+    uint32_t ch;    /**< Unicode code point of the character. */
+    uint32_t attr;  /**< Attributes of the character. */
+} conio_cell_t;
+
+/**
+ * @name Cell attributes
+ *
+ * Attributes for @ref conio_cell_t and @ref conio_enc_sgr(), combined with the
+ * bitwise OR operator. Colors are indexes of the terminal palette (0 - 255, where
+ * 0 - 7 are the standard colors and 8 - 15 their bright variants).
+ *
+ * Example
+ * -------
+ * ```c
+ * conio_screen_puts(1, 1, "Error", CONIO_FG(1) | CONIO_ATTR_BOLD);
+ * ```
+ *
+ * @since 0.4.0
+ * @{
+ */
+#define CONIO_ATTR_DEFAULT    0x00000000U            /**< Default colors, no text styles. */
+#define CONIO_FG(n)           ((uint32_t)(((n) & 0xFF) + 1))        /**< Foreground color `n`. */
+#define CONIO_BG(n)           ((uint32_t)(((n) & 0xFF) + 1) << 9)   /**< Background color `n`. */
+#define CONIO_ATTR_BOLD       0x01000000U            /**< Bold or increased intensity. */
+#define CONIO_ATTR_DIM        0x02000000U            /**< Faint or decreased intensity. */
+#define CONIO_ATTR_ITALIC     0x04000000U            /**< Italic. */
+#define CONIO_ATTR_UNDERLINE  0x08000000U            /**< Underlined. */
+#define CONIO_ATTR_BLINK      0x10000000U            /**< Blinking. */
+#define CONIO_ATTR_REVERSE    0x20000000U            /**< Swapped foreground and background colors. */
+/** @} */
+
+/**
+ * Size of a buffer that is large enough for any sequence produced by
+ * the `conio_enc_*` functions.
+ *
+ * @since 0.4.0
+ */
+#define CONIO_ENC_MAX  48
+
+/** Two-digit decimal representations of 0 - 99, used by @ref __conio_enc_uint. */
+static const char __conio_digits[] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829"
+    "30313233343536373839" "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879" "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * @brief Writes an unsigned integer in decimal notation, two digits at a time.
+ *
+ * @param[out] __buf  Buffer of at least 10 bytes.
+ * @param[in]  __v    The value to write.
+ * @return            The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_enc_uint(char* __buf, unsigned int __v) {
+    char tmp[10];
+    char* p = tmp + sizeof(tmp);
+    size_t n;
+
+    while (__v >= 100) {
+        unsigned int d = (__v % 100) * 2;
+        __v /= 100;
+        *--p = __conio_digits[d + 1];
+        *--p = __conio_digits[d];
+    }
+    if (__v >= 10) {
+        *--p = __conio_digits[__v * 2 + 1];
+        *--p = __conio_digits[__v * 2];
+    } else {
+        *--p = (char)('0' + __v);
+    }
+
+    n = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(__buf, p, n);
+    return n;
+}
+
+/**
+ * @brief Writes a control sequence with one numeric parameter (`"\033[{n}{final}"`).
+ *
+ * The parameter is omitted if it equals @p __def, the value the terminal assumes
+ * for an omitted parameter.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_enc_csi1(char* __buf, int __n, int __def, char __final) {
+    size_t len = 2;
+    __buf[0] = '\033';
+    __buf[1] = '[';
+    if (__n < 0) __n = 0;
+    if (__n != __def) len += __conio_enc_uint(__buf + len, (unsigned int)__n);
+    __buf[len++] = __final;
+    return len;
+}
+
+/**
+ * @brief Encodes the cursor position sequence (`CUP`, `"\033[{y};{x}H"`).
+ *
+ * The `conio_enc_*` functions write escape sequences into a caller-provided buffer
+ * without using `printf()` and without allocating memory, and return the number
+ * of bytes written. The buffer must hold at least @ref CONIO_ENC_MAX bytes.
+ * No null terminator is written.
+ *
+ * Example
+ * -------
+ * ```c
+ * char buf[CONIO_ENC_MAX];
+ * size_t n = conio_enc_cup(buf, 10, 5);
+ * write(STDOUT_FILENO, buf, n);
+ * ```
+ *
+ * @param[out] buf  The buffer to write into.
+ * @param[in]  x    The target column.
+ * @param[in]  y    The target row.
+ * @return          The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+size_t conio_enc_cup(char* const buf, cpos_t const x, cpos_t const y) {
+    size_t len = 2;
+    buf[0] = '\033';
+    buf[1] = '[';
+    len += __conio_enc_uint(buf + len, (unsigned int)(y < 0 ? 0 : y));
+    buf[len++] = ';';
+    len += __conio_enc_uint(buf + len, (unsigned int)(x < 0 ? 0 : x));
+    buf[len++] = 'H';
+    return len;
+}
+
+/**
+ * @brief Encodes the cursor horizontal absolute sequence (`CHA`, `"\033[{x}G"`).
+ *
+ * @param[out] buf  The buffer to write into, see @ref conio_enc_cup().
+ * @param[in]  x    The target column.
+ * @return          The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+size_t conio_enc_cha(char* const buf, cpos_t const x) {
+    return __conio_enc_csi1(buf, x, 1, 'G');
+}
+
+/**
+ * @brief Encodes the vertical position absolute sequence (`VPA`, `"\033[{y}d"`).
+ *
+ * @param[out] buf  The buffer to write into, see @ref conio_enc_cup().
+ * @param[in]  y    The target row.
+ * @return          The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+size_t conio_enc_vpa(char* const buf, cpos_t const y) {
+    return __conio_enc_csi1(buf, y, 1, 'd');
+}
+
+/**
+ * @brief Encodes the erase in display sequence (`ED`, `"\033[{mode}J"`).
+ *
+ * @param[out] buf   The buffer to write into, see @ref conio_enc_cup().
+ * @param[in]  mode  0 to erase from the cursor to the end of the screen, 1 to erase
+ *                   from the start of the screen to the cursor, 2 to erase the whole screen.
+ * @return           The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+size_t conio_enc_ed(char* const buf, int const mode) {
+    return __conio_enc_csi1(buf, mode, 0, 'J');
+}
+
+/**
+ * @brief Encodes the erase in line sequence (`EL`, `"\033[{mode}K"`).
+ *
+ * @param[out] buf   The buffer to write into, see @ref conio_enc_cup().
+ * @param[in]  mode  0 to erase from the cursor to the end of the line, 1 to erase
+ *                   from the start of the line to the cursor, 2 to erase the whole line.
+ * @return           The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+size_t conio_enc_el(char* const buf, int const mode) {
+    return __conio_enc_csi1(buf, mode, 0, 'K');
+}
+
+/**
+ * @brief Encodes the erase characters sequence (`ECH`, `"\033[{n}X"`).
+ *
+ * Erases @p n characters from the cursor to the right, without moving the cursor.
+ *
+ * @param[out] buf  The buffer to write into, see @ref conio_enc_cup().
+ * @param[in]  n    The number of characters to erase.
+ * @return          The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+size_t conio_enc_ech(char* const buf, cpos_t const n) {
+    return __conio_enc_csi1(buf, n, 1, 'X');
+}
+
+/**
+ * @brief Encodes the repeat sequence (`REP`, `"\033[{n}b"`).
+ *
+ * Writes the preceding graphic character @p n more times.
+ *
+ * @param[out] buf  The buffer to write into, see @ref conio_enc_cup().
+ * @param[in]  n    The number of repetitions.
+ * @return          The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+size_t conio_enc_rep(char* const buf, cpos_t const n) {
+    return __conio_enc_csi1(buf, n, 1, 'b');
+}
+
+/**
+ * @brief Encodes the select graphic rendition sequence (`SGR`, `"\033[...m"`).
+ *
+ * The sequence resets all attributes first, so its effect does not depend on the
+ * attributes currently selected in the terminal.
+ *
+ * @param[out] buf   The buffer to write into, see @ref conio_enc_cup().
+ * @param[in]  attr  The attributes, see @ref conio_cell_t.
+ * @return           The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+size_t conio_enc_sgr(char* const buf, uint32_t const attr) {
+    static const char styles[] = "123457";  /* SGR parameters of the style bits, in order */
+    uint32_t fg = attr & 0x1FF, bg = (attr >> 9) & 0x1FF;
+    size_t len = 3;
+    int i;
+
+    buf[0] = '\033';
+    buf[1] = '[';
+    buf[2] = '0';
+    for (i = 0; i < 6; i++) {
+        if (attr & (CONIO_ATTR_BOLD << i)) {
+            buf[len++] = ';';
+            buf[len++] = styles[i];
+        }
+    }
+    if (fg--) {
+        buf[len++] = ';';
+        if (fg < 8) {
+            len += __conio_enc_uint(buf + len, 30 + fg);
+        } else if (fg < 16) {
+            len += __conio_enc_uint(buf + len, 90 + fg - 8);
+        } else {
+            memcpy(buf + len, "38;5;", 5);
+            len += 5 + __conio_enc_uint(buf + len + 5, fg);
+        }
+    }
+    if (bg--) {
+        buf[len++] = ';';
+        if (bg < 8) {
+            len += __conio_enc_uint(buf + len, 40 + bg);
+        } else if (bg < 16) {
+            len += __conio_enc_uint(buf + len, 100 + bg - 8);
+        } else {
+            memcpy(buf + len, "48;5;", 5);
+            len += 5 + __conio_enc_uint(buf + len + 5, bg);
+        }
+    }
+    buf[len++] = 'm';
+    return len;
+}
+
+/** Escape sequence parser states of the cursor model. */
+enum { __CONIO_ESC_NONE, __CONIO_ESC_ESC, __CONIO_ESC_CSI };
+
+/**
+ * @brief Clamps a coordinate the same way the terminal clamps the `CUP` sequence.
+ *
+ * @param[in] __v    The coordinate.
+ * @param[in] __max  The size of the screen, zero if unknown.
+ *
+ * @since 0.4.0
+ */
+static cpos_t __conio_cur_clamp(cpos_t __v, cpos_t __max) {
+    if (__v < 1) return 1;
+    return (__max > 0 && __v > __max) ? __max : __v;
+}
+
+/**
+ * @brief Moves the shadow cursor to an absolute position.
+ *
+ * Coordinates are clamped the same way the terminal clamps the `CUP` sequence.
+ *
+ * @param[in] __x  The target column.
+ * @param[in] __y  The target row.
+ *
+ * @since 0.4.0
+ */
+static void __conio_cur_set(conio_term_t* __t, cpos_t __x, cpos_t __y) {
+    if (!__t->cur.enabled) return;
+    __t->cur.x = __conio_cur_clamp(__x, __t->cur.cols);
+    __t->cur.y = __conio_cur_clamp(__y, __t->cur.rows);
+    __t->cur.wrap = 0;
+    __t->cur.valid = 1;
+}
+
+/**
+ * @brief Moves the shadow cursor to the next line, scrolling at the bottom.
+ *
+ * @since 0.4.0
+ */
+static void __conio_cur_linefeed(conio_term_t* __t) {
+    if (__t->cur.bottom > 0 && __t->cur.y == __t->cur.bottom) {
+        /* Scrolls the region, the cursor stays */
+    } else if (__t->cur.rows <= 0 || __t->cur.y < __t->cur.rows) {
+        __t->cur.y++;
+    }
+    __t->cur.wrap = 0;
+}
+
+/**
+ * @brief Updates the shadow cursor for bytes written to the terminal.
+ *
+ * Printable characters advance the cursor by one column, wrapping at the known
+ * terminal width. Carriage return, line feed, horizontal tab and backspace are
+ * interpreted as the terminal does. Each UTF-8 encoded character counts as one
+ * column. `SGR` sequences (`"\033[...m"`) are skipped, any other escape sequence
+ * invalidates the model because its effect on the cursor is unknown.
+ *
+ * @param[in] __s  The bytes written to the terminal.
+ * @param[in] __n  The number of bytes.
+ *
+ * @since 0.4.0
+ */
+static void __conio_cur_advance(conio_term_t* __t, const char* __s, size_t __n) {
+    size_t i;
+    if (!__t->cur.enabled) return;
+
+    for (i = 0; i < __n; i++) {
+        unsigned char c = (unsigned char)__s[i];
+
+        if (__t->cur.esc == __CONIO_ESC_ESC) {
+            __t->cur.esc = (c == '[') ? __CONIO_ESC_CSI : __CONIO_ESC_NONE;
+            if (c != '[') __t->cur.valid = 0;
+            continue;
+        }
+        if (__t->cur.esc == __CONIO_ESC_CSI) {
+            if (c >= 0x40 && c <= 0x7E) {  /* Final byte */
+                __t->cur.esc = __CONIO_ESC_NONE;
+                if (c != 'm') __t->cur.valid = 0;
+            }
+            continue;
+        }
+
+        switch (c) {
+        case 0x1B:
+            __t->cur.esc = __CONIO_ESC_ESC;
+            break;
+        case '\r':
+            __t->cur.x = 1;
+            __t->cur.wrap = 0;
+            break;
+        case '\n':
+            if (__t->cur.crlf) __t->cur.x = 1;
+            __conio_cur_linefeed(__t);
+            break;
+        case '\t':
+            __t->cur.x = (cpos_t)(((__t->cur.x - 1) / 8 + 1) * 8 + 1);
+            if (__t->cur.cols > 0 && __t->cur.x > __t->cur.cols)
+                __t->cur.x = __t->cur.cols;
+            break;
+        case '\b':
+            if (__t->cur.x > 1) __t->cur.x--;
+            __t->cur.wrap = 0;
+            break;
+        default:
+            /* Control characters and UTF-8 continuation bytes take no space */
+            if (c < 0x20 || c == 0x7F || (c & 0xC0) == 0x80) break;
+
+            if (__t->cur.wrap) {
+                __t->cur.x = 1;
+                __conio_cur_linefeed(__t);
+            }
+            if (__t->cur.cols > 0 && __t->cur.x >= __t->cur.cols)
+                __t->cur.wrap = 1;  /* Stay at the last column until the next character */
+            else
+                __t->cur.x++;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Returns the number of buffered, unconsumed input bytes.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_in_avail(conio_term_t* __t) {
+    return __t->in.tail - __t->in.head;
+}
+
+/**
+ * @brief Reads whatever input is available into the read-ahead buffer, see @ref __conio_in_fill.
+ *
+ * @param[in] __timeout_ms  Maximum time to wait for input in milliseconds,
+ *                          or a negative value to wait indefinitely.
+ * @return                  The number of bytes read, 0 if the timeout expired or the
+ *                          buffer is full, or -1 on end of file or error.
+ *
+ * @since 0.4.0
+ */
+static int __conio_in_read(conio_term_t* __t, int __timeout_ms) {
+    size_t space;
+
+    /* Move the unconsumed bytes to the front to make room */
+    if (__t->in.head > 0) {
+        memmove(__t->in.buf, __t->in.buf + __t->in.head, __conio_in_avail(__t));
+        __t->in.tail -= __t->in.head;
+        __t->in.head = 0;
+    }
+    space = CONIO_INBUF_SIZE - __t->in.tail;
+    if (space == 0) return 0;
+
+    if (__t->be) {
+        int n = __t->be->input(__t->be, __t->in.buf + __t->in.tail, space, __timeout_ms);
+        if (n > 0) __t->in.tail += (size_t)n;
+        return n;
+    }
+
+#ifdef __HAVE_WINDOWS_API
+    HANDLE handler = GetStdHandle(STD_INPUT_HANDLE);
+    DWORD dwRead = 0;
+
+    if (__timeout_ms >= 0
+        && WaitForSingleObject(handler, (DWORD)__timeout_ms) != WAIT_OBJECT_0) return 0;
+    if (!ReadConsole(handler, __t->in.buf + __t->in.tail, (DWORD)space, &dwRead, NULL)
+        || dwRead == 0) return -1;
+    __t->in.tail += dwRead;
+    return (int)dwRead;
+#else
+    ssize_t r;
+    if (__timeout_ms >= 0) {
+        struct pollfd pfd;
+        pfd.fd = __t->in_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        while ((r = poll(&pfd, 1, __timeout_ms)) < 0 && errno == EINTR) {}
+        if (r == 0) return 0;
+    }
+
+    while ((r = read(__t->in_fd, __t->in.buf + __t->in.tail, space)) < 0 && errno == EINTR) {}
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;  /* Non-blocking, nothing yet */
+    if (r <= 0) return -1;
+    __t->in.tail += (size_t)r;
+    return (int)r;
+#endif  /* __HAVE_WINDOWS_API */
+}
+
+/**
+ * @name Kinds of replies taken by __conio_in_reply
+ *
+ * @since 0.4.0
+ * @{
+ */
+#define __CONIO_REPLY_PRIV  0x01  /**< Private control sequences and device control strings. */
+#define __CONIO_REPLY_CPR   0x02  /**< Cursor position reports. */
+/** @} */
+
+/**
+ * @brief Removes the first complete reply to a query from the read-ahead buffer.
+ *
+ * Replies are control sequences beginning with `"\033[?"` or `"\033[>"` and the
+ * XTVERSION string (`"\033P>|...\033\\"`), which no key sends (@ref __CONIO_REPLY_PRIV),
+ * and cursor position reports (`"\033[{y};{x}R"`, @ref __CONIO_REPLY_CPR). The bytes
+ * around them, such as keys pressed while the reply was awaited, are kept for the
+ * next `getch()`. Other `"\033P"` are keys (Alt+Shift+P).
+ *
+ * @param[out] __seq   Receives the reply without the leading `"\033["` or `"\033P"`
+ *                     and the final byte or string terminator, truncated to fit and
+ *                     NUL-terminated.
+ * @param[in]  __size  The size of @p __seq, at least 1.
+ * @param[in]  __kind  The kinds of replies to take, `__CONIO_REPLY_*` flags.
+ * @return             The final byte of the reply (`'P'` for a device control string),
+ *                     0 if no reply is buffered, or -1 if the buffer ends with the
+ *                     beginning of one.
+ *
+ * @since 0.4.0
+ */
+static int __conio_in_reply(conio_term_t* __t, char* __seq, size_t __size, int __kind) {
+    unsigned char* b = __t->in.buf;
+    size_t i, j, n, end;
+    int final;
+
+    for (i = __t->in.head; i < __t->in.tail; i++) {
+        if (b[i] != 0x1B) continue;
+        if (i + 2 >= __t->in.tail) {  /* The beginning of a reply, or a key */
+            if (i + 1 == __t->in.tail || b[i + 1] == '[' || (b[i + 1] == 'P' && (__kind & __CONIO_REPLY_PRIV)))
+                return -1;
+            continue;
+        }
+        if (b[i + 1] == 'P') {  /* Up to the string terminator, "\033\\" or BEL */
+            if (!(__kind & __CONIO_REPLY_PRIV) || b[i + 2] != '>'
+                || (i + 3 < __t->in.tail && b[i + 3] != '|')) continue;
+            if (i + 3 == __t->in.tail) return -1;
+            for (j = i + 2; j < __t->in.tail && b[j] != 0x07
+                            && !(b[j] == 0x1B && j + 1 < __t->in.tail && b[j + 1] == '\\'); j++) {}
+            if (j == __t->in.tail || (b[j] == 0x1B && j + 1 == __t->in.tail)) return -1;
+            final = 'P';
+            end = (b[j] == 0x07) ? j + 1 : j + 2;
+        } else if (b[i + 1] == '[') {
+            unsigned char c = b[i + 2];
+            if (!((__kind & __CONIO_REPLY_PRIV) && (c == '?' || c == '>'))
+                && !((__kind & __CONIO_REPLY_CPR) && c >= '0' && c <= '9')) continue;
+            for (j = i + 2; j < __t->in.tail && b[j] >= 0x20 && b[j] <= 0x3F; j++) {}
+            if (j == __t->in.tail) return -1;          /* The rest has not arrived yet */
+            if (b[j] < 0x40 || b[j] > 0x7E) continue;  /* Not a control sequence */
+            if (c >= '0' && c <= '9' && b[j] != 'R') continue;  /* A key */
+            final = b[j];
+            end = j + 1;
+        } else {
+            continue;
+        }
+
+        n = j - (i + 2);
+        if (n >= __size) n = __size - 1;
+        memcpy(__seq, b + i + 2, n);
+        __seq[n] = '\0';
+        memmove(b + i, b + end, __t->in.tail - end);
+        __t->in.tail -= end - i;
+        return final;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses the numeric parameters of a reply, such as `"62;1;22"`.
+ *
+ * Parsing stops at the first byte that is neither a digit nor `';'`.
+ *
+ * @param[out] __p    Receives the parameters, empty ones are zero.
+ * @param[in]  __max  The number of entries of @p __p.
+ * @return            The number of parameters, at most @p __max.
+ *
+ * @since 0.4.0
+ */
+static int __conio_reply_params(const char* __s, unsigned int* __p, int __max) {
+    int n = 0;
+    if (*__s < '0' || *__s > '9') return 0;
+
+    __p[0] = 0;
+    for (; (*__s >= '0' && *__s <= '9') || *__s == ';'; __s++) {
+        if (*__s == ';') {
+            if (++n == __max) return n;
+            __p[n] = 0;
+        } else {
+            __p[n] = __p[n] * 10 + (unsigned int)(*__s - '0');
+        }
+    }
+    return n + 1;
+}
+
+/**
+ * @brief Discards the oldest received replies while they answer abandoned queries.
+ *
+ * @since 0.4.0
+ */
+static void __conio_cpr_trim(conio_term_t* __t) {
+    while (__t->in.replies > 0 && (__t->in.drop & (1u << __t->in.first))) {
+        __t->in.drop &= ~(1u << __t->in.first);
+        __t->in.first = (__t->in.first + 1) % CONIO_CPR_MAX;
+        __t->in.replies--;
+    }
+}
+
+/**
+ * @brief Stops awaiting the reply to the oldest pending query, if it was abandoned.
+ *
+ * The later pending queries move up one entry.
+ *
+ * @return 1 if the query was forgotten, 0 otherwise.
+ *
+ * @since 0.4.0
+ */
+static int __conio_cpr_forget(conio_term_t* __t) {
+    int i = (__t->in.first + __t->in.replies) % CONIO_CPR_MAX, j, k;
+
+    if (__t->in.pending == 0 || !(__t->in.drop & (1u << i))) return 0;
+    for (k = 1; k < __t->in.pending; k++, i = j) {
+        j = (i + 1) % CONIO_CPR_MAX;
+        __t->in.drop = (__t->in.drop & ~(1u << i)) | (((__t->in.drop >> j) & 1u) << i);
+    }
+    __t->in.drop &= ~(1u << i);
+    __t->in.pending--;
+    return 1;
+}
+
+/**
+ * @brief Takes the replies to pending cursor position queries out of the read-ahead buffer.
+ *
+ * The replies are queued in the order they arrive, see @ref conio_cursor_reply().
+ * The late replies to a probe that timed out are discarded, see @ref conio_probe().
+ *
+ * @return Returns 0, or -1 if the buffer ends with the beginning of a reply.
+ *
+ * @since 0.4.0
+ */
+static int __conio_cpr_collect(conio_term_t* __t) {
+    char seq[24];
+    unsigned int p[2];
+    int final, i, kind;
+
+    for (;;) {
+        kind = (__t->in.pending > 0 ? __CONIO_REPLY_CPR : 0) | (__t->in.late > 0 ? __CONIO_REPLY_PRIV : 0);
+        if (kind == 0 || (final = __conio_in_reply(__t, seq, sizeof(seq), kind)) == 0) break;
+        if (final < 0) return -1;
+        if (final == 'P' || seq[0] == '?' || seq[0] == '>') {
+            __t->in.late--;
+            continue;
+        }
+        if (__conio_reply_params(seq, p, 2) != 2) p[0] = p[1] = 0;
+        i = (__t->in.first + __t->in.replies++) % CONIO_CPR_MAX;
+        __t->in.rx[i] = (cpos_t)p[1];
+        __t->in.ry[i] = (cpos_t)p[0];
+        __t->in.pending--;
+        __conio_cpr_trim(__t);
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads whatever input is available into the read-ahead buffer.
+ *
+ * While cursor position queries are pending, their replies are taken out of the
+ * input as soon as they are read, so they never reach `getch()` or the key decoder.
+ * A reply split across reads is completed by waiting up to @ref CONIO_ESC_DELAY
+ * milliseconds for the rest.
+ *
+ * @param[in] __timeout_ms  Maximum time to wait for input in milliseconds,
+ *                          or a negative value to wait indefinitely.
+ * @return                  The number of bytes read (replies included), 0 if the timeout
+ *                          expired or the buffer is full, or -1 on end of file or error.
+ *
+ * @since 0.4.0
+ */
+static int __conio_in_fill(conio_term_t* __t, int __timeout_ms) {
+    int n = __conio_in_read(__t, __timeout_ms);
+    while (n > 0 && (__t->in.pending > 0 || __t->in.late > 0) && __conio_cpr_collect(__t) < 0
+           && __conio_in_read(__t, CONIO_ESC_DELAY) > 0) {}
+    return n;
+}
+
+/**
+ * @brief Removes and returns the next byte of the read-ahead buffer.
+ *
+ * @return The next byte, or `EOF` if the buffer is empty.
+ *
+ * @since 0.4.0
+ */
+static int __conio_in_pop(conio_term_t* __t) {
+    if (__t->in.head == __t->in.tail) return EOF;
+    return __t->in.buf[__t->in.head++];
+}
+
+/**
+ * @brief Moves the buffered bytes up to the next newline into a line.
+ *
+ * The bytes are copied in one go rather than popped one by one. The newline
+ * is consumed but not stored.
+ *
+ * @param[out]    __line     The line.
+ * @param[in,out] __len      The length of the line so far, updated.
+ * @param[in]     __max      The maximum length of the line.
+ * @param[in]     __discard  Non-zero to consume and drop the bytes past @p __max,
+ *                           zero to leave them in the buffer.
+ * @return                   Non-zero if the line is complete: the newline has been
+ *                           consumed, or the line is full and @p __discard is zero.
+ *
+ * @since 0.4.0
+ */
+static int __conio_in_line(conio_term_t* __t, char* __line, size_t* __len, size_t __max, int __discard) {
+    const unsigned char* start = __t->in.buf + __t->in.head;
+    const unsigned char* nl = (const unsigned char*)memchr(start, '\n', __conio_in_avail(__t));
+    size_t n = nl ? (size_t)(nl - start) : __conio_in_avail(__t);
+    size_t take = (n < __max - *__len) ? n : __max - *__len;
+
+    memcpy(__line + *__len, start, take);
+    *__len += take;
+    if (!__discard && n > take) {  /* The line is full, the rest is left */
+        __t->in.head += take;
+        return 1;
+    }
+    __t->in.head += n + (nl != NULL);
+    return nl != NULL || (!__discard && *__len == __max);
+}
+
+#ifndef __HAVE_WINDOWS_API
+/** Number of `SIGWINCH` received, the cached sizes read before the last one are stale. */
+static volatile sig_atomic_t __conio_winch_gen;
+
+/** Number of references to the `SIGWINCH` handler, held by event loops and cached sizes. */
+static int __conio_winch_refs;
+
+/** `SIGWINCH` disposition that was installed before the handler of this library. */
+static struct sigaction __conio_winch_old;
+
+/** Self-pipe written by the `SIGWINCH` handler to wake up the event loops, read end first. */
+static int __conio_winch_pipe[2] = { -1, -1 };
+
+/**
+ * @brief `SIGWINCH` handler, marks the cached sizes stale and wakes up the event loops.
+ *
+ * Only uses async-signal-safe calls. The handler that was installed before is called too.
+ *
+ * @since 0.4.0
+ */
+static void __conio_on_winch(int __sig, siginfo_t* __info, void* __uc) {
+    int saved = errno;
+    char b = 0;
+
+    __conio_winch_gen = (__conio_winch_gen + 1) & 0x7FFF;
+    if (__conio_winch_pipe[1] >= 0 && write(__conio_winch_pipe[1], &b, 1) < 0) {}  /* A full pipe already wakes up the loop */
+    errno = saved;
+
+    if (__conio_winch_old.sa_flags & SA_SIGINFO) {
+        if (__conio_winch_old.sa_sigaction) __conio_winch_old.sa_sigaction(__sig, __info, __uc);
+    } else if (__conio_winch_old.sa_handler != SIG_DFL && __conio_winch_old.sa_handler != SIG_IGN) {
+        __conio_winch_old.sa_handler(__sig);
+    }
+}
+
+/**
+ * @brief Takes a reference to the `SIGWINCH` handler, installing it on the first one.
+ *
+ * @return Returns 0 on success, or -1 if the handler could not be installed.
+ *
+ * @since 0.4.0
+ */
+static int __conio_winch_hook(void) {
+    if (__conio_winch_refs == 0) {
+        struct sigaction action;
+        action.sa_sigaction = __conio_on_winch;  /* Passes the signal information on */
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        if (sigaction(SIGWINCH, &action, &__conio_winch_old) != 0) return -1;
+    }
+    __conio_winch_refs++;
+    return 0;
+}
+
+/**
+ * @brief Releases a reference to the `SIGWINCH` handler, restoring the previous one on the last.
+ *
+ * @since 0.4.0
+ */
+static void __conio_winch_unhook(void) {
+    if (__conio_winch_refs > 0 && --__conio_winch_refs == 0) {
+        sigaction(SIGWINCH, &__conio_winch_old, NULL);
+    }
+}
+#endif  /* ! __HAVE_WINDOWS_API */
+
+/**
+ * @brief Retrieves the screen size from the backend or the terminal.
+ *
+ * @param[out] __cols  Receives the number of columns.
+ * @param[out] __rows  Receives the number of rows.
+ * @return             Returns 0 on success, or -1 if the size is unknown.
+ *
+ * @since 0.4.0
+ */
+static int __conio_winsize(conio_term_t* __t, cpos_t* __cols, cpos_t* __rows) {
+    if (__t->be) {
+        return __t->be->getsize ? __t->be->getsize(__t->be, __cols, __rows) : -1;
+    }
+#ifdef __HAVE_WINDOWS_API
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) return -1;
+    *__cols = (cpos_t)(csbi.srWindow.Right - csbi.srWindow.Left + 1);
+    *__rows = (cpos_t)(csbi.srWindow.Bottom - csbi.srWindow.Top + 1);
+    return 0;
+#else
+    struct winsize ws;
+    if (ioctl(__t->out_fd, TIOCGWINSZ, &ws) != 0) return -1;
+    *__cols = (cpos_t)ws.ws_col;
+    *__rows = (cpos_t)ws.ws_row;
+    return 0;
+#endif  /* __HAVE_WINDOWS_API */
+}
+
+/**
+ * @brief Same as @ref conio_getsize(cpos_t*, cpos_t*), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_getsize_ctx(conio_term_t* term, cpos_t* cols, cpos_t* rows) {
+    cpos_t c, r;
+    int changed;
+
+#ifndef __HAVE_WINDOWS_API
+    long gen;
+
+    /* The cached size is current until the next `SIGWINCH` */
+    if (term->win.valid && term->win.hooked && term->win.gen == (long)__conio_winch_gen) {
+        if (term->win.cols <= 0 || term->win.rows <= 0) return -1;
+        if (cols) *cols = term->win.cols;
+        if (rows) *rows = term->win.rows;
+        return 0;
+    }
+    if (!term->be && !term->win.hooked) term->win.hooked = (__conio_winch_hook() == 0);
+    gen = (long)__conio_winch_gen;  /* Before reading, so a resize meanwhile is noticed */
+#endif  /* ! __HAVE_WINDOWS_API */
+
+    if (__conio_winsize(term, &c, &r) != 0 || c <= 0 || r <= 0) c = r = 0;
+    changed = term->win.valid && (c != term->win.cols || r != term->win.rows);
+    term->win.cols = c;
+    term->win.rows = r;
+    term->win.valid = 1;
+#ifndef __HAVE_WINDOWS_API
+    term->win.gen = gen;
+#endif  /* ! __HAVE_WINDOWS_API */
+
+    if (changed) {
+        /* The terminal may have moved the cursor while reflowing the lines */
+        if (term->cur.enabled) {
+            term->cur.cols = c;
+            term->cur.rows = r;
+            term->cur.valid = 0;
+        }
+        if (term->win.on_size) term->win.on_size(term, c, r, term->win.user);
+    }
+    if (c <= 0) return -1;
+    if (cols) *cols = c;
+    if (rows) *rows = r;
+    return 0;
+}
+
+/**
+ * @brief Retrieves the size of the terminal.
+ *
+ * On Unix-like systems, the size is read with `ioctl(TIOCGWINSZ)` once and cached;
+ * a `SIGWINCH` handler (installed on the first call, calling the handler installed
+ * before) marks the cached size stale, so the next call reads it again. Until the
+ * terminal is resized, this function makes no system call. The size of a backend
+ * is asked every time.
+ *
+ * When the size read differs from the cached one, the callback set with
+ * @ref conio_on_resize() is called, and the shadow cursor model (see
+ * @ref conio_cursor_track()) takes the new size.
+ *
+ * @param[out] cols  Receives the number of columns, may be `NULL`.
+ * @param[out] rows  Receives the number of rows, may be `NULL`.
+ * @return           Returns 0 on success, or -1 if the size is unknown (for example
+ *                   if the output is not a terminal).
+ *
+ * @note An application installing its own `SIGWINCH` handler after the first call
+ *       must call the previous handler from it, or the cached size is never refreshed.
+ *
+ * @since 0.4.0
+ * @see   conio_on_resize(conio_size_cb, void*)
+ */
+int conio_getsize(cpos_t* cols, cpos_t* rows) {
+    return conio_getsize_ctx(&__conio_def, cols, rows);
+}
+
+/**
+ * @brief Same as @ref conio_on_resize(conio_size_cb, void*), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void conio_on_resize_ctx(conio_term_t* term, conio_size_cb const cb, void* user) {
+    term->win.on_size = cb;
+    term->win.user = user;
+    conio_getsize_ctx(term, NULL, NULL);  /* The size the next change is compared with */
+}
+
+/**
+ * @brief Sets the callback for terminal resizes.
+ *
+ * The callback is never called from the signal handler: it runs from
+ * @ref conio_getsize() when that notices the new size, and from the event loop
+ * (see @ref conio_loop_new()) as soon as the terminal is resized.
+ *
+ * @param[in] cb    The callback, or `NULL`.
+ * @param[in] user  User data passed to the callback.
+ *
+ * @since 0.4.0
+ */
+void conio_on_resize(conio_size_cb const cb, void* user) {
+    conio_on_resize_ctx(&__conio_def, cb, user);
+}
+
+/**
+ * @brief Same as @ref conio_set_backend(conio_backend_t*), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void conio_set_backend_ctx(conio_term_t* term, conio_backend_t* be) {
+    __conio_out_flush(term);
+    term->in.head = term->in.tail = 0;
+    term->in.pending = term->in.replies = 0;  /* Replies from the other terminal never come */
+    term->in.drop = 0;
+    term->in.late = 0;
+    term->win.valid = 0;  /* Cached for the other terminal */
+    term->cur.valid = 0;
+    term->be = be;
+}
+
+/**
+ * @brief Installs an I/O backend in place of the terminal.
+ *
+ * All output of this library is passed to the backend, input is read from it and
+ * cursor position queries are answered by it, so screens can be rendered and tested
+ * without a terminal. Raw-mode sessions do not change any terminal settings while
+ * a backend is installed.
+ *
+ * Pending output is flushed to the previous destination, input that has been read
+ * ahead from it is discarded, and the cursor model (see @ref conio_cursor_track())
+ * is invalidated.
+ *
+ * Example
+ * -------
+ * ```c
+ * conio_vterm_t vt;
+ * conio_vterm_init(&vt, 80, 24);
+ * conio_set_backend(&vt.backend);
+ * gotoxy(3, 2); cputs("Hello");
+ * conio_vterm_row(&vt, 2, line, sizeof(line));  // "  Hello"
+ * conio_set_backend(NULL);
+ * conio_vterm_free(&vt);
+ * ```
+ *
+ * @param[in] be  The backend, or `NULL` to use the terminal again.
+ *
+ * @note On Windows console, `gotoxy()`, `clrscr()`, `delline()` and `wherexy()`
+ *       use the console API and are not redirected.
+ *
+ * @since 0.4.0
+ * @see   conio_vterm_init(conio_vterm_t*, cpos_t, cpos_t)
+ */
+void conio_set_backend(conio_backend_t* be) {
+    conio_set_backend_ctx(&__conio_def, be);
+}
+
+/**
+ * @brief Reads input until key bytes are buffered, the timeout expires or the input ends.
+ *
+ * @ref __conio_in_fill takes the replies to cursor position queries out of the input,
+ * so a read that only brought a reply does not end the wait.
+ *
+ * @param[in] __timeout_ms  Maximum time to wait in milliseconds, or a negative
+ *                          value to wait indefinitely.
+ * @return                  Same as @ref __conio_in_fill.
+ *
+ * @since 0.4.0
+ */
+static int __conio_in_fill_keys(conio_term_t* __t, int __timeout_ms) {
+    unsigned long start = __conio_now_ms();
+    int wait = __timeout_ms, r;
+
+    for (;;) {
+        r = __conio_in_fill(__t, wait);
+        if (r <= 0 || __conio_in_avail(__t) > 0) return r;
+        if (__timeout_ms >= 0) {  /* Only a reply was read, wait for the rest of the time */
+            unsigned long elapsed = __conio_now_ms() - start;
+            wait = (elapsed >= (unsigned long)__timeout_ms) ? 0 : (int)((unsigned long)__timeout_ms - elapsed);
+        }
+    }
+}
+
+/**
+ * @brief Waits until input is available in the read-ahead buffer.
+ *
+ * Bytes already read ahead come first, otherwise whatever the terminal has is
+ * read at once. Outside a session, canonical mode and echo are disabled around
+ * the read, so that a key is returned without waiting for Enter.
+ *
+ * @param[in] __timeout_ms  Maximum time to wait in milliseconds, or a negative
+ *                          value to wait indefinitely.
+ * @return                  1 if input is available, 0 if the timeout expired,
+ *                          or -1 at the end of the input or on error.
+ *
+ * @since 0.4.0
+ */
+static int __conio_in_wait(conio_term_t* __t, int __timeout_ms) {
+    int __r;
+
+    /* The terminal is already in non-canonical mode inside a session */
+    if (__conio_in_avail(__t) > 0) return 1;
+    if (__t->sess.depth > 0 || __t->be) {
+        __r = __conio_in_fill_keys(__t, __timeout_ms);
+    } else {
+#if defined(__UNIX_PLATFORM) || ! defined(__HAVE_WINDOWS_API)
+        /* Implementation for Unix systems and unimplemented Windows API */
+        struct termios __oldterm, __newterm;
+
+        tcgetattr(__t->in_fd, &__oldterm);
+        __newterm = __oldterm;  /* Copy the original terminal setting */
+        __newterm.c_lflag &= ~(ICANON | ECHO);  /* The echo is written by `getche()` */
+
+        tcsetattr(__t->in_fd, TCSANOW, &__newterm);  /* Apply the customized terminal setting */
+        __r = __conio_in_fill_keys(__t, __timeout_ms);  /* Retrieve the available characters */
+        tcsetattr(__t->in_fd, TCSANOW, &__oldterm);  /* Restore original terminal setting */
+#else  /* Implementation for Windows */
+        HANDLE handler = GetStdHandle(STD_INPUT_HANDLE);
+        DWORD console_mode, original_mode;
+
+        GetConsoleMode(handler, &console_mode);
+        original_mode = console_mode;  /* Copy the original console setting */
+
+        /* Set the console mode to disable line input and echo input (the echo is written by `getche()`) */
+        console_mode &= ~(ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT);
+
+        /* Apply the customized console setting */
+        SetConsoleMode(handler, console_mode);
+
+        /* Read the available characters from the console input buffer */
+        __r = __conio_in_fill_keys(__t, __timeout_ms);
+
+        /* Restore original console mode */
+        SetConsoleMode(handler, original_mode);
+#endif  /* (__unix__ || __unix) || __ANDROID__ */
+    }
+    if (__r < 0) return -1;
+    return __conio_in_avail(__t) > 0;
+}
+
+/**
+ * @brief Retrieves a single character from the standard input without echoing.
+ *
+ * This function retrieves a character from the standard input without echoing it
+ * to the console. It is designed for use in console-based applications
+ * where user input needs to be read without displaying the entered characters.
+ *
+ * This is designed for internal use only and it is used by these two API functions:
+ *   - `getch()` - is an alias for `__getch(GETCH_NO_ECHO)` (without buffer)
+ *   - `getche()` - is an alias for `__getch(GETCH_USE_ECHO)` (with buffer)
+ *
+ * @param[in] __echo  Flag indicating whether to echo the input, see @ref GETCH_ECHO enum.
+ * @return            The retrieved character from the standard input.
+ *
+ * @note This function is platform-dependent. On Unix systems, it uses `termios.h` header
+ *       to customize the terminal settings, while on Windows, it manipulates the
+ *       console mode using Windows API (`windows.h`). Inside a session (see
+ *       @ref conio_session_begin()) the terminal settings are left untouched.
+ *       All available input is read into the read-ahead buffer at once, and the
+ *       echo is written by this function rather than by the terminal.
+ *
+ * @warning This function may not behave as expected on non-terminal input streams.
+ *          It is intended for console-based applications.
+ *
+ * @since 0.1.0
+ */
+static int __getch(conio_term_t* __t, GETCH_ECHO const __echo) {
+    int __c;
+
+    __conio_out_input(__t);
+    if (__conio_in_wait(__t, -1) < 0) return EOF;
+
+    __c = __conio_in_pop(__t);
+    if (__echo && __c != EOF) {
+        char __ch = (char)__c;
+        __conio_out_put(__t, &__ch, 1);
+        __conio_out_flush(__t);
+        __conio_cur_advance(__t, &__ch, 1);
+    }
+    return __c;  /* Return the retrieved character */
+}
+
+
+/**
+ * @brief Waits for the replies to the outstanding cursor position queries.
+ *
+ * @param[in] __all  Non-zero to wait for the replies to every outstanding query,
+ *                   zero to wait for the oldest reply only.
+ * @param[in] __ms   Maximum time to wait in milliseconds, or a negative value to wait
+ *                   until the replies arrive.
+ * @return           1 once the replies are received, 0 if the timeout expired, or -1
+ *                   if no query is outstanding or at the end of the input.
+ *
+ * @since 0.4.0
+ */
+static int __conio_cpr_wait(conio_term_t* __t, int __all, int __ms) {
+    unsigned long start = __conio_now_ms();
+
+    if (__t->in.replies == 0 && __t->in.pending == 0) return -1;
+    __conio_out_flush(__t);  /* The queries must reach the terminal before waiting */
+    while (__all ? __t->in.pending > 0 : __t->in.replies == 0) {
+        int wait = __ms, r;
+        if (__ms >= 0) {  /* Read at least once, even when the time is up */
+            unsigned long elapsed = __conio_now_ms() - start;
+            wait = (elapsed >= (unsigned long)__ms) ? 0 : (int)((unsigned long)__ms - elapsed);
+        }
+        r = __conio_in_fill(__t, wait);
+        if (r < 0) return -1;
+        /* Unread keys fill the buffer, the reply cannot be received */
+        if (r == 0 && (wait == 0 || __conio_in_avail(__t) == CONIO_INBUF_SIZE)) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Counts a cursor position query about to be written as pending.
+ *
+ * @return Returns 0, or -1 if too many queries are outstanding.
+ *
+ * @since 0.4.0
+ */
+static int __conio_cpr_reserve(conio_term_t* __t) {
+    /* A terminal that has not answered for a whole timeout (a detached tmux) never will */
+    if (__t->in.drop && __conio_now_ms() - __t->in.drop_at >= CONIO_QUERY_TIMEOUT)
+        while (__conio_cpr_forget(__t)) {}
+    if (__t->in.pending + __t->in.replies >= CONIO_CPR_MAX && !__conio_cpr_forget(__t)) return -1;
+    __t->in.pending++;
+    return 0;
+}
+
+/**
+ * @brief Same as @ref conio_cursor_query(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_cursor_query_ctx(conio_term_t* term) {
+#ifdef __HAVE_WINDOWS_API
+    if (!term->be) return -1;  /* The console API answers at once, see wherexy() */
+#endif
+    if (__conio_cpr_reserve(term) != 0) return -1;
+    __conio_out_put(term, ESC "[6n", 4);
+    __conio_out_end(term);
+    return 0;
+}
+
+/**
+ * @brief Asks the terminal for the cursor position, without waiting for the reply.
+ *
+ * The query (`"\033[6n"`) is written like any other output; the reply is taken out
+ * of the input whenever it is read, by @ref conio_cursor_reply() or by any function
+ * reading keys, so it never reaches `getch()`. Keys pressed before the reply arrives
+ * are kept. Up to @ref CONIO_CPR_MAX queries may be outstanding, their replies are
+ * returned in order, so several positions can be measured with a single wait:
+ *
+ * ```c
+ * cpos_t x1, y1, x2, y2;
+ * conio_cursor_query();
+ * cputs("\xe4\xbd\xa0");  // Measure the width of a character
+ * conio_cursor_query();
+ * if (conio_cursor_reply(&x1, &y1, 100) == 1 && conio_cursor_reply(&x2, &y2, 100) == 1)
+ *     printf("width: %d\n", (int)(x2 - x1));
+ * ```
+ *
+ * Queries given up on by `wherexy()` stop counting once the terminal has not answered
+ * them for @ref CONIO_QUERY_TIMEOUT milliseconds more, or when the limit is reached.
+ *
+ * @return Returns 0 if the query was sent, or -1 if too many queries are outstanding.
+ *
+ * @note The terminal must be in non-canonical mode without echo, inside a session
+ *       (see @ref conio_session_begin()) or on a backend, otherwise the reply is echoed
+ *       and held until Enter is pressed.
+ *
+ * @warning While queries are outstanding, *Shift+F3* sends the same sequence as a reply
+ *          on many terminals (`"\033[1;2R"`) and is taken for one.
+ *
+ * @since 0.4.0
+ * @see   conio_cursor_reply(cpos_t*, cpos_t*, int)
+ */
+int conio_cursor_query(void) {
+    return conio_cursor_query_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref conio_cursor_reply(cpos_t*, cpos_t*, int), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_cursor_reply_ctx(conio_term_t* term, cpos_t* x, cpos_t* y, int ms) {
+    int r = __conio_cpr_wait(term, 0, ms);
+    if (r <= 0) return r;
+
+    if (x) *x = term->in.rx[term->in.first];
+    if (y) *y = term->in.ry[term->in.first];
+    term->in.first = (term->in.first + 1) % CONIO_CPR_MAX;
+    term->in.replies--;
+    __conio_cpr_trim(term);
+    return 1;
+}
+
+/**
+ * @brief Retrieves the reply to the oldest outstanding cursor position query.
+ *
+ * Reads the input until the reply arrives or the timeout expires. Keys read
+ * meanwhile are left for `getch()`, replies to the later queries are queued.
+ *
+ * @param[out] x   Receives the X-coordinate, may be `NULL`.
+ * @param[out] y   Receives the Y-coordinate, may be `NULL`.
+ * @param[in]  ms  Maximum time to wait in milliseconds, 0 to only take a reply already
+ *                 received, or a negative value to wait until it arrives.
+ * @return         Returns 1 with the position, 0 if the timeout expired (the query stays
+ *                 outstanding), or -1 if no query is outstanding or the input has ended.
+ *
+ * @since 0.4.0
+ * @see   conio_cursor_query()
+ */
+int conio_cursor_reply(cpos_t* x, cpos_t* y, int ms) {
+    return conio_cursor_reply_ctx(&__conio_def, x, y, ms);
+}
+
+/**
+ * @brief Takes the reply to the newest cursor position query, asked by this library.
+ *
+ * The reply comes after those to the application's queries, which stay queued.
+ * If it does not arrive in time, it is dropped when it comes, rather than being
+ * left to `getch()` or taken for the reply to a later query.
+ *
+ * @param[out] __x   Receives the X-coordinate, may be `NULL`.
+ * @param[out] __y   Receives the Y-coordinate, may be `NULL`.
+ * @param[in]  __ms  Maximum time to wait in milliseconds, 0 to only take a reply already received.
+ * @return           1 with the position, or 0 if the reply has not arrived.
+ *
+ * @since 0.4.0
+ */
+static int __conio_cpr_newest(conio_term_t* __t, cpos_t* __x, cpos_t* __y, int __ms) {
+    int i;
+
+    if (__conio_cpr_wait(__t, 1, __ms) == 1) {
+        i = (__t->in.first + __t->in.replies - 1) % CONIO_CPR_MAX;
+        if (__x) *__x = __t->in.rx[i];
+        if (__y) *__y = __t->in.ry[i];
+        __t->in.replies--;
+        return 1;
+    }
+    if (__t->in.pending > 0) {
+        i = (__t->in.first + __t->in.replies + __t->in.pending - 1) % CONIO_CPR_MAX;
+        __t->in.drop |= 1u << i;
+        __t->in.drop_at = __conio_now_ms();
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Retrieves the current coordinates of the cursor on the terminal screen.
+ *
+ * This function is designed to work on both Unix-like systems and Windows. On Unix-like
+ * systems, it uses ANSI escape sequences to query the cursor position. On Windows, it
+ * utilizes the Windows Console API to obtain the cursor coordinates.
+ *
+ * This function is designed for internal use only and it is being used by these API functions:
+ *   - `wherex()`                  - Retrieves the current X-coordinate of the cursor position
+ *   - `wherey()`                  - Retrieves the current Y-coordinate of the cursor position
+ *   - `wherexy(cpos_t*, cpos_t*)` - Retrieves the current both coordinates of the cursor position
+ *                                   stored in provided pointer variables
+ *
+ * @param[in,out] __px  Pointer to a variable where the X-coordinate of the cursor will be stored.
+ * @param[in,out] __py  Pointer to a variable where the Y-coordinate of the cursor will be stored.
+ *
+ * @note For Unix-like systems, this function sends the ANSI escape sequence `"\033[6n"`
+ *       to the terminal and waits up to @ref CONIO_QUERY_TIMEOUT milliseconds for the
+ *       response, see @ref conio_cursor_query(). Keys pressed meanwhile are kept, and a
+ *       response arriving after the timeout is discarded. On Windows, it uses the
+ *       Windows Console API to get the cursor position.
+ *
+ * @warning This function may not work correctly in all terminal emulators or environments,
+ *          especially if the terminal does not support ANSI escape sequences. Ensure that your
+ *          target environment supports the necessary features.
+ *
+ * @since 0.1.0
+ * @see   wherexy(cpos_t*, cpos_t*)
+ */
+static void __whereis_xy(conio_term_t* __t, cpos_t* __px, cpos_t* __py) {
+    cpos_t x = 0, y = 0;  /* Variables to hold the coordinates */
+
+#ifdef __HAVE_WINDOWS_API
+    HANDLE handler = GetStdHandle(STD_OUTPUT_HANDLE);
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+
+    if (GetConsoleScreenBufferInfo(handler, &csbi)) {
+        /* The coordinates are zero-based, it is unnecessary
+         * to add one to each coordinate
+         */
+        x = csbi.dwCursorPosition.X;
+        y = csbi.dwCursorPosition.Y;
+    }
+#else  /* Body function for Unix-like systems */
+    /* Keep the terminal in non-canonical, no-echo mode for the whole query,
+     * so the reply is neither echoed nor read byte by byte with a terminal
+     * reconfiguration in between.
+     */
+    int began = (__t->sess.depth == 0 && conio_session_begin_ctx(__t) == 0);
+    int ok = (conio_cursor_query_ctx(__t) == 0 && __conio_cpr_newest(__t, &x, &y, CONIO_QUERY_TIMEOUT));
+
+    if (began) conio_session_end_ctx(__t);
+    if (!ok) return;
+#endif  /* __HAVE_WINDOWS_API */
+    /* Store and assign the cursor position */
+    *__px = x;
+    *__py = y;
+}
+
+
+
+/**
+ * @brief Same as @ref conio_cursor_sync(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_cursor_sync_ctx(conio_term_t* term) {
+    cpos_t x = 0, y = 0;
+    if (!term->cur.enabled) return -1;
+
+    __whereis_xy(term, &x, &y);
+    if (x <= 0 || y <= 0) {
+        term->cur.valid = 0;
+        return -1;
+    }
+    __conio_cur_set(term, x, y);
+    return 0;
+}
+
+/**
+ * @brief Resynchronises the shadow cursor with the terminal.
+ *
+ * Queries the real cursor position from the terminal (a full round trip) and
+ * stores it in the cursor model. Call this after writing to the terminal
+ * with functions outside of this library, such as `printf()`, while tracking is enabled.
+ *
+ * @return Returns 0 on success, or -1 if tracking is disabled or the terminal
+ *         did not report its cursor position.
+ *
+ * @since 0.4.0
+ * @see   conio_cursor_track(int)
+ */
+int conio_cursor_sync(void) {
+    return conio_cursor_sync_ctx(&__conio_def);
+}
+
+/**
+ * @brief Retrieves the cursor position, from the cursor model if possible.
+ *
+ * Used by `wherex()`, `wherey()` and `wherexy()`. Falls back to querying the
+ * terminal with @ref __whereis_xy if tracking is disabled.
+ *
+ * @param[in,out] __px  Pointer to a variable where the X-coordinate will be stored.
+ * @param[in,out] __py  Pointer to a variable where the Y-coordinate will be stored.
+ *
+ * @since 0.4.0
+ */
+static void __conio_where(conio_term_t* __t, cpos_t* __px, cpos_t* __py) {
+    if (__t->cur.enabled && (__t->cur.valid || conio_cursor_sync_ctx(__t) == 0)) {
+        *__px = __t->cur.x;
+        *__py = __t->cur.y;
+        return;
+    }
+    __whereis_xy(__t, __px, __py);
+}
+
+/**
+ * @brief Same as @ref conio_cursor_track(int), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_cursor_track_ctx(conio_term_t* term, int const enable) {
+#ifdef __HAVE_WINDOWS_API
+    (void)enable;
+    return -1;
+#else
+    if (!enable) {
+        term->cur.enabled = 0;
+        term->cur.valid = 0;
+        return 0;
+    }
+
+    struct termios tio;
+    if (conio_getsize_ctx(term, &term->cur.cols, &term->cur.rows) != 0)
+        term->cur.cols = term->cur.rows = 0;
+    term->cur.crlf = 1;
+    if (!term->be && tcgetattr(term->out_fd, &tio) == 0)
+        term->cur.crlf = (tio.c_oflag & OPOST) && (tio.c_oflag & ONLCR);
+
+    term->cur.esc = __CONIO_ESC_NONE;
+    term->cur.enabled = 1;
+    conio_cursor_sync_ctx(term);
+    return 0;
+#endif  /* __HAVE_WINDOWS_API */
+}
+
+/**
+ * @brief Enables or disables the shadow cursor model.
+ *
+ * Without tracking, `wherex()`, `wherey()` and `wherexy()` send a cursor position
+ * query (`"\033[6n"`) and wait for the reply on every call, and `gotox()` and `gotoy()`
+ * do the same internally. With tracking enabled, the library
+ * computes the cursor position from everything it writes (`gotoxy()`, `putch()`,
+ * `cputs()`, `delline()`, `clrscr()`, ...), so these functions produce output only.
+ * The terminal is queried once when tracking is enabled and after that only by
+ * @ref conio_cursor_sync(), or when the model becomes invalid (e.g. after an
+ * escape sequence with an unknown effect has been written).
+ *
+ * @param[in] enable  Non-zero to enable tracking, zero to disable it.
+ * @return            Returns 0 on success, or -1 if tracking is unavailable
+ *                    (on Windows console, where the position is already known locally).
+ *
+ * @attention Output written with functions outside of this library (e.g. `printf()`)
+ *            is not seen by the model. Call @ref conio_cursor_sync() afterwards.
+ *
+ * @since 0.4.0
+ * @see   conio_cursor_sync(void)
+ */
+int conio_cursor_track(int const enable) {
+    return conio_cursor_track_ctx(&__conio_def, enable);
+}
+
+/** Modes whose state @ref conio_probe() requests with `DECRQM`. */
+static unsigned int const __conio_probe_modes[] = { 2026, 2004, 1049, 1004 };
+
+/**
+ * @brief Same as @ref conio_probe(conio_probe_t*), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_probe_ctx(conio_term_t* term, conio_probe_t* result) {
+    static const char query[] =
+        ESC "[c"                                /* DA1 */
+        ESC "[>c"                               /* DA2 */
+        ESC "[>0q"                              /* XTVERSION */
+        ESC "[?2026$p" ESC "[?2004$p"           /* DECRQM */
+        ESC "[?1049$p" ESC "[?1004$p"
+        ESC "[6n";                              /* DSR, answered last */
+    conio_probe_t* pr = &term->probe;
+    unsigned int p[16];
+    unsigned long start, elapsed;
+    int began, final, np, asked, got = 0, done = 0;
+    size_t len;
+    char seq[80];
+    int privs = (int)(sizeof(__conio_probe_modes) / sizeof(__conio_probe_modes[0])) + 3;
+
+    if (pr->done) goto out;
+    memset(pr, 0, sizeof(*pr));
+    pr->type = pr->version = -1;
+    pr->done = 1;
+    term->known |= CONIO_CAP_SYNC;  /* Not probed again by conio_frame_begin() */
+#ifdef __HAVE_WINDOWS_API
+    if (!term->be) goto out;  /* The console does not answer queries */
+#else
+    if (!term->be && (!isatty(term->in_fd) || !isatty(term->out_fd))) goto out;
+#endif  /* __HAVE_WINDOWS_API */
+
+    /* Keep the replies from being echoed or held back by the line discipline */
+    began = (term->sess.depth == 0 && conio_session_begin_ctx(term) == 0);
+    /* The position request queues behind the application's ones, see conio_cursor_query() */
+    asked = (__conio_cpr_reserve(term) == 0);
+    __conio_out_put(term, query, sizeof(query) - (asked ? 1 : 5));
+    __conio_out_flush(term);
+
+    start = __conio_now_ms();
+    for (;;) {
+        while ((final = __conio_in_reply(term, seq, sizeof(seq), __CONIO_REPLY_PRIV)) > 0) {
+            got = 1;
+            privs--;
+            np = __conio_reply_params(seq + (seq[0] == '?' || seq[0] == '>'), p, 16);
+            if (final == 'c' && seq[0] == '?' && np > 0) {  /* "\033[?{level};...c" */
+                pr->level = p[0];
+            } else if (final == 'c' && seq[0] == '>' && np > 1) {  /* "\033[>{type};{version};...c" */
+                pr->type = (int)p[0];
+                pr->version = (int)p[1];
+            } else if (final == 'y' && seq[0] == '?' && np == 2) {  /* "\033[?{mode};{Ps}$y" */
+                if (p[0] == 2026)      pr->sync = (int)p[1];
+                else if (p[0] == 2004) pr->paste = (int)p[1];
+                else if (p[0] == 1049) pr->altscreen = (int)p[1];
+                else if (p[0] == 1004) pr->focus = (int)p[1];
+            } else if (final == 'P' && seq[0] == '>' && seq[1] == '|') {  /* "\033P>|{name}\033\\" */
+                len = strlen(seq + 2);
+                memcpy(pr->name, seq + 2, len < sizeof(pr->name) ? len : sizeof(pr->name) - 1);
+            }
+        }
+        if (asked && term->in.pending == 0) break;  /* The position report came, after the others */
+        elapsed = __conio_now_ms() - start;
+        if (elapsed >= CONIO_QUERY_TIMEOUT) break;
+        if (__conio_in_fill(term, (int)(CONIO_QUERY_TIMEOUT - elapsed)) <= 0) break;
+    }
+    /* Abandoned on timeout like by wherexy(), the replies still to come are discarded */
+    if (asked && __conio_cpr_newest(term, &pr->x, &pr->y, 0) == 1) got = done = 1;
+    else if (privs > 0) term->in.late = privs;
+    if (began) conio_session_end_ctx(term);
+    if (!got) goto out;
+
+    /* ECH came with the VT220; REP is assumed for xterm compatibles answering XTVERSION */
+    pr->answered = 1;
+    pr->caps = CONIO_CAP_EL;
+    if (pr->level >= 62) pr->caps |= CONIO_CAP_ECH;
+    if (pr->level >= 62 && pr->name[0]) pr->caps |= CONIO_CAP_REP;
+    if (pr->sync == 1 || pr->sync == 2) pr->caps |= CONIO_CAP_SYNC;
+    term->caps = pr->caps;
+    term->known = ~0u;
+    if (done && term->cur.enabled) __conio_cur_set(term, pr->x, pr->y);
+
+out:
+    if (result) *result = *pr;
+    return pr->answered ? 0 : -1;
+}
+
+/**
+ * @brief Identifies the terminal and detects its capabilities in one round trip.
+ *
+ * Writes the primary and secondary device attributes requests (`DA1`, `DA2`), the
+ * name and version request (`XTVERSION`), mode requests (`DECRQM`) for synchronized
+ * output, bracketed paste, the alternate screen and focus events, and a cursor
+ * position request at once, then reads the replies until the cursor position report,
+ * which every terminal sends last, arrives or @ref CONIO_QUERY_TIMEOUT milliseconds
+ * have passed. Asking one question at a time would take one round trip each, which
+ * adds up over a remote connection. Keys pressed meanwhile are kept, and replies
+ * arriving after the timeout are discarded rather than read as keys.
+ *
+ * The capabilities deduced from the replies replace the ones set with
+ * @ref conio_setcaps(). The results are cached in the context: only the first call
+ * queries the terminal. Nothing is written if the standard input or output is not
+ * a terminal.
+ *
+ * Example
+ * -------
+ * ```c
+ * conio_probe_t info;
+ * if (conio_probe(&info) == 0 && info.name[0])
+ *     printf("Running in %s\n", info.name);
+ * ```
+ *
+ * @param[out] result  Receives the results, can be `NULL`.
+ * @return             Returns 0 if the terminal answered, or -1 otherwise.
+ *
+ * @since 0.4.0
+ * @see   conio_getcaps(void)
+ */
+int conio_probe(conio_probe_t* result) {
+    return conio_probe_ctx(&__conio_def, result);
+}
+
+/**
+ * @brief Same as @ref conio_frame_begin(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_frame_begin_ctx(conio_term_t* term) {
+    if (term->out.frame++ > 0) return term->out.sync;  /* Nested, part of the outer frame */
+
+    if (!(term->known & CONIO_CAP_SYNC)) conio_probe_ctx(term, NULL);
+    term->out.hold++;
+    term->out.sync = (term->caps & CONIO_CAP_SYNC) != 0;
+    if (term->out.sync) __conio_out_put(term, ESC "[?2026h", 8);
+    return term->out.sync;
+}
+
+/**
+ * @brief Begins a frame, a screen update the terminal should display at once.
+ *
+ * The output of every function called until @ref conio_frame_end() is buffered and
+ * written when the frame ends. A large frame still takes several writes, and the
+ * terminal may display the screen half-updated in between; when the terminal
+ * supports synchronized output (@ref CONIO_CAP_SYNC), the frame is wrapped in
+ * `"\033[?2026h"` and `"\033[?2026l"`, and the terminal applies it atomically.
+ *
+ * Unless @ref conio_probe() or @ref conio_setcaps() has been called, the first frame
+ * calls @ref conio_probe() to find out whether the terminal supports it, which costs
+ * one round trip to the terminal; keys pressed meanwhile are kept.
+ * Frames may be nested, only the outermost one counts.
+ *
+ * Example
+ * -------
+ * ```c
+ * conio_frame_begin();
+ * clrscr();
+ * for (y = 1; y <= 24; y++) {
+ *     gotoxy(1, y); cputs(lines[y - 1]);
+ * }
+ * conio_frame_end();  // Displayed at once, without tearing
+ * ```
+ *
+ * @return Returns 1 if the terminal applies the frame atomically, or 0 if the
+ *         output is only buffered.
+ *
+ * @since 0.4.0
+ * @see   conio_frame_end(void)
+ */
+int conio_frame_begin(void) {
+    return conio_frame_begin_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref conio_frame_end(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_frame_end_ctx(conio_term_t* term) {
+    if (term->out.frame == 0 || --term->out.frame > 0) return 0;
+
+    if (term->out.sync) __conio_out_put(term, ESC "[?2026l", 8);
+    term->out.sync = 0;
+    term->out.hold--;
+    return __conio_out_flush(term);
+}
+
+/**
+ * @brief Ends the frame begun with @ref conio_frame_begin() and writes it to the terminal.
+ *
+ * Does nothing for a nested frame, or if no frame has begun.
+ *
+ * @return Returns 0 on success, or -1 if writing to the terminal failed.
+ *
+ * @since 0.4.0
+ * @see   conio_frame_begin(void)
+ */
+int conio_frame_end(void) {
+    return conio_frame_end_ctx(&__conio_def);
+}
+
+
+/**
+ * @brief Appends the cursor position sequence (`"\033[{y};{x}H"`) to the output buffer.
+ *
+ * @param[in] __x  The target column.
+ * @param[in] __y  The target row.
+ *
+ * @since 0.4.0
+ */
+static void __conio_out_cup(conio_term_t* __t, cpos_t const __x, cpos_t const __y) {
+    char* p = __conio_out_reserve(__t, CONIO_ENC_MAX);
+    __conio_out_commit(__t, p, conio_enc_cup(p, __x, __y));
+}
+
+/**
+ * @brief Appends the scrolling region sequence (`DECSTBM`, `"\033[{top};{bottom}r"`) to the
+ *        output buffer, or `"\033[r"` to remove the region if @p __top is zero.
+ *
+ * The terminal moves the cursor to the home position.
+ *
+ * @since 0.4.0
+ */
+static void __conio_out_region(conio_term_t* __t, cpos_t const __top, cpos_t const __bottom) {
+    char* p = __conio_out_reserve(__t, CONIO_ENC_MAX);
+    size_t len = 2;
+    p[0] = '\033';
+    p[1] = '[';
+    if (__top > 0) {
+        len += __conio_enc_uint(p + len, (unsigned int)__top);
+        p[len++] = ';';
+        len += __conio_enc_uint(p + len, (unsigned int)__bottom);
+    }
+    p[len++] = 'r';
+    __conio_out_commit(__t, p, len);
+}
+
+/** Ways of moving the cursor, see @ref __conio_out_move. */
+enum {
+    __CONIO_MV_NONE,   /**< Already there. */
+    __CONIO_MV_ABS,    /**< `CHA` or `VPA`. */
+    __CONIO_MV_REL,    /**< `CUF`, `CUB`, `CUU` or `CUD`. */
+    __CONIO_MV_CHARS,  /**< Backspaces or line feeds. */
+    __CONIO_MV_PRINT,  /**< Rewrite the cells in between. */
+    __CONIO_MV_CR      /**< Carriage return, then one of the above from the first column. */
+};
+
+/**
+ * @brief Returns the length of a control sequence with one numeric parameter.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_csi1_len(cpos_t __n, cpos_t __def) {
+    size_t len = 3;
+    if (__n != __def) {
+        do { len++; __n /= 10; } while (__n > 0);
+    }
+    return len;
+}
+
+/**
+ * @brief Checks whether the cells in columns `[__from, __to)` can be rewritten
+ *        as single bytes with the attributes @p __attr.
+ *
+ * @since 0.4.0
+ */
+static int __conio_move_printable(const conio_cell_t* __row, cpos_t __from, cpos_t __to, uint32_t __attr) {
+    cpos_t i;
+    if (!__row) return 0;
+    for (i = __from; i < __to; i++) {
+        const conio_cell_t* c = &__row[i - 1];
+        if (c->ch < 0x20 || c->ch >= 0x7F || c->attr != __attr) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Finds the cheapest horizontal movement from column @p __c to column @p __x.
+ *
+ * @param[in]  __c     The current column, zero if unknown.
+ * @param[in]  __x     The target column.
+ * @param[in]  __row   The cells of the row, `NULL` if unknown.
+ * @param[in]  __attr  The current attributes.
+ * @param[out] __how   Receives the movement, one of the `__CONIO_MV_*` values. For
+ *                     @ref __CONIO_MV_CR, @p __how2 receives the movement that follows.
+ * @return             The number of bytes of the movement.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_move_h(cpos_t __c, cpos_t __x, const conio_cell_t* __row,
+                             uint32_t __attr, int* __how, int* __how2) {
+    size_t best = __conio_csi1_len(__x, 1), cost;
+    *__how = __CONIO_MV_ABS;
+    *__how2 = __CONIO_MV_NONE;
+
+    if (__c == __x) {
+        *__how = __CONIO_MV_NONE;
+        return 0;
+    }
+    if (__c > 0) {
+        cpos_t d = (__x > __c) ? __x - __c : __c - __x;
+        if ((cost = __conio_csi1_len(d, 1)) < best) {
+            best = cost;
+            *__how = __CONIO_MV_REL;
+        }
+        if (__x < __c && (size_t)d < best) {
+            best = (size_t)d;
+            *__how = __CONIO_MV_CHARS;
+        }
+        if (__x > __c && (size_t)d < best && __conio_move_printable(__row, __c, __x, __attr)) {
+            best = (size_t)d;
+            *__how = __CONIO_MV_PRINT;
+        }
+    }
+
+    /* From the first column after a carriage return */
+    if (__x == 1) cost = 1;
+    else cost = 1 + __conio_csi1_len(__x - 1, 1);
+    if (cost < best) {
+        best = cost;
+        *__how = __CONIO_MV_CR;
+        *__how2 = (__x == 1) ? __CONIO_MV_NONE : __CONIO_MV_REL;
+    }
+    if (__x > 1 && (size_t)__x < best && __conio_move_printable(__row, 1, __x, __attr)) {
+        best = (size_t)__x;
+        *__how = __CONIO_MV_CR;
+        *__how2 = __CONIO_MV_PRINT;
+    }
+    return best;
+}
+
+/**
+ * @brief Appends a horizontal movement found by @ref __conio_move_h.
+ *
+ * @since 0.4.0
+ */
+static void __conio_out_move_h(conio_term_t* __t, cpos_t __c, cpos_t __x, const conio_cell_t* __row,
+                               int __how, int __how2) {
+    char* p = __conio_out_reserve(__t, CONIO_ENC_MAX);
+    size_t len = 0;
+    cpos_t i;
+
+    if (__how == __CONIO_MV_CR) {
+        p[len++] = '\r';
+        __c = 1;
+        __how = __how2;
+    }
+    switch (__how) {
+    case __CONIO_MV_ABS:
+        len += __conio_enc_csi1(p + len, __x, 1, 'G');
+        break;
+    case __CONIO_MV_REL:
+        len += (__x > __c) ? __conio_enc_csi1(p + len, __x - __c, 1, 'C')
+                           : __conio_enc_csi1(p + len, __c - __x, 1, 'D');
+        break;
+    case __CONIO_MV_CHARS:
+    case __CONIO_MV_PRINT:
+        /* Shorter than the sequences, so it fits */
+        for (i = 0; i < ((__x > __c) ? __x - __c : __c - __x); i++)
+            p[len++] = (__how == __CONIO_MV_CHARS) ? '\b' : (char)__row[__c + i - 1].ch;
+        break;
+    default:
+        break;
+    }
+    __conio_out_commit(__t, p, len);
+}
+
+/**
+ * @brief Appends the shortest cursor movement from one position to another.
+ *
+ * Chooses between an absolute position (`CUP`), the absolute column and row
+ * (`CHA`, `VPA`), relative movements (`CUF`, `CUB`, `CUU`, `CUD`), carriage return,
+ * line feeds, backspaces, and rewriting the cells in between when their contents
+ * are known, like the `mvcur()` function of curses.
+ *
+ * @param[in] __fx    The current column, zero if unknown (e.g. while a wrap is pending).
+ * @param[in] __fy    The current row, zero if unknown.
+ * @param[in] __x     The target column, within the screen.
+ * @param[in] __y     The target row, within the screen.
+ * @param[in] __row   The cells of the target row as displayed, `NULL` if unknown.
+ * @param[in] __attr  The current attributes, used to rewrite cells.
+ *
+ * @since 0.4.0
+ */
+static void __conio_out_move(conio_term_t* __t, cpos_t __fx, cpos_t __fy, cpos_t __x, cpos_t __y,
+                             const conio_cell_t* __row, uint32_t __attr) {
+    size_t best, cost;
+    int how, how2, vhow = __CONIO_MV_NONE, h, h2, rel = 1;
+    cpos_t c, d;
+
+    if (__fy <= 0) {
+        __conio_out_cup(__t, __x, __y);
+        return;
+    }
+    best = __conio_csi1_len(__y, -1) + __conio_csi1_len(__x, -1) - 2;  /* CUP */
+    how = -1;
+    how2 = __CONIO_MV_NONE;
+
+    /* Each vertical movement, followed by the best horizontal one */
+    d = (__y > __fy) ? __y - __fy : __fy - __y;
+    if (d > 0 && __t->cur.bottom > 0
+        && (__fy < __t->cur.top) + (__fy > __t->cur.bottom) * 2
+           != (__y < __t->cur.top) + (__y > __t->cur.bottom) * 2) {
+        rel = 0;  /* The margins of the scrolling region stop relative movements */
+    }
+    if (d == 0) {
+        if ((cost = __conio_move_h(__fx, __x, __row, __attr, &h, &h2)) < best) {
+            best = cost;
+            how = h; how2 = h2; vhow = __CONIO_MV_NONE;
+        }
+    } else {
+        cost = __conio_csi1_len(d, 1) + __conio_move_h(__fx, __x, __row, __attr, &h, &h2);
+        if (rel && cost < best) {
+            best = cost;
+            how = h; how2 = h2; vhow = __CONIO_MV_REL;
+        }
+        cost = __conio_csi1_len(__y, 1) + __conio_move_h(__fx, __x, __row, __attr, &h, &h2);
+        if (cost < best) {
+            best = cost;
+            how = h; how2 = h2; vhow = __CONIO_MV_ABS;
+        }
+        if (rel && __y > __fy && (size_t)d < best && __t->cur.enabled) {
+            /* Line feeds may return to the first column, as known with tracking enabled */
+            c = __t->cur.crlf ? 1 : __fx;
+            cost = (size_t)d + __conio_move_h(c, __x, __row, __attr, &h, &h2);
+            if (cost < best) {
+                best = cost;
+                how = h; how2 = h2; vhow = __CONIO_MV_CHARS;
+            }
+        }
+    }
+
+    if (how < 0) {
+        __conio_out_cup(__t, __x, __y);
+        return;
+    }
+
+    c = __fx;
+    if (vhow != __CONIO_MV_NONE) {
+        char* p = __conio_out_reserve(__t, CONIO_ENC_MAX);
+        size_t len = 0;
+        cpos_t i;
+        switch (vhow) {
+        case __CONIO_MV_REL:
+            len = (__y > __fy) ? __conio_enc_csi1(p, d, 1, 'B') : __conio_enc_csi1(p, d, 1, 'A');
+            break;
+        case __CONIO_MV_ABS:
+            len = __conio_enc_csi1(p, __y, 1, 'd');
+            break;
+        default:  /* Fewer line feeds than the bytes of a sequence */
+            for (i = 0; i < d; i++) p[len++] = '\n';
+            if (__t->cur.crlf) c = 1;
+            break;
+        }
+        __conio_out_commit(__t, p, len);
+    }
+    if (how != __CONIO_MV_NONE) __conio_out_move_h(__t, c, __x, __row, how, how2);
+}
+
+/**
+ * @brief Same as @ref gotoxy(cpos_t, cpos_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void gotoxy_ctx(conio_term_t* term, cpos_t const x, cpos_t const y) {
+#ifdef __HAVE_WINDOWS_API  /* For Windows */
+    HANDLE handler = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (handler != INVALID_HANDLE_VALUE) {
+        COORD coord;
+        coord.X = (SHORT)x;
+        coord.Y = (SHORT)y;
+        SetConsoleCursorPosition(handler, coord);
+    }
+#else
+    if (term->cur.enabled && term->cur.valid) {
+        /* The position is known, so a shorter relative movement may do */
+        __conio_out_move(term, term->cur.wrap ? 0 : term->cur.x, term->cur.y,
+                         __conio_cur_clamp(x, term->cur.cols), __conio_cur_clamp(y, term->cur.rows),
+                         NULL, CONIO_ATTR_DEFAULT);
+    } else {
+        __conio_out_cup(term, x, y);  /* Use the correct ANSI escape sequence */
+    }
+    __conio_out_end(term);
+#endif  /* __HAVE_WINDOWS_API */
+    __conio_cur_set(term, x, y);
+}
+
+/**
+ * @brief Moves the cursor to the specified coordinates on the terminal screen.
+ *
+ * This function moves the cursor to the specified (`x`, `y`) position on the terminal screen.
+ * On Windows, it utilizes the [`SetConsoleCursorPosition`](https://learn.microsoft.com/en-us/windows/console/setconsolecursorposition)
+ * function provided by `windows.h`, and on Unix-like systems, it uses ANSI escape sequences
+ * to achieve the same effect.
+ *
+ * @param[in] x  The horizontal (column) position to move the cursor to.
+ * @param[in] y  The vertical (row) position to move the cursor to.
+ *
+ * Example
+ * -------
+ * ```c
+ * // Move the cursor to the top-left
+ * gotoxy(0, 0);
+ * ```
+ *
+ * @note On Unix-like systems, this function uses the ANSI escape sequence `"\033[{y};{x}H"`
+ *       to move the cursor to the specified position. It supports both **MSYS2** and
+ *       **Cygwin** environments. However, the behavior may vary across different terminals.
+ *
+ * @note When the cursor position is tracked (see @ref conio_cursor_track()), the
+ *       shortest movement from the current position is written instead, for example
+ *       `"\033[C"` for one column to the right or `"\n"` for the start of the next line.
+ *
+ * @attention The ANSI escape sequence used on Unix-like systems might not be supported
+ *            by all terminals.
+ *
+ * @since 0.1.0
+ */
+void gotoxy(cpos_t const x, cpos_t const y) {
+    gotoxy_ctx(&__conio_def, x, y);
+}
+
+/**
+ * @brief Same as @ref clrscr(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void clrscr_ctx(conio_term_t* term) {
+/* Windows system but not using the Cygwin neither MSYS2 environment,
+ * which means it uses the Command Prompt or PowerShell
+ */
+#if defined(__WIN_PLATFORM_32) && ! defined(__CYGWIN_ENV)
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (hConsole != INVALID_HANDLE_VALUE) {
+        CONSOLE_SCREEN_BUFFER_INFO csbi;
+        if (GetConsoleScreenBufferInfo(hConsole, &csbi)) {
+            COORD lineStart = { 0, 0 };  /* Start of the current line */
+            DWORD dw;
+
+            FillConsoleOutputCharacter(hConsole, ' ', csbi.dwSize.X * csbi.dwSize.Y, lineStart, &dw);
+            SetConsoleCursorPosition(hConsole, lineStart);
+        }
+    }
+/* Windows system but using Cygwin or MSYS2 environment, or Unix-like systems */
+#else
+    static const char seq[] = ESC "[0m" ESC "[1J" ESC "[H";
+    __conio_out_put(term, seq, sizeof(seq) - 1);
+    __conio_out_end(term);
+#endif  /* __WIN_PLATFORM_32 && ! __CYGWIN_ENV */
+    __conio_cur_set(term, 1, 1);
+}
+
+/**
+ * @brief Clears without resetting the terminal screen.
+ *
+ * This function provides a platform-dependent way to clear the terminal screen.
+ * On Windows, it uses the system command `"cls"` for Command Prompt or PowerShell.
+ * On Unix-like systems, it uses ANSI escape sequences for clearing the screen
+ * (including the **MSYS2** and **Cygwin** environment).
+ *
+ * On Windows systems, this function uses the Windows API `cls` command. On Unix-like
+ * systems, this function uses the following control sequences.
+ *
+ * | Control sequence | Description                                                            |
+ * | ---------------- | ---------------------------------------------------------------------- |
+ * | `"\033[0m"`      | Resets any text formatting or color attributes.                        |
+ * | `"\033[1J"`      | Clears the screen from the cursor position to the end of the screen.   |
+ * | `"\033[H"`       | Moves the cursor to the top-left corner of the screen (home position). |
+ *
+ * By combining these control sequences in a single write,
+ * the function achieves the effect of clearing the terminal screen.
+ *
+ * @note
+ * - On Unix-like systems, ANSI escape sequences are used. Some terminals may not
+ *   support these sequences, affecting the clearing functionality.
+ * - This function does not prevent the screen from scrolling. If you want to reset
+ *   entire the screen, use the @ref rstscr() instead.
+ *
+ * @attention This function relies on system-specific commands and escape sequences, and
+ *            its behavior may not be consistent across all terminals or environments.
+ *            Usage in environments like **Cygwin** or **MSYS2** on Windows may use control
+ *            sequences instead, but it might not behave as expected.
+ *
+ * @since 0.1.0
+ * @see   rstscr(void)
+ */
+void clrscr(void) {
+    clrscr_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref rstscr(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void rstscr_ctx(conio_term_t* term) {
+/* Windows system but not using the Cygwin neither MSYS2 environment,
+ * which means it uses the Command Prompt or PowerShell
+ */
+#if defined(__WIN_PLATFORM_32) && ! defined(__CYGWIN_ENV)
+    system("cls");
+/* Unix-like systems (including the MSYS2 and Cygwin environment) */
+#else
+    static const char seq[] = ESC "[0m" ESC "c";  /* "\033[0m\033c" */
+    __conio_out_put(term, seq, sizeof(seq) - 1);
+    __conio_out_end(term);
+#endif  /* __WIN_PLATFORM_32 && ! __CYGWIN_ENV */
+    term->cur.top = term->cur.bottom = 0;  /* The reset also removes the scrolling region */
+    __conio_cur_set(term, 1, 1);
+}
+
+/**
+ * @brief Resets and clears the terminal screen.
+ *
+ * This function provides a platform-dependent way to reset and clear the terminal screen.
+ * On Windows, it uses the system command `"cls"` for Command Prompt or PowerShell.
+ * On Unix-like systems, it uses ANSI escape sequences for clearing the screen
+ * (including the **MSYS2** and **Cygwin** environment).
+ *
+ * On Windows systems, there is no difference between this function and @ref clrscr(),
+ * because they both function are used `"cls"` command, which is Windows built-in
+ * command and utilizes the `system` function to execute shell command within C code
+ * from `windows.h` header.
+ *
+ * On Unix-like systems, this function uses the following control sequences.
+ *
+ * | Control sequence | Description                                     |
+ * | ---------------- | ----------------------------------------------- |
+ * | `"\033[0m"`      | Resets any text formatting or color attributes. |
+ * | `"\033c"`        | Resets and clears the entire terminal screen.   |
+ *
+ * By combining these control sequences in a single write,
+ * the function achieves the effect of resetting and clearing the terminal
+ * screen.
+ *
+ * @note
+ * - On Unix-like systems, ANSI escape sequences are used. Some terminals may not
+ *   support these sequences, affecting the clearing functionality. However on Windows,
+ *   this function utilizes the Windows API `cls` command.
+ * - This function prevents the screen from scrolling by clearing the entire screen.
+ *   If you only want to clear the screen without preventing scrolling and resetting,
+ *   consider using the @ref clrscr() function. But in Windows systems, both
+ *   functions will behave the same due to use of `"cls"` command in both functions.
+ *
+ * @attention This function relies on system-specific commands and escape sequences, and
+ *            its behavior may not be consistent across all terminals or environments.
+ *            Usage in environments like **Cygwin** or **MSYS2** on Windows may use control
+ *            sequences instead, but it might not behave as expected.
+ *
+ * @since 0.2.0
+ * @see   clrscr(void)
+ */
+void rstscr(void) {
+    rstscr_ctx(&__conio_def);
+}
+
+
+/**
+ * @brief Same as @ref ungetch(int), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int ungetch_ctx(conio_term_t* term, int const c) {
+    if (c == EOF) return EOF;
+
+    /* Make room at the front of the read-ahead buffer */
+    if (term->in.head == 0) {
+        if (term->in.tail == CONIO_INBUF_SIZE) return EOF;
+        memmove(term->in.buf + 1, term->in.buf, term->in.tail);
+        term->in.head++;
+        term->in.tail++;
+    }
+    term->in.buf[--term->in.head] = (unsigned char)c;
+    return c;
+}
+
+/**
+ * @brief Pushes a character back onto the input stream.
+ *
+ * This function pushes a character back onto the input stream.
+ * It takes an integer parameter `c`, representing the character to be pushed back.
+ * The character is stored in the read-ahead buffer of this library, so it is
+ * returned by the next `getch()` or `getche()` call and reported by `kbhit()`.
+ *
+ * @param[in] c  The character to be pushed back.
+ * @return       Returns the pushed-back character on success, or `EOF` on failure.
+ *
+ * @since 0.1.0
+ * @see   getch(void)
+ * @see   getche(void)
+ */
+int ungetch(int const c) {
+    return ungetch_ctx(&__conio_def, c);
+}
+
+/**
+ * @brief Same as @ref getch(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int getch_ctx(conio_term_t* term) {
+    return __getch(term, GETCH_NO_ECHO);  /* GETCH_NO_ECHO means no echoing input */
+}
+
+/**
+ * @brief Reads a single character from the standard input without buffer.
+ *
+ * This function reads a single character from the standard input without buffer.
+ *
+ * Example
+ * -------
+ * ```c
+ * // You can either use `char` or `int`, it is up to your preference
+ * char c = getch();  // Wait until user input a character
+ * ```
+ *
+ * @return Returns the character read from the standard input.
+ *
+ * @since  0.1.0
+ * @see    getche(void)
+ * @see    ungetch(int)
+ */
+int getch(void) {
+    return getch_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref getche(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int getche_ctx(conio_term_t* term) {
+    return __getch(term, GETCH_USE_ECHO);  /* GETCH_USE_ECHO means with echoing input */
+}
+
+/**
+ * @brief Reads a single character from the standard input with buffer.
+ *
+ * This function reads a single character from the standard input with buffer.
+ *
+ * Example
+ * -------
+ * ```c
+ * // You can either use `char` or `int`, it is up to your preference
+ * char c = getche();  // Wait until user input a character
+ * ```
+ *
+ * @return Returns the character read from the standard input.
+ *
+ * @since  0.1.0
+ * @see    getch(void)
+ * @see    ungetch(int)
+ */
+int getche(void) {
+    return getche_ctx(&__conio_def);
+}
+
+/** Returned by @ref getch_timeout() when no key has been pressed in time. */
+#define CONIO_TIMEOUT  (-2)
+
+/**
+ * @brief Same as @ref getch_timeout(int), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int getch_timeout_ctx(conio_term_t* term, int const ms) {
+    int r;
+    __conio_out_input(term);
+    if ((r = __conio_in_wait(term, ms)) <= 0) return (r == 0) ? CONIO_TIMEOUT : EOF;
+    return __conio_in_pop(term);
+}
+
+/**
+ * @brief Reads a single character, waiting at most the given time for it.
+ *
+ * Like @ref getch(), but returns as soon as a key is pressed or the timeout
+ * expires, so input loops have a bounded latency without polling @ref kbhit().
+ * The wait is a single `poll()` on the terminal.
+ *
+ * Example
+ * -------
+ * ```c
+ * int c;
+ * while ((c = getch_timeout(250)) != 'q') {
+ *     if (c == CONIO_TIMEOUT) blink_cursor();
+ *     else handle_key(c);
+ * }
+ * ```
+ *
+ * @param[in] ms  Maximum time to wait in milliseconds. Zero does not wait, a negative
+ *                value waits indefinitely.
+ * @return        The character read, @ref CONIO_TIMEOUT if the timeout expired, or
+ *                `EOF` at the end of the input.
+ *
+ * @since 0.4.0
+ * @see   getch_n(char*, size_t, int)
+ */
+int getch_timeout(int const ms) {
+    return getch_timeout_ctx(&__conio_def, ms);
+}
+
+/**
+ * @brief Same as @ref getch_n(char*, size_t, int), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int getch_n_ctx(conio_term_t* term, char* buf, size_t const n, int const ms) {
+    size_t got;
+    int r;
+
+    if (!buf || n == 0) return 0;
+    __conio_out_input(term);
+    if ((r = __conio_in_wait(term, ms)) <= 0) return r;
+
+    got = __conio_in_avail(term) < n ? __conio_in_avail(term) : n;
+    memcpy(buf, term->in.buf + term->in.head, got);
+    term->in.head += got;
+    return (int)got;
+}
+
+/**
+ * @brief Reads the characters that are available, waiting at most the given time for the first one.
+ *
+ * Returns as soon as input arrives or the timeout expires, with up to @p n characters:
+ * everything the terminal had when the first one arrived, read with one system call.
+ * This is the batch counterpart of @ref getch_timeout(), suited to pasted text and
+ * auto-repeated keys. No echo is written, and the buffer is not null-terminated.
+ *
+ * Example
+ * -------
+ * ```c
+ * char keys[64];
+ * int n = getch_n(keys, sizeof(keys), 100);
+ * if (n > 0) handle_keys(keys, n);
+ * ```
+ *
+ * @param[out] buf  The buffer receiving the characters.
+ * @param[in]  n    The size of @p buf.
+ * @param[in]  ms   Maximum time to wait in milliseconds. Zero does not wait, a negative
+ *                  value waits indefinitely.
+ * @return          The number of characters read, 0 if the timeout expired, or -1 at
+ *                  the end of the input.
+ *
+ * @since 0.4.0
+ * @see   getch_timeout(int)
+ */
+int getch_n(char* buf, size_t const n, int const ms) {
+    return getch_n_ctx(&__conio_def, buf, n, ms);
+}
+
+#ifndef __HAVE_WINDOWS_API
+/**
+ * @brief Waits up to the given time for input to become available.
+ *
+ * Used by `kbhit()` and `kbhit_timeout()`. The input is not consumed.
+ *
+ * @param[in] __ms  Maximum time to wait in milliseconds, negative to wait indefinitely.
+ * @return          Returns 1 if input is available, 0 otherwise.
+ *
+ * @since 0.4.0
+ */
+static int __conio_kbhit_wait(conio_term_t* __t, int __ms) {
+    struct termios oldt, newt;
+    struct pollfd pfd;
+    unsigned long start = __conio_now_ms();
+    int insess = (__t->sess.depth > 0);
+    int r, wait = __ms;
+
+    __conio_out_input(__t);
+    if (__conio_in_avail(__t) > 0) return 1;  /* Input already read ahead */
+    if (__t->be) return __conio_in_fill_keys(__t, __ms) > 0 && __conio_in_avail(__t) > 0;
+
+    /* Disable canonical mode and echo, unless a session already did it */
+    if (!insess) {
+        if (tcgetattr(__t->in_fd, &oldt) != 0) insess = 1;  /* Not a terminal, just poll */
+        else {
+            newt = oldt;
+            newt.c_lflag &= ~(ICANON | ECHO);
+            tcsetattr(__t->in_fd, TCSANOW, &newt);
+        }
+    }
+
+    pfd.fd = __t->in_fd;
+    pfd.events = POLLIN;
+    for (;;) {
+        pfd.revents = 0;
+        while ((r = poll(&pfd, 1, wait)) < 0 && errno == EINTR) {}
+        if (r <= 0 || (__t->in.pending == 0 && __t->in.late == 0)) break;
+
+        /* Possibly a reply to a cursor position query rather than a key */
+        if (__conio_in_fill(__t, 0) < 0 || __conio_in_avail(__t) > 0) break;
+        if (__ms >= 0) {
+            unsigned long elapsed = __conio_now_ms() - start;
+            r = 0;
+            if (elapsed >= (unsigned long)__ms) break;
+            wait = (int)((unsigned long)__ms - elapsed);
+        }
+    }
+
+    if (!insess) tcsetattr(__t->in_fd, TCSANOW, &oldt);
+    return r > 0;
+}
+#endif  /* ! __HAVE_WINDOWS_API */
+
+/**
+ * @brief Same as @ref kbhit(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int kbhit_ctx(conio_term_t* term) {
+#if defined(__HAVE_WINDOWS_API)
+    if (term->be) return __conio_in_avail(term) > 0 || (__conio_in_fill(term, 0) > 0 && __conio_in_avail(term) > 0);
+
+    /* Windows-specific implementation using Windows API */
+    HANDLE hConsole = GetStdHandle(STD_INPUT_HANDLE);
+    if (hConsole == INVALID_HANDLE_VALUE) return 0;
+
+    DWORD events = 0;
+    INPUT_RECORD inputRecord;
+    if (!GetNumberOfConsoleInputEvents(hConsole, &events) || events == 0) return 0;  /* No input events */
+
+    /* Peek at console input events */
+    PeekConsoleInput(hConsole, &inputRecord, 1, &events);
+
+    /* Check if the event is a key press */
+    if (events > 0 && inputRecord.EventType == KEY_EVENT && inputRecord.Event.KeyEvent.bKeyDown) {
+        /* Consume the event from the buffer */
+        ReadConsoleInput(hConsole, &inputRecord, 1, &events);
+        return 1;
+    }
+
+    /* Clear the input buffer of any other events */
+    FlushConsoleInputBuffer(hConsole);
+#else
+    /* Unix-specific implementation using poll */
+    return __conio_kbhit_wait(term, 0);
+#endif
+
+    return 0;
+}
+
+/**
+ * @brief Checks if a keyboard key has been pressed.
+ *
+ * This function provides cross-platform support for detecting key presses.
+ * On Windows, it can detect all input events, including non-character keys
+ * like *Num Lock* and *Scroll Lock*. On Unix-like systems, it checks for input
+ * availability on the standard input stream (`stdin`), so it won't detect
+ * non-character key events.
+ *
+ * On Windows, the function uses the Windows Console API to check for key events
+ * in the console input buffer. It peeks at the console input events and checks
+ * if there is a key press event. If a key press event is detected, it consumes
+ * the event from the buffer and returns a non-zero value.
+ *
+ * On Unix-like systems, the function first checks the read-ahead buffer of this
+ * library, then asks the terminal with `poll()` whether input is pending, without
+ * reading it. Inside a session (see @ref conio_session_begin()) that is the only
+ * system call; otherwise canonical mode is disabled around the check, so that
+ * keys are reported before Enter is pressed.
+ *
+ * @note
+ * For more advanced key detection (e.g., *Num Lock*, *Scroll Lock*) on Unix-like
+ * systems, consider using libraries like [`libevdev`](https://www.freedesktop.org/wiki/Software/libevdev/)
+ * or accessing `/dev/input` devices directly (requires root permissions).
+ *
+ * @return Non-zero value if a key has been pressed; zero otherwise.
+ *
+ * @since  0.3.0
+ */
+int kbhit(void) {
+    return kbhit_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref kbhit_timeout(int), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int kbhit_timeout_ctx(conio_term_t* term, int const ms) {
+#if defined(__HAVE_WINDOWS_API)
+    if (term->be) return __conio_in_avail(term) > 0 || (__conio_in_fill_keys(term, ms) > 0 && __conio_in_avail(term) > 0);
+
+    HANDLE hConsole = GetStdHandle(STD_INPUT_HANDLE);
+    unsigned long deadline = __conio_now_ms() + (unsigned long)(ms < 0 ? 0 : ms);
+
+    for (;;) {
+        unsigned long now;
+        if (kbhit_ctx(term)) return 1;
+        now = __conio_now_ms();
+        if (ms >= 0 && (long)(deadline - now) <= 0) return 0;
+        WaitForSingleObject(hConsole, ms < 0 ? INFINITE : (DWORD)(deadline - now));
+    }
+#else
+    return __conio_kbhit_wait(term, ms);
+#endif  /* __HAVE_WINDOWS_API */
+}
+
+/**
+ * @brief Waits up to the given time for a key to be pressed.
+ *
+ * Like @ref kbhit(), but blocks until input is available or the timeout expires,
+ * so idle loops can sleep instead of polling.
+ *
+ * Example
+ * -------
+ * ```c
+ * for (;;) {
+ *     if (kbhit_timeout(100)) handle_key(getch());
+ *     update_clock();  // At least every 100 milliseconds
+ * }
+ * ```
+ *
+ * @param[in] ms  Maximum time to wait in milliseconds. Zero does not wait, a negative
+ *                value waits indefinitely.
+ * @return        Non-zero value if a key has been pressed; zero if the timeout expired.
+ *
+ * @since 0.4.0
+ * @see   kbhit(void)
+ */
+int kbhit_timeout(int const ms) {
+    return kbhit_timeout_ctx(&__conio_def, ms);
+}
+
+/**
+ * @brief Same as @ref wherex(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+cpos_t wherex_ctx(conio_term_t* term) {
+    cpos_t __x = 0, __y = 0;
+    __conio_where(term, &__x, &__y);
+
+    return __x;  /* only return the X-coordinate */
+}
+
+/**
+ * @brief Retrieves the current X-coordinate of the cursor on the terminal screen.
+ *
+ * This function retrieves the current X-coordinate of the cursor on the terminal screen.
+ * The returned coordinate value always positive value.
+ *
+ * Example
+ * -------
+ * ```c
+ * cpos_t cur_x = wherex();
+ * ```
+ *
+ * @return Returns the X-coordinate of the cursor.
+ *
+ * @since  0.1.0
+ * @see    wherey(void)
+ * @see    wherexy(cpos_t*, cpos_t*)
+ */
+cpos_t wherex(void) {
+    return wherex_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref wherey(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+cpos_t wherey_ctx(conio_term_t* term) {
+    cpos_t __x = 0, __y = 0;
+    __conio_where(term, &__x, &__y);
+
+    return __y;  /* only return the Y-coordinate */
+}
+
+/**
+ * @brief Retrieves the current Y-coordinate of the cursor on the terminal screen.
+ *
+ * This function retrieves the current Y-coordinate of the cursor on the terminal screen.
+ * The returned coordinate value always positive value.
+ *
+ * Example
+ * -------
+ * ```c
+ * cpos_t cur_y = wherey();
+ * ```
+ *
+ * @return Returns the Y-coordinate of the cursor.
+ *
+ * @since  0.1.0
+ * @see    wherex(void)
+ * @see    wherexy(cpos_t*, cpos_t*)
+ */
+cpos_t wherey(void) {
+    return wherey_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref wherexy(cpos_t*, cpos_t*), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void wherexy_ctx(conio_term_t* term, cpos_t* px, cpos_t* py) {
+    __conio_where(term, px, py);
+}
+
+/**
+ * @brief Retrieves the current X and Y coordinates of the cursor on the terminal screen.
+ *
+ * This function stores the current X-coordinate in the variable pointed
+ * to by `x`, and the Y-coordinate in the variable pointed to by `y`.
+ *
+ * To use this function, provide the addresses of variables for X and Y
+ * to store the coordinates.
+ *
+ * Example
+ * -------
+ * ```c
+ * cpos_t cur_x, cur_y;
+ * wherexy(&cur_x, &cur_y);
+ * ```
+ *
+ * @param[in,out] px  Pointer to the variable where the X-coordinate will be stored.
+ * @param[in,out] py  Pointer to the variable where the Y-coordinate will be stored.
+ *
+ * @note If cursor tracking is enabled (see @ref conio_cursor_track()), the position
+ *       is taken from the cursor model and the terminal is not queried.
+ *
+ * @since 0.2.0.
+ */
+void wherexy(cpos_t* px, cpos_t* py) {
+    wherexy_ctx(&__conio_def, px, py);
+}
+
+/**
+ * @brief Same as @ref putch(int), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int putch_ctx(conio_term_t* term, int const c) {
+    char __c = (char)c;
+    __conio_out_put(term, &__c, 1);
+    __conio_out_end(term);
+    __conio_cur_advance(term, &__c, 1);
+    return (unsigned char)__c;
+}
+
+/**
+ * @brief Writes a character to the standard output.
+ *
+ * This function writes a character to the standard output.
+ * It takes an integer parameter `c`, representing the character to be written.
+ *
+ * @param[in] c  The character to be written.
+ * @return       Returns the written character as an integer.
+ *
+ * @since 0.1.0
+ */
+int putch(int const c) {
+    return putch_ctx(&__conio_def, c);
+}
+
+/**
+ * @brief Same as @ref gotox(cpos_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void gotox_ctx(conio_term_t* term, cpos_t const x) {
+    gotoxy_ctx(term, x, wherey_ctx(term));
+}
+
+/**
+ * @brief Sets the cursor position to the specified X-coordinate,
+ *        maintaining the current Y-coordinate.
+ *
+ * This function serves as an alias for:
+ * ```c
+ * gotoxy(x, wherey());
+ * ```
+ *
+ * It allows for flexible cursor manipulation by allowing the user to set the
+ * X-coordinate while keeping the current Y-coordinate unchanged.
+ *
+ * @param[in] x  The desired X-coordinate to set the cursor to.
+ *
+ * @since 0.2.0
+ * @see   gotoy(cpos_t)
+ * @see   gotoxy(cpos_t, cpos_t)
+ */
+void gotox(cpos_t const x) {
+    gotox_ctx(&__conio_def, x);
+}
+
+/**
+ * @brief Same as @ref gotoy(cpos_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void gotoy_ctx(conio_term_t* term, cpos_t const y) {
+    gotoxy_ctx(term, wherex_ctx(term), y);
+}
+
+/**
+ * @brief Sets the cursor position to the specified Y-coordinate,
+ *        maintaining the current X-coordinate.
+ *
+ * This function serves as an alias for:
+ * ```c
+ * gotoxy(wherex(), y);
  * ```
  *
  * It provides flexibility in cursor positioning by allowing the user to set the
  * Y-coordinate while keeping the current X-coordinate unchanged.
  *
- * @param[in] y  The desired Y-coordinate to set the cursor to.
+ * @param[in] y  The desired Y-coordinate to set the cursor to.
+ *
+ * @since 0.2.0
+ * @see   gotox(cpos_t)
+ * @see   gotoxy(cpos_t, cpos_t)
+ */
+void gotoy(cpos_t const y) {
+    gotoy_ctx(&__conio_def, y);
+}
+
+
+/**
+ * @brief Same as @ref delline(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void delline_ctx(conio_term_t* term) {
+/* Windows-specific implementation */
+#ifdef __HAVE_WINDOWS_API
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    DWORD dw;
+
+    if (GetConsoleScreenBufferInfo(hConsole, &csbi)) {
+        COORD lineStart = { 0, csbi.dwCursorPosition.Y };  /* Start of the current line */
+        FillConsoleOutputCharacter(hConsole, ' ', csbi.dwSize.X, lineStart, &dw);  /* Clear the line */
+        SetConsoleCursorPosition(hConsole, lineStart);  /* Reset cursor to line start */
+    }
+#else
+    /* Unix-like systems using ANSI escape sequences */
+    /* Clear the line and reset cursor to the beginning */
+    __conio_out_put(term, ESC "[2K\r", 5);
+    __conio_out_end(term);
+#endif  /* __HAVE_WINDOWS_API */
+    if (term->cur.valid) __conio_cur_set(term, 1, term->cur.y);
+}
+
+/**
+ * @brief Clears the current line in the terminal.
+ *
+ * This function clears the entire line where the cursor is currently positioned.
+ * It is a cross-platform implementation that uses Windows API on Windows systems and
+ * ANSI escape sequences on Unix-like systems.
+ *
+ * On Unix-like systems, this function uses ANSI escape sequences to manipulate the terminal.
+ * The following sequences are used:
+ *
+ * | Escape Sequence | Description                                 |
+ * |-----------------|---------------------------------------------|
+ * | `\033[2K`       | Clears the entire line                      |
+ *
+ * - `\033` - is the escape character (ASCII code 27, see @ref ESC) used to start an escape sequence.
+ * - `[2K` - is the control sequence for clearing the entire line.
+ * - `\r` - moves the cursor back to the beginning of the line.
+ *
+ * @note  For Windows systems, the function uses [`SetConsoleCursorPosition`](https://learn.microsoft.com/en-us/windows/console/setconsolecursorposition)
+ *        and [`FillConsoleOutputCharacter`](https://learn.microsoft.com/en-us/windows/console/fillconsoleoutputcharacter)
+ *        to achieve the same functionality.
+ *
+ * @pre   Ensure the console supports ANSI escape sequences for Unix-specific implementation.
+ *
+ * @since 0.3.0
+ * @see   dellines(cpos_t, cpos_t)
+ */
+void delline(void) {
+    delline_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref dellines(cpos_t, cpos_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void dellines_ctx(conio_term_t* term, cpos_t from, cpos_t to) {
+    /* Ensure valid range */
+    if ((from < 0) || (to < 0)) {
+        fprintf(stderr,
+            "conio_lt: dellines: Position out of range (from: %d, to: %d)\n", from, to);
+        return;
+    }
+
+    /* Swap `from` and `to` if `from` is greater than `to` with XOR logic */
+    if (from > to) {
+        from ^= to; to ^= from; from ^= to;
+    }
+
+#ifdef __HAVE_WINDOWS_API
+    term->out.hold++;  /* Write all lines at once */
+
+    /* Save the current Y-coordinate of cursor position */
+    cpos_t orig_y = wherey_ctx(term);
+    gotoy_ctx(term, from);  /* Move first the cursor to `from` line */
+
+    cpos_t i;
+    for (i = from; i <= to; i++) {
+        gotoy_ctx(term, i);  /* Move the cursor to `i` line */
+        /* Clear the current line and move the cursor to the start of the line */
+        delline_ctx(term);
+    }
+    /* Reset the Y-coordinate of cursor after clearing lines */
+    gotoy_ctx(term, orig_y);
+
+    term->out.hold--;
+    __conio_out_end(term);
+#else
+    int tracked = term->cur.enabled && term->cur.valid;
+    cpos_t orig_y = term->cur.y, cols, rows = term->cur.rows, y;
+    char* p;
+
+    if (from < 1) from = 1;
+    if (rows <= 0 && conio_getsize_ctx(term, &cols, &rows) != 0) rows = 0;
+    if (rows > 0 && to > rows) to = rows;
+    if (from > to) return;  /* Below the screen */
+
+    /* The cursor is saved by the terminal, unless its position is known */
+    if (!tracked) __conio_out_put(term, ESC "7", 2);
+
+    if (from == to || (rows > 0 && to == rows)) {
+        /* Erase the line, or everything below */
+        __conio_out_cup(term, 1, from);
+        if (to == rows) __conio_out_put(term, ESC "[J", 3);
+        else __conio_out_put(term, ESC "[2K", 4);
+        y = from;
+    } else if (rows > 0) {
+        /* Delete the lines of a scrolling region that covers exactly the range */
+        __conio_out_region(term, from, to);
+        __conio_out_cup(term, 1, from);
+        p = __conio_out_reserve(term, CONIO_ENC_MAX);
+        __conio_out_commit(term, p, __conio_enc_csi1(p, to - from + 1, 1, 'M'));
+        /* Restore the previous region, which homes the cursor */
+        __conio_out_region(term, term->cur.top, term->cur.bottom);
+        y = 1;
+    } else {
+        /* Unknown screen size, erase the lines one by one */
+        for (y = from; y <= to; y++) {
+            __conio_out_cup(term, 1, y);
+            __conio_out_put(term, ESC "[2K", 4);
+        }
+        y = to;
+    }
+
+    if (tracked) __conio_out_move(term, 1, y, 1, orig_y, NULL, CONIO_ATTR_DEFAULT);
+    else __conio_out_put(term, ESC "8\r", 3);
+    __conio_out_end(term);
+    if (tracked) __conio_cur_set(term, 1, orig_y);
+#endif  /* __HAVE_WINDOWS_API */
+}
+
+/**
+ * @brief Clears multiple lines in the terminal.
+ *
+ * This function takes a range of line numbers (@p from and @p to) and clears
+ * all lines in that range. The range is inclusive, meaning that both the
+ * line at @p from and @p to are cleared. If @p from is greater than @p to,
+ * the range is swapped internally to ensure that the correct lines are cleared.
+ *
+ * On Unix-like systems, the lines are cleared with a single buffered write, whatever
+ * the size of the range, and without querying the cursor position: the cursor is
+ * saved and restored by the terminal (`"\0337"`, `"\0338"`), and a range in the middle
+ * of the screen is cleared by deleting the lines of a scrolling region that covers
+ * exactly the range (`DECSTBM` and `DL`). Afterwards, the cursor is at the start of
+ * the line it was on.
+ *
+ * @note
+ * This function will behave the same as @ref clrscr() if @p from set to 0 and @p to
+ * set to the returned value of @ref wherey(). However the cursor position will not be reset
+ * and will remain at the original position, unlike @ref clrscr() where the cursor position
+ * is reset to the top-left corner of the screen.
+ *
+ * @param[in] from  The starting line number to clear.
+ * @param[in] to    The ending line number to clear.
+ *
+ * @pre   Ensure the console supports ANSI escape sequences for Unix-specific implementation.
+ *
+ * @since 0.3.0
+ * @see   delline(void)
+ * @see   gotoy(cpos_t)
+ */
+void dellines(cpos_t from, cpos_t to) {
+    dellines_ctx(&__conio_def, from, to);
+}
+
+
+/**
+ * @brief Same as @ref insline(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void insline_ctx(conio_term_t* term) {
+    __conio_out_put(term, ESC "[L", 3);
+    __conio_out_end(term);
+    if (term->cur.valid) __conio_cur_set(term, 1, term->cur.y);
+}
+
+/**
+ * @brief Inserts a blank line at the cursor position.
+ *
+ * The line with the cursor and the lines below it, down to the bottom of the
+ * scrolling region (see @ref scroll_region()), move one line down; the last line
+ * of the region is lost. The cursor moves to the start of the line. Nothing happens
+ * if the cursor is outside the scrolling region.
+ *
+ * The function writes the insert line sequence (`IL`, `"\033[L"`).
+ *
+ * @pre   Ensure the console supports ANSI escape sequences.
+ *
+ * @since 0.4.0
+ * @see   deletelines(cpos_t)
+ */
+void insline(void) {
+    insline_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref deletelines(cpos_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void deletelines_ctx(conio_term_t* term, cpos_t n) {
+    char* p;
+    if (n <= 0) return;
+    p = __conio_out_reserve(term, CONIO_ENC_MAX);
+    __conio_out_commit(term, p, __conio_enc_csi1(p, n, 1, 'M'));
+    __conio_out_end(term);
+    if (term->cur.valid) __conio_cur_set(term, 1, term->cur.y);
+}
+
+/**
+ * @brief Deletes lines at the cursor position.
+ *
+ * The @p n lines starting at the line with the cursor are removed and the lines
+ * below them, down to the bottom of the scrolling region (see @ref scroll_region()),
+ * move up; blank lines are added at the bottom of the region. The cursor moves to
+ * the start of the line. Nothing happens if the cursor is outside the scrolling region.
+ *
+ * The function writes a single delete line sequence (`DL`, `"\033[{n}M"`),
+ * whatever the number of lines.
+ *
+ * @param[in] n  The number of lines to delete.
+ *
+ * @pre   Ensure the console supports ANSI escape sequences.
+ *
+ * @since 0.4.0
+ * @see   insline()
+ * @see   dellines(cpos_t, cpos_t)
+ */
+void deletelines(cpos_t n) {
+    deletelines_ctx(&__conio_def, n);
+}
+
+/**
+ * @brief Same as @ref scroll_region(cpos_t, cpos_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void scroll_region_ctx(conio_term_t* term, cpos_t top, cpos_t bottom) {
+    if (term->cur.rows > 0 && bottom > term->cur.rows) bottom = term->cur.rows;
+    if (top <= 0 || bottom <= top) top = bottom = 0;  /* Remove the region */
+    __conio_out_region(term, top, bottom);
+    __conio_out_end(term);
+    term->cur.top = top;
+    term->cur.bottom = bottom;
+    __conio_cur_set(term, 1, 1);
+}
+
+/**
+ * @brief Sets the scrolling region of the terminal.
+ *
+ * Line feeds on the last line of the region, @ref insline() and @ref deletelines()
+ * scroll the lines from @p top to @p bottom only; the lines outside the region
+ * stay in place. Calling this function with zero for both arguments (or with
+ * @p bottom not greater than @p top) removes the region, so the whole screen scrolls
+ * again. The cursor moves to the top-left corner of the screen.
+ *
+ * The function writes the set top and bottom margins sequence (`DECSTBM`,
+ * `"\033[{top};{bottom}r"`). @ref rstscr() also removes the region.
+ *
+ * @param[in] top     The first line of the region.
+ * @param[in] bottom  The last line of the region.
+ *
+ * @pre   Ensure the console supports ANSI escape sequences.
+ *
+ * @since 0.4.0
+ */
+void scroll_region(cpos_t top, cpos_t bottom) {
+    scroll_region_ctx(&__conio_def, top, bottom);
+}
+
+
+/**
+ * @brief Same as @ref cputs(char*), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+const char* cputs_ctx(conio_term_t* term, char* const str) {
+    size_t len;
+    if (!str) return NULL;                      /* Handle null input */
+    len = strlen(str);
+    __conio_out_put(term, str, len);                  /* Append the string to the output buffer */
+    __conio_out_end(term);                          /* Flush according to the flush policy */
+    __conio_cur_advance(term, str, len);              /* Keep track of the cursor position */
+    return str;
+}
+
+/**
+ * @brief Outputs a string to the standard output and ensures immediate display.
+ *
+ * This function takes a string as input and writes it to the standard output.
+ * The string is appended to the output buffer of this library, which is flushed
+ * immediately unless another flush policy has been set with @ref conio_setflush().
+ * If the input string is `NULL`, the function returns `NULL`.
+ *
+ * @param[in] str  The string to be written to the standard output.
+ * @return         Returns the input string on success, or NULL on failure.
+ *
+ * @pre     The input string must not be `NULL` before calling this function.
+ *
+ * @since   0.3.0
+ */
+const char* cputs(char* const str) {
+    return cputs_ctx(&__conio_def, str);
+}
+
+/**
+ * @brief Same as @ref cgets(char*), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+char* cgets_ctx(conio_term_t* term, char* buffer) {
+    size_t len = 0, max;
+    if (!buffer) return NULL;  /* Handle null buffer */
+    max = (unsigned char)buffer[0];  /* Maximum length is stored in the first byte */
+    max = (max > 0) ? max - 1 : 0;   /* Leave room for the null terminator */
+
+    __conio_out_input(term);
+    while (len < max) {
+        if (__conio_in_avail(term) == 0 && __conio_in_fill(term, -1) < 0) {
+            if (len == 0) return NULL;  /* End of input */
+            break;
+        }
+        /* The newline is not stored */
+        if (__conio_in_line(term, buffer, &len, max, 0)) break;
+    }
+    buffer[len] = '\0';  /* Null-terminate the string */
+    return buffer;
+}
+
+/**
+ * @brief Reads a string from the standard input into the provided buffer.
+ *
+ * This function reads a line of text from the standard input and stores it in
+ * the provided buffer. The buffer must have its first byte set to the maximum
+ * number of characters (including the null terminator) that can be read.
+ * The function reads at most this number minus one characters, leaving space
+ * for the null terminator. If a newline character is read, it is replaced with
+ * a null terminator.
+ *
+ * @param[in,out] buffer A pointer to the buffer where the input string will
+ *                       be stored. The first byte should be set to the maximum
+ *                       length of the input string (including null terminator).
+ * @return               A pointer to the buffer containing the input string, or `NULL` if the
+ *                       buffer is `NULL` or if an error occurs while reading input.
+ *
+ * @warning     Ensure that the buffer is not `NULL` and that its first byte is
+ *              correctly set before calling this function.
+ *
+ * @since       0.3.0
+ */
+char* cgets(char* buffer) {
+    return cgets_ctx(&__conio_def, buffer);
+}
+
+/** Maximum length of a line read by @ref cscanf(). */
+#define __CONIO_SCANLINE  256
+
+/** Tests for a white-space character, as `isspace()` in the "C" locale. */
+#define __CONIO_SCAN_SPACE(c)  ((c) == ' ' || ((c) >= '\t' && (c) <= '\r'))
+
+/**
+ * @brief Appends the next line of input, with its newline, to the text scanned by @ref cscanf().
+ *
+ * The rest of a line longer than the text is discarded.
+ *
+ * @return 1 if input was appended, or 0 at the end of the input or if the text is full.
+ *
+ * @since 0.4.0
+ */
+static int __conio_scan_more(conio_term_t* __t, char* __text, size_t* __len, size_t __size) {
+    size_t start = *__len;
+
+    if (*__len + 2 >= __size) return 0;
+    for (;;) {
+        if (__conio_in_avail(__t) == 0 && __conio_in_fill(__t, -1) < 0) break;
+        if (__conio_in_line(__t, __text, __len, __size - 2, 1)) {
+            __text[(*__len)++] = '\n';
+            break;
+        }
+    }
+    __text[*__len] = '\0';
+    return *__len > start;
+}
+
+/**
+ * @brief Reads from the terminal and parses the input according to the given format.
+ *
+ * The input is read line by line, and the format is matched one directive at a time
+ * with `sscanf()`, so a directive running out of text reads the next line like
+ * `scanf()` would read on: `"%d %d"` takes its numbers from one line or two.
+ * White space at the end of the format does not wait for more input, and the rest
+ * of the last line read is discarded.
+ *
+ * @since 0.4.0
+ */
+static int __conio_vcscanf(conio_term_t* __t, const char* __fmt, va_list __args) {
+    char text[__CONIO_SCANLINE], spec[__CONIO_SCANLINE];
+    const char* f = __fmt;
+    size_t len = 0, pos = 0, consumed = 0;  /* Bytes scanned before the start of the text */
+    int count = 0, converted = 0;
+
+    __conio_out_input(__t);
+    text[0] = '\0';
+    while (*f != '\0') {
+        const char* d = f;
+        void* p = NULL;
+        int used, r, suppress = 0;
+
+        if (__CONIO_SCAN_SPACE(*f)) {  /* Matches any amount of white space, even none */
+            while (__CONIO_SCAN_SPACE(*f)) f++;
+            for (;;) {
+                while (__CONIO_SCAN_SPACE(text[pos])) pos++;
+                if (text[pos] != '\0' || *f == '\0') break;
+                consumed += pos;
+                len = pos = 0;
+                if (!__conio_scan_more(__t, text, &len, sizeof(text))) return converted ? count : EOF;
+            }
+            continue;
+        }
+
+        if (*f == '%') {
+            f++;
+            if (*f == '*') {
+                suppress = 1;
+                f++;
+            }
+            while (*f >= '0' && *f <= '9') f++;
+            while (*f == 'h' || *f == 'l' || *f == 'L' || *f == 'q' || *f == 'z' || *f == 'j' || *f == 't') f++;
+            if (*f == '[') {  /* The scan set may start with ']' */
+                f++;
+                if (*f == '^') f++;
+                if (*f == ']') f++;
+                while (*f != '\0' && *f != ']') f++;
+            }
+            if (*f == '\0') break;  /* Incomplete conversion specification */
+            if (*f++ == 'n') {  /* Counts every byte scanned, not only those of this line */
+                const char* m = f - 2;
+                size_t at = consumed + pos;
+                if (suppress) continue;
+                if (*m == 'h' && m[-1] == 'h') *va_arg(__args, signed char*) = (signed char)at;
+                else if (*m == 'h') *va_arg(__args, short*) = (short)at;
+                else if (*m == 'l' && m[-1] == 'l') *va_arg(__args, long long*) = (long long)at;
+                else if (*m == 'l') *va_arg(__args, long*) = (long)at;
+                else if (*m == 'z') *va_arg(__args, size_t*) = at;
+                else *va_arg(__args, int*) = (int)at;
+                continue;
+            }
+            /* Every assigning conversion takes a pointer, passed on to sscanf() as is */
+            if (f[-1] != '%' && !suppress) p = va_arg(__args, void*);
+        } else {
+            f++;  /* An ordinary character */
+        }
+
+        if ((size_t)(f - d) + 3 > sizeof(spec)) break;
+        memcpy(spec, d, (size_t)(f - d));
+        memcpy(spec + (f - d), "%n", 3);
+        for (;;) {
+            used = -1;
+            r = p ? sscanf(text + pos, spec, p, &used) : sscanf(text + pos, spec, &used);
+            if (r != EOF) break;
+            /* The text ran out before the directive was matched, read the next line */
+            consumed += pos;
+            len -= pos;
+            memmove(text, text + pos, len + 1);
+            pos = 0;
+            if (!__conio_scan_more(__t, text, &len, sizeof(text))) return converted ? count : EOF;
+        }
+        if (used < 0) break;  /* Matching failure */
+        pos += (size_t)used;
+        if (*d == '%' && f[-1] != '%') converted = 1;
+        if (p) count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Reads input from the standard input according to the given format.
+ *
+ * This function reads formatted input from the standard input and assigns it
+ * to the variables in the argument list. The function returns the number of
+ * input items assigned, which may be less than the number of arguments provided
+ * if the format string is not fully satisfied.
+ *
+ * @param[in] fmt   A pointer to a format string that specifies how the input
+ *                  should be interpreted.
+ * @param[in] ...   A variable number of arguments to which the input values will
+ *                  be assigned.
+ * @return          The number of input items assigned, which may be less than the number
+ *                  of arguments provided if the format string is not fully satisfied.
+ *
+ * @note        Like `scanf()`, the input may span several lines: `"%d %d"` reads
+ *              the second number from the next line if the first line only has one.
+ *              The rest of the last line read is discarded.
+ *
+ * @warning     Ensure that the format string is well-formed and the arguments are
+ *              correct, or the behavior is undefined.
+ *
+ * @since       0.3.0
+ */
+int cscanf(char* const fmt, ...) {
+    va_list args;
+    va_start(args, fmt);  /* Initialize variable argument list */
+    int result = __conio_vcscanf(&__conio_def, fmt, args);
+    va_end(args);  /* Clean up variable argument list */
+    return result;
+}
+
+/**
+ * @brief Same as @ref cscanf(const char*, ...), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int cscanf_ctx(conio_term_t* term, char* const fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int result = __conio_vcscanf(term, fmt, args);
+    va_end(args);
+    return result;
+}
+
+/**
+ * @brief Key codes of the events returned by @ref conio_read_event().
+ *
+ * @since 0.4.0
+ */
+typedef enum {
+    CONIO_KEY_NONE = 0,     /**< No key (unused). */
+    CONIO_KEY_CHAR,         /**< A character, stored in the `codepoint` field of the event. */
+    CONIO_KEY_ENTER,        /**< Enter (carriage return or line feed). */
+    CONIO_KEY_TAB,          /**< Tab (Shift+Tab sets the `CONIO_MOD_SHIFT` modifier). */
+    CONIO_KEY_BACKSPACE,    /**< Backspace. */
+    CONIO_KEY_ESCAPE,       /**< Escape. */
+    CONIO_KEY_UP,           /**< Arrow up. */
+    CONIO_KEY_DOWN,         /**< Arrow down. */
+    CONIO_KEY_RIGHT,        /**< Arrow right. */
+    CONIO_KEY_LEFT,         /**< Arrow left. */
+    CONIO_KEY_HOME,         /**< Home. */
+    CONIO_KEY_END,          /**< End. */
+    CONIO_KEY_INSERT,       /**< Insert. */
+    CONIO_KEY_DELETE,       /**< Delete. */
+    CONIO_KEY_PAGEUP,       /**< Page up. */
+    CONIO_KEY_PAGEDOWN,     /**< Page down. */
+    CONIO_KEY_F1,           /**< Function key F1, F2 - F12 follow in order. */
+    CONIO_KEY_F2, CONIO_KEY_F3, CONIO_KEY_F4,  CONIO_KEY_F5,  CONIO_KEY_F6,
+    CONIO_KEY_F7, CONIO_KEY_F8, CONIO_KEY_F9,  CONIO_KEY_F10, CONIO_KEY_F11,
+    CONIO_KEY_F12,
+    CONIO_KEY_UNKNOWN       /**< An escape sequence that is not recognised. */
+} conio_key_t;
+
+/**
+ * @name Key modifiers
+ *
+ * Modifier flags of @ref conio_event_t, using the same bits as the modifier
+ * parameter of xterm key sequences (minus one).
+ *
+ * @since 0.4.0
+ * @{
+ */
+#define CONIO_MOD_SHIFT  0x01  /**< Shift key. */
+#define CONIO_MOD_ALT    0x02  /**< Alt key (or a key prefixed with Escape). */
+#define CONIO_MOD_CTRL   0x04  /**< Control key. */
+#define CONIO_MOD_META   0x08  /**< Meta key. */
+/** @} */
+
+/**
+ * @brief Represents a decoded key press.
+ *
+ * @since 0.4.0
+ * @see   conio_read_event(conio_event_t*)
+ */
+typedef struct {
+    conio_key_t key;        /**< The key code. */
+    int         mods;       /**< Combination of `CONIO_MOD_*` flags. */
+    uint32_t    codepoint;  /**< The Unicode character for `CONIO_KEY_CHAR`, zero otherwise. */
+} conio_event_t;
+
+/** Maps the final byte of a `CSI` or `SS3` sequence to a key. */
+static const struct { unsigned char final; conio_key_t key; } __conio_csi_keys[] = {
+    { 'A', CONIO_KEY_UP },   { 'B', CONIO_KEY_DOWN }, { 'C', CONIO_KEY_RIGHT },
+    { 'D', CONIO_KEY_LEFT }, { 'H', CONIO_KEY_HOME }, { 'F', CONIO_KEY_END },
+    { 'E', CONIO_KEY_NONE }, /* Keypad 5, ignored */
+    { 'P', CONIO_KEY_F1 },   { 'Q', CONIO_KEY_F2 },   { 'R', CONIO_KEY_F3 },
+    { 'S', CONIO_KEY_F4 },   { 'Z', CONIO_KEY_TAB },  { 'M', CONIO_KEY_ENTER }
+};
+
+/** Maps the number of a `"\033[{n}~"` sequence (VT220, xterm, rxvt, linux console) to a key. */
+static const conio_key_t __conio_tilde_keys[] = {
+    /*  0 */ CONIO_KEY_UNKNOWN, CONIO_KEY_HOME, CONIO_KEY_INSERT, CONIO_KEY_DELETE,
+    /*  4 */ CONIO_KEY_END, CONIO_KEY_PAGEUP, CONIO_KEY_PAGEDOWN, CONIO_KEY_HOME,
+    /*  8 */ CONIO_KEY_END, CONIO_KEY_UNKNOWN, CONIO_KEY_UNKNOWN, CONIO_KEY_F1,
+    /* 12 */ CONIO_KEY_F2, CONIO_KEY_F3, CONIO_KEY_F4, CONIO_KEY_F5,
+    /* 16 */ CONIO_KEY_UNKNOWN, CONIO_KEY_F6, CONIO_KEY_F7, CONIO_KEY_F8,
+    /* 20 */ CONIO_KEY_F9, CONIO_KEY_F10, CONIO_KEY_UNKNOWN, CONIO_KEY_F11,
+    /* 24 */ CONIO_KEY_F12
+};
+
+/**
+ * @brief Decodes a `CSI` (`"\033["`) or `SS3` (`"\033O"`) sequence.
+ *
+ * @param[in]  __s    The bytes following the introducer.
+ * @param[in]  __n    The number of bytes.
+ * @param[in]  __ss3  Non-zero for an `SS3` sequence.
+ * @param[out] __ev   Receives the decoded event.
+ * @return            The number of bytes consumed, or 0 if the sequence is incomplete.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_decode_csi(const unsigned char* __s, size_t __n, int __ss3,
+                                 conio_event_t* __ev) {
+    unsigned int params[4] = { 0, 0, 0, 0 };
+    size_t i = 0, np = 0, k;
+    unsigned char final;
+
+    /* Linux console function keys: "\033[[A" - "\033[[E" */
+    if (!__ss3 && __n >= 1 && __s[0] == '[') {
+        if (__n < 2) return 0;
+        __ev->key = (__s[1] >= 'A' && __s[1] <= 'E')
+                  ? (conio_key_t)(CONIO_KEY_F1 + (__s[1] - 'A')) : CONIO_KEY_UNKNOWN;
+        return 2;
+    }
+
+    /* Parameter bytes, intermediate bytes and the final byte */
+    for (; i < __n; i++) {
+        unsigned char c = __s[i];
+        if (c >= '0' && c <= '9') {
+            if (np == 0) np = 1;
+            if (np <= 4) params[np - 1] = params[np - 1] * 10 + (c - '0');
+        } else if (c == ';') {
+            np = (np == 0) ? 2 : np + 1;
+        } else if (c >= 0x20 && c <= 0x3F) {
+            /* Other parameter and intermediate bytes are skipped */
+        } else {
+            break;
+        }
+    }
+    if (i == __n) return 0;  /* No final byte yet */
+    final = __s[i++];
+
+    if (final == '~') {
+        __ev->key = (params[0] < sizeof(__conio_tilde_keys) / sizeof(__conio_tilde_keys[0]))
+                  ? __conio_tilde_keys[params[0]] : CONIO_KEY_UNKNOWN;
+    } else {
+        /* rxvt sends Ctrl+arrows as "\033Oa" - "\033Od" */
+        if (__ss3 && final >= 'a' && final <= 'd') {
+            final = (unsigned char)(final - 'a' + 'A');
+            __ev->mods |= CONIO_MOD_CTRL;
+        }
+        __ev->key = CONIO_KEY_UNKNOWN;
+        for (k = 0; k < sizeof(__conio_csi_keys) / sizeof(__conio_csi_keys[0]); k++) {
+            if (__conio_csi_keys[k].final == final) {
+                __ev->key = __conio_csi_keys[k].key;
+                break;
+            }
+        }
+        if (final == 'Z') __ev->mods |= CONIO_MOD_SHIFT;  /* Back tab */
+        /* Some terminals send SS3 with the modifier as the only parameter */
+        if (__ss3 && np == 1) params[1] = params[0];
+    }
+
+    /* The modifier parameter is 1 + combination of the modifier bits */
+    if (params[1] > 1) __ev->mods |= (int)(params[1] - 1) & 0x0F;
+    return i;
+}
+
+/**
+ * @brief Decodes the next key press from a sequence of input bytes.
+ *
+ * @param[in]  __s      The input bytes.
+ * @param[in]  __n      The number of bytes, must not be zero.
+ * @param[in]  __final  Non-zero if no more bytes will follow, so an incomplete
+ *                      sequence has to be decoded as it is.
+ * @param[out] __ev     Receives the decoded event.
+ * @return              The number of bytes consumed, or 0 if more bytes are needed.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_decode(const unsigned char* __s, size_t __n, int __final,
+                             conio_event_t* __ev) {
+    unsigned char c = __s[0];
+    size_t len, i;
+
+    __ev->key = CONIO_KEY_CHAR;
+    __ev->mods = 0;
+    __ev->codepoint = 0;
+
+    if (c == 0x1B) {
+        if (__n == 1) {
+            if (!__final) return 0;
+            __ev->key = CONIO_KEY_ESCAPE;
+            return 1;
+        }
+        if (__s[1] == '[' || __s[1] == 'O') {
+            len = __conio_decode_csi(__s + 2, __n - 2, __s[1] == 'O', __ev);
+            if (len > 0) return len + 2;
+            if (!__final) return 0;
+        }
+        if (__s[1] == 0x1B) {  /* Escape pressed twice */
+            __ev->key = CONIO_KEY_ESCAPE;
+            return 1;
+        }
+        /* Escape followed by a key means the key was pressed with Alt */
+        len = __conio_decode(__s + 1, __n - 1, __final, __ev);
+        if (len == 0) return 0;
+        __ev->mods |= CONIO_MOD_ALT;
+        return len + 1;
+    }
+
+    switch (c) {
+    case '\r': case '\n': __ev->key = CONIO_KEY_ENTER;     return 1;
+    case '\t':            __ev->key = CONIO_KEY_TAB;       return 1;
+    case 0x08: case 0x7F: __ev->key = CONIO_KEY_BACKSPACE; return 1;
+    default: break;
+    }
+
+    if (c < 0x20) {  /* Ctrl+key */
+        if (c == 0)         __ev->codepoint = ' ';                     /* Ctrl+Space */
+        else if (c <= 0x1A) __ev->codepoint = (uint32_t)(c + 'a' - 1);  /* Ctrl+A - Ctrl+Z */
+        else                __ev->codepoint = (uint32_t)(c + 0x40);     /* Ctrl+\ - Ctrl+_ */
+        __ev->mods = CONIO_MOD_CTRL;
+        return 1;
+    }
+
+    /* UTF-8 encoded character */
+    if (c < 0x80)                { __ev->codepoint = c;        return 1; }
+    else if ((c & 0xE0) == 0xC0) { __ev->codepoint = c & 0x1F; len = 2; }
+    else if ((c & 0xF0) == 0xE0) { __ev->codepoint = c & 0x0F; len = 3; }
+    else if ((c & 0xF8) == 0xF0) { __ev->codepoint = c & 0x07; len = 4; }
+    else                         { __ev->codepoint = 0xFFFD;   return 1; }
+
+    for (i = 1; i < len; i++) {
+        if (i == __n) {
+            if (!__final) return 0;
+            __ev->codepoint = 0xFFFD;
+            return i;
+        }
+        if ((__s[i] & 0xC0) != 0x80) {
+            __ev->codepoint = 0xFFFD;
+            return i;
+        }
+        __ev->codepoint = (__ev->codepoint << 6) | (__s[i] & 0x3F);
+    }
+    return len;
+}
+
+/**
+ * @brief Decodes the next event from the read-ahead buffer, reading more input if needed.
+ *
+ * @param[out] __ev     Receives the decoded event.
+ * @param[in]  __block  Non-zero to wait for input if the buffer is empty.
+ * @return              Returns 1 if an event has been decoded, 0 if no input is
+ *                      available (only if @p __block is zero), or -1 on end of file.
+ *
+ * @since 0.4.0
+ */
+static int __conio_next_event(conio_term_t* __t, conio_event_t* __ev, int __block) {
+    for (;;) {
+        size_t used;
+        int r;
+
+        if (__conio_in_avail(__t) > 0) {
+            used = __conio_decode(__t->in.buf + __t->in.head, __conio_in_avail(__t), 0, __ev);
+            if (used > 0) {
+                __t->in.head += used;
+                return 1;
+            }
+            /* Incomplete sequence, wait briefly for the rest of it */
+            r = __conio_in_fill(__t, CONIO_ESC_DELAY);
+            if (r <= 0) {
+                used = __conio_decode(__t->in.buf + __t->in.head, __conio_in_avail(__t), 1, __ev);
+                __t->in.head += used;
+                return 1;
+            }
+            continue;
+        }
+
+        if (!__block) return 0;
+        if (__conio_in_fill(__t, -1) < 0) return -1;
+    }
+}
+
+/**
+ * @brief Same as @ref conio_read_event(conio_event_t*), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_read_event_ctx(conio_term_t* term, conio_event_t* ev) {
+    int began, r;
+    if (!ev) return -1;
+
+    __conio_out_input(term);
+    began = (term->sess.depth == 0 && conio_session_begin_ctx(term) == 0);
+    r = __conio_next_event(term, ev, 1);
+    if (began) conio_session_end_ctx(term);
+    return (r == 1) ? 0 : -1;
+}
+
+/**
+ * @brief Reads the next key press and decodes escape sequences into key codes.
+ *
+ * Unlike `getch()`, which returns the raw bytes of an escape sequence one by one,
+ * this function returns arrow keys, function keys, navigation keys and keys pressed
+ * with modifiers (Shift, Alt, Ctrl) as a single event. Sequences sent by xterm and
+ * compatible terminals, VT220, rxvt and the Linux console are recognised, including
+ * xterm modifier parameters (e.g. `"\033[1;5A"` for Ctrl+Up). UTF-8 encoded
+ * characters are decoded into their code points.
+ *
+ * Input is read into an internal buffer with a single `read(2)` of all available
+ * bytes, so a burst of input (pasted text, auto-repeated keys) is decoded from
+ * memory by the following calls.
+ *
+ * Example
+ * -------
+ * ```c
+ * conio_event_t ev;
+ * while (conio_read_event(&ev) == 0) {
+ *     if (ev.key == CONIO_KEY_UP && (ev.mods & CONIO_MOD_CTRL)) scroll_up();
+ *     else if (ev.key == CONIO_KEY_CHAR) insert(ev.codepoint);
+ * }
+ * ```
+ *
+ * @param[out] ev  Pointer to the event that receives the key press.
+ * @return         Returns 0 on success, or -1 on end of file or error.
+ *
+ * @note A lone Escape byte is reported as @ref CONIO_KEY_ESCAPE once no further bytes
+ *       arrive within @ref CONIO_ESC_DELAY milliseconds.
+ *
+ * @since 0.4.0
+ * @see   conio_read_events(conio_event_t*, int)
+ */
+int conio_read_event(conio_event_t* ev) {
+    return conio_read_event_ctx(&__conio_def, ev);
+}
+
+/**
+ * @brief Same as @ref conio_read_events(conio_event_t*, int), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_read_events_ctx(conio_term_t* term, conio_event_t* events, int const max) {
+    int count = 0;
+    if (!events || max <= 0 || conio_read_event_ctx(term, &events[0]) != 0) return -1;
+
+    for (count = 1; count < max; count++) {
+        if (__conio_next_event(term, &events[count], 0) != 1) break;
+    }
+    return count;
+}
+
+/**
+ * @brief Reads and decodes all key presses that are available at once.
+ *
+ * Waits for input like @ref conio_read_event(), then decodes every complete event
+ * that arrived with it, without further waiting.
+ *
+ * @param[out] events  Array that receives the events.
+ * @param[in]  max     The number of elements of @p events.
+ * @return             The number of events stored, or -1 on end of file or error.
+ *
+ * @since 0.4.0
+ * @see   conio_read_event(conio_event_t*)
+ */
+int conio_read_events(conio_event_t* events, int const max) {
+    return conio_read_events_ctx(&__conio_def, events, max);
+}
+
+/**
+ * @brief State of a line being edited by @ref conio_readline().
+ *
+ * Positions on the screen are columns relative to the start of the line; every
+ * character is assumed to take one column.
+ *
+ * @since 0.4.0
+ */
+struct __conio_edit {
+    conio_term_t* t;
+    char*         s;      /**< The text, in the buffer of the caller. */
+    size_t        len;    /**< Length of the text in bytes. */
+    size_t        pos;    /**< Byte offset of the cursor in the text. */
+    size_t        max;    /**< Maximum length of the text in bytes. */
+    size_t        shown;  /**< Number of columns displayed on the screen. */
+    size_t        at;     /**< Column of the terminal cursor. */
+    size_t        x0;     /**< Zero-based screen column of the start of the line. */
+    size_t        w;      /**< Width of the terminal, zero if unknown (the line never wraps). */
+    int           asked;  /**< Non-zero while the reply giving @ref x0 is awaited. */
+    int           hist;   /**< Index of the history line being edited, the count of lines for a new one. */
+};
+
+/**
+ * @brief Returns the number of columns taken by the first bytes of the text.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_edit_cols(const struct __conio_edit* __e, size_t __n) {
+    size_t i, cols = 0;
+    for (i = 0; i < __n; i++) cols += ((__e->s[i] & 0xC0) != 0x80);  /* Not a UTF-8 continuation byte */
+    return cols;
+}
+
+/**
+ * @brief Returns the byte offset of a column in the text.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_edit_off(const struct __conio_edit* __e, size_t __col) {
+    size_t i = 0;
+    for (; __col > 0 && i < __e->len; __col--) {
+        for (i++; i < __e->len && (__e->s[i] & 0xC0) == 0x80; i++) {}
+    }
+    return i;
+}
+
+/**
+ * @brief Appends bytes to the output buffer, keeping the shadow cursor up to date.
+ *
+ * @since 0.4.0
+ */
+static void __conio_edit_put(struct __conio_edit* __e, const char* __s, size_t __n) {
+    __conio_out_put(__e->t, __s, __n);
+    __conio_cur_advance(__e->t, __s, __n);
+}
+
+/**
+ * @brief Appends a control sequence with one numeric parameter, see @ref __conio_enc_csi1.
+ *
+ * @since 0.4.0
+ */
+static void __conio_edit_csi(struct __conio_edit* __e, size_t __n, char __final) {
+    char seq[CONIO_ENC_MAX];
+    __conio_edit_put(__e, seq, __conio_enc_csi1(seq, (int)__n, 1, __final));
+}
+
+/**
+ * @brief Takes the reply giving the column where the line starts, once it is needed.
+ *
+ * @since 0.4.0
+ */
+static void __conio_edit_origin(struct __conio_edit* __e) {
+    cpos_t x = 0;
+    if (!__e->asked) return;
+    __e->asked = 0;
+    /* Usually received already, it precedes the keys typed after the query */
+    if (__conio_cpr_newest(__e->t, &x, NULL, CONIO_QUERY_TIMEOUT) && x >= 1)
+        __e->x0 = (size_t)(x - 1) % __e->w;
+    else
+        __e->w = 0;  /* Unknown, the rows cannot be followed */
+}
+
+/**
+ * @brief Moves the terminal cursor to a column of the line with the shortest sequence.
+ *
+ * Short moves to the right rewrite the characters in between, which takes fewer
+ * bytes than a control sequence.
+ *
+ * @since 0.4.0
+ */
+static void __conio_edit_move(struct __conio_edit* __e, size_t __col) {
+    size_t a = __e->x0 + __e->at, b = __e->x0 + __col;
+    size_t ra = 0, rb = 0, ca = a, cb = b;
+
+    if (__col == __e->at) return;
+    if (__e->w > 0) {
+        ra = a / __e->w;
+        rb = b / __e->w;
+        ca = a % __e->w;
+        cb = b % __e->w;
+    }
+    if (rb < ra) __conio_edit_csi(__e, ra - rb, 'A');
+    else if (rb > ra) __conio_edit_csi(__e, rb - ra, 'B');
+
+    if (cb == 0 && ca != 0 && __e->w > 0) {  /* Only the absolute column of the start is known */
+        __conio_edit_put(__e, "\r", 1);
+    } else if (cb + 1 == ca) {
+        __conio_edit_put(__e, "\b", 1);
+    } else if (cb < ca) {
+        __conio_edit_csi(__e, ca - cb, 'D');
+    } else if (cb > ca) {
+        size_t from = __conio_edit_off(__e, __e->at), to = __conio_edit_off(__e, __col);
+        if (ra == rb && to - from <= 4) __conio_edit_put(__e, __e->s + from, to - from);
+        else __conio_edit_csi(__e, cb - ca, 'C');
+    }
+    __e->at = __col;
+}
+
+/**
+ * @brief Redraws the line from the given byte offset, the text before it is unchanged.
+ *
+ * Writes the changed tail of the line, erases what is left of the previous text
+ * and puts the cursor back at its position.
+ *
+ * @param[in] __from  Byte offset of the first changed byte.
+ *
+ * @since 0.4.0
+ */
+static void __conio_edit_show(struct __conio_edit* __e, size_t __from) {
+    size_t end = __conio_edit_cols(__e, __e->len), old = __e->shown;
+
+    __conio_edit_origin(__e);
+    if (__from < __e->len) {
+        __conio_edit_move(__e, __conio_edit_cols(__e, __from));
+        __conio_edit_put(__e, __e->s + __from, __e->len - __from);
+        __e->at = end;
+        /* Leave the last column, where the terminal defers the wrap to the next character */
+        if (__e->w > 0 && (__e->x0 + end) % __e->w == 0) __conio_edit_put(__e, "\r\n", 2);
+    }
+    if (old > end) {
+        __conio_edit_move(__e, end);
+        if (__e->w == 0 || (__e->x0 + old - 1) / __e->w == (__e->x0 + end) / __e->w)
+            __conio_edit_put(__e, "\033[K", 3);  /* The rest is on the same row */
+        else
+            __conio_edit_put(__e, "\033[J", 3);
+    }
+    __e->shown = end;
+    __conio_edit_move(__e, __conio_edit_cols(__e, __e->pos));
+}
+
+/**
+ * @brief Replaces the bytes between two offsets with the given text, as far as it fits.
+ *
+ * @since 0.4.0
+ */
+static void __conio_edit_splice(struct __conio_edit* __e, size_t __from, size_t __to,
+                                const char* __s, size_t __n) {
+    size_t room = __e->max - (__e->len - (__to - __from));
+    if (__n > room) {
+        __n = room;
+        while (__n > 0 && (__s[__n] & 0xC0) == 0x80) __n--;  /* Never split a character */
+    }
+    memmove(__e->s + __from + __n, __e->s + __to, __e->len - __to);
+    memcpy(__e->s + __from, __s, __n);
+    __e->len = __e->len - (__to - __from) + __n;
+    __e->pos = __from + __n;
+    __conio_edit_show(__e, __from);
+}
+
+/**
+ * @brief Returns the slot of a history line, or of the kill buffer or the saved line.
+ *
+ * @since 0.4.0
+ */
+static unsigned char* __conio_hist_slot(conio_term_t* __t, int __i) {
+    if (__i < CONIO_HISTORY_SIZE) __i = (__t->hist.first + __i) % CONIO_HISTORY_SIZE;
+    return __t->hist.slots + (size_t)__i * 256;
+}
+
+/**
+ * @brief Copies text into a slot of the history.
+ *
+ * @since 0.4.0
+ */
+static void __conio_hist_store(unsigned char* __slot, const char* __s, size_t __n) {
+    __slot[0] = (unsigned char)(__n > 255 ? 255 : __n);
+    memcpy(__slot + 1, __s, __slot[0]);
+}
+
+/**
+ * @brief Removes the text between two offsets into the kill buffer.
+ *
+ * @since 0.4.0
+ */
+static void __conio_edit_kill(struct __conio_edit* __e, size_t __from, size_t __to) {
+    if (__from == __to) return;
+    if (__e->t->hist.slots) __conio_hist_store(__conio_hist_slot(__e->t, __CONIO_HIST_KILL), __e->s + __from, __to - __from);
+    __conio_edit_splice(__e, __from, __to, "", 0);
+}
+
+/**
+ * @brief Returns the byte offset of the start of the previous or the end of the next word.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_edit_word(const struct __conio_edit* __e, int __dir) {
+    size_t i = __e->pos;
+#define __CONIO_WORDCH(c)  (((c) >= '0' && (c) <= '9') || (((c) | 0x20) >= 'a' && ((c) | 0x20) <= 'z') \
+                            || ((unsigned char)(c) & 0x80))
+    if (__dir < 0) {
+        while (i > 0 && !__CONIO_WORDCH(__e->s[i - 1])) i--;
+        while (i > 0 && __CONIO_WORDCH(__e->s[i - 1])) i--;
+    } else {
+        while (i < __e->len && !__CONIO_WORDCH(__e->s[i])) i++;
+        while (i < __e->len && __CONIO_WORDCH(__e->s[i])) i++;
+    }
+#undef __CONIO_WORDCH
+    return i;
+}
+
+/**
+ * @brief Replaces the text with a history line, or the saved line past the newest one.
+ *
+ * @since 0.4.0
+ */
+static void __conio_edit_recall(struct __conio_edit* __e, int __i) {
+    conio_term_t* t = __e->t;
+    unsigned char* slot;
+
+    if (!t->hist.slots || __i < 0 || __i > t->hist.count || __i == __e->hist) return;
+    if (__e->hist == t->hist.count)  /* Keep the new line to come back to it */
+        __conio_hist_store(__conio_hist_slot(t, __CONIO_HIST_SAVED), __e->s, __e->len);
+    __e->hist = __i;
+    slot = __conio_hist_slot(t, __i == t->hist.count ? __CONIO_HIST_SAVED : __i);
+    __conio_edit_splice(__e, 0, __e->len, (const char*)slot + 1, slot[0]);
+}
+
+/**
+ * @brief Adds a line to the history, forgetting the oldest one if it is full.
+ *
+ * @since 0.4.0
+ */
+static void __conio_hist_add(conio_term_t* __t, const char* __s, size_t __n) {
+    unsigned char* last;
+    if (__n == 0 || !__t->hist.slots) return;
+    if (__t->hist.count > 0) {  /* Not twice in a row */
+        last = __conio_hist_slot(__t, __t->hist.count - 1);
+        if (last[0] == __n && memcmp(last + 1, __s, __n) == 0) return;
+    }
+    if (__t->hist.count == CONIO_HISTORY_SIZE) {
+        __t->hist.first = (__t->hist.first + 1) % CONIO_HISTORY_SIZE;
+        __t->hist.count--;
+    }
+    __conio_hist_store(__conio_hist_slot(__t, __t->hist.count++), __s, __n);
+}
+
+/**
+ * @brief Same as @ref conio_readline(char*), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+char* conio_readline_ctx(conio_term_t* term, char* buffer) {
+    struct __conio_edit e;
+    conio_event_t ev;
+    cpos_t cols = 0;
+    int began, r, done = 0;
+
+    if (!buffer) return NULL;
+    memset(&e, 0, sizeof(e));
+    e.t = term;
+    e.s = buffer + 2;
+    e.max = (unsigned char)buffer[0];
+    e.max = (e.max > 0) ? e.max - 1 : 0;  /* Leave room for the null terminator */
+    e.len = (unsigned char)buffer[1];
+    if (e.len > e.max) {
+        e.len = e.max;
+        while (e.len > 0 && (e.s[e.len] & 0xC0) == 0x80) e.len--;  /* Never split a character */
+    }
+    e.pos = e.len;
+
+#ifdef __HAVE_WINDOWS_API
+    if (!term->be) {
+#else
+    if (!term->be && !isatty(term->in_fd)) {
+#endif  /* __HAVE_WINDOWS_API */
+        /* Nothing to edit, read the rest of the line like cgets() */
+        __conio_out_input(term);
+        while (e.len < e.max) {
+            if (__conio_in_avail(term) == 0 && __conio_in_fill(term, -1) < 0) {
+                if (e.len == 0) return NULL;  /* End of input */
+                break;
+            }
+            if (__conio_in_line(term, e.s, &e.len, e.max, 0)) break;
+        }
+        e.s[e.len] = '\0';
+        buffer[1] = (char)e.len;
+        return e.s;
+    }
+
+    if (!term->hist.slots)
+        term->hist.slots = (unsigned char*)calloc(CONIO_HISTORY_SIZE + 2, 256);
+    e.hist = term->hist.count;
+
+    /* The start column is needed to follow the line across rows */
+    began = (term->sess.depth == 0 && conio_session_begin_ctx(term) == 0);
+    if (conio_getsize_ctx(term, &cols, NULL) == 0) e.w = (size_t)cols;
+    if (e.w > 0) {
+        if (term->cur.enabled && term->cur.valid) e.x0 = (size_t)(term->cur.x - 1) % e.w;
+        else e.asked = (conio_cursor_query_ctx(term) == 0);
+    }
+
+    term->out.hold++;
+    if (e.len > 0) __conio_edit_show(&e, 0);  /* The initial text */
+    term->out.hold--;
+    __conio_out_end(term);
+
+    while (!done) {
+        __conio_out_flush(term);
+        r = __conio_next_event(term, &ev, 1);
+        if (r < 0) {  /* End of input */
+            if (e.len == 0 && e.hist == term->hist.count) {
+                if (e.asked) __conio_cpr_newest(term, NULL, NULL, 0);
+                if (began) conio_session_end_ctx(term);
+                return NULL;
+            }
+            ev.key = CONIO_KEY_ENTER;
+        }
+
+        term->out.hold++;
+        if (ev.key == CONIO_KEY_CHAR && (ev.mods & CONIO_MOD_CTRL)) {
+            ev.mods = 0;
+            switch (ev.codepoint) {
+            case 'a': e.pos = 0; __conio_edit_show(&e, e.len); break;
+            case 'e': e.pos = e.len; __conio_edit_show(&e, e.len); break;
+            case 'b': ev.key = CONIO_KEY_LEFT; break;
+            case 'f': ev.key = CONIO_KEY_RIGHT; break;
+            case 'p': ev.key = CONIO_KEY_UP; break;
+            case 'n': ev.key = CONIO_KEY_DOWN; break;
+            case 'd': ev.key = CONIO_KEY_DELETE; break;
+            case 'k': __conio_edit_kill(&e, e.pos, e.len); break;
+            case 'u': __conio_edit_kill(&e, 0, e.pos); break;
+            case 'w': __conio_edit_kill(&e, __conio_edit_word(&e, -1), e.pos); break;
+            case 'y':
+                if (term->hist.slots) {
+                    const unsigned char* kill = __conio_hist_slot(term, __CONIO_HIST_KILL);
+                    __conio_edit_splice(&e, e.pos, e.pos, (const char*)kill + 1, kill[0]);
+                }
+                break;
+            default: break;
+            }
+            if (ev.key == CONIO_KEY_CHAR) ev.key = CONIO_KEY_NONE;  /* Handled */
+        } else if (ev.key == CONIO_KEY_CHAR && (ev.mods & CONIO_MOD_ALT)) {
+            ev.mods = CONIO_MOD_CTRL;  /* Word movements */
+            if (ev.codepoint == 'b') ev.key = CONIO_KEY_LEFT;
+            else if (ev.codepoint == 'f') ev.key = CONIO_KEY_RIGHT;
+            else if (ev.codepoint == 'd') __conio_edit_kill(&e, e.pos, __conio_edit_word(&e, 1));
+            if (ev.key == CONIO_KEY_CHAR) ev.key = CONIO_KEY_NONE;
+        }
+
+        switch (ev.key) {
+        case CONIO_KEY_CHAR: {
+            char enc[4];
+            uint32_t c = ev.codepoint;
+            size_t n;
+            if (c < 0x80)        { enc[0] = (char)c; n = 1; }
+            else if (c < 0x800)  { enc[0] = (char)(0xC0 | (c >> 6)); enc[1] = (char)(0x80 | (c & 0x3F)); n = 2; }
+            else if (c < 0x10000) {
+                enc[0] = (char)(0xE0 | (c >> 12)); enc[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+                enc[2] = (char)(0x80 | (c & 0x3F)); n = 3;
+            } else {
+                enc[0] = (char)(0xF0 | (c >> 18)); enc[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+                enc[2] = (char)(0x80 | ((c >> 6) & 0x3F)); enc[3] = (char)(0x80 | (c & 0x3F)); n = 4;
+            }
+            if (e.len + n <= e.max) __conio_edit_splice(&e, e.pos, e.pos, enc, n);
+            break;
+        }
+        case CONIO_KEY_BACKSPACE:
+            if (ev.mods & CONIO_MOD_ALT) {
+                __conio_edit_kill(&e, __conio_edit_word(&e, -1), e.pos);
+            } else if (e.pos > 0) {
+                size_t from = __conio_edit_off(&e, __conio_edit_cols(&e, e.pos) - 1);
+                __conio_edit_splice(&e, from, e.pos, "", 0);
+            }
+            break;
+        case CONIO_KEY_DELETE:
+            if (e.pos < e.len)
+                __conio_edit_splice(&e, e.pos, __conio_edit_off(&e, __conio_edit_cols(&e, e.pos) + 1), "", 0);
+            break;
+        case CONIO_KEY_LEFT:
+            if (ev.mods & CONIO_MOD_CTRL) e.pos = __conio_edit_word(&e, -1);
+            else if (e.pos > 0) e.pos = __conio_edit_off(&e, __conio_edit_cols(&e, e.pos) - 1);
+            __conio_edit_show(&e, e.len);
+            break;
+        case CONIO_KEY_RIGHT:
+            if (ev.mods & CONIO_MOD_CTRL) e.pos = __conio_edit_word(&e, 1);
+            else if (e.pos < e.len) e.pos = __conio_edit_off(&e, __conio_edit_cols(&e, e.pos) + 1);
+            __conio_edit_show(&e, e.len);
+            break;
+        case CONIO_KEY_HOME: e.pos = 0; __conio_edit_show(&e, e.len); break;
+        case CONIO_KEY_END: e.pos = e.len; __conio_edit_show(&e, e.len); break;
+        case CONIO_KEY_UP: __conio_edit_recall(&e, e.hist - 1); break;
+        case CONIO_KEY_DOWN: __conio_edit_recall(&e, e.hist + 1); break;
+        case CONIO_KEY_ENTER:
+            e.pos = e.len;
+            __conio_edit_show(&e, e.len);
+            __conio_edit_put(&e, "\r\n", 2);
+            done = 1;
+            break;
+        default:
+            break;
+        }
+        term->out.hold--;
+        __conio_out_end(term);
+    }
+
+    if (e.asked) __conio_cpr_newest(term, NULL, NULL, 0);  /* Dropped when it comes, if not yet */
+    if (began) conio_session_end_ctx(term);
+    __conio_hist_add(term, e.s, e.len);
+    e.s[e.len] = '\0';
+    buffer[1] = (char)e.len;
+    return e.s;
+}
+
+/**
+ * @brief Reads a line from the terminal with line editing and history.
+ *
+ * Like `cgets()` of Borland's conio: @p buffer[0] holds the maximum number of bytes
+ * to read (including the null terminator), @p buffer[1] receives the length of the
+ * line, and the line is stored, null-terminated and without the newline, from
+ * @p buffer[2]. The buffer must be at least @p buffer[0] + 2 bytes long.
+ *
+ * The line is edited in place in @p buffer, starting from the @p buffer[1] bytes
+ * already there (set @p buffer[1] to zero for an empty line). After each key only
+ * the changed tail of the line is written, with relative cursor movements, and the
+ * output of every key is written with a single system call. Lines longer than the
+ * terminal width wrap across rows. Keys:
+ *
+ *  - Left, Right, Ctrl+B, Ctrl+F: move by one character
+ *  - Ctrl+Left, Ctrl+Right, Alt+B, Alt+F: move by one word
+ *  - Home, End, Ctrl+A, Ctrl+E: move to the start or end of the line
+ *  - Backspace, Delete, Ctrl+D: delete a character
+ *  - Ctrl+K, Ctrl+U: kill the text after or before the cursor
+ *  - Ctrl+W, Alt+Backspace, Alt+D: kill the previous or next word
+ *  - Ctrl+Y: insert the text killed last
+ *  - Up, Down, Ctrl+P, Ctrl+N: browse the history
+ *  - Enter: accept the line
+ *
+ * Accepted lines are added to a history of the last @ref CONIO_HISTORY_SIZE lines,
+ * kept in fixed-size slots of 255 bytes per terminal context.
+ *
+ * If the input is not a terminal, the line is read like `cgets()` does, without
+ * editing.
+ *
+ * @param[in,out] buffer  The buffer, see above.
+ * @return                Returns @p buffer + 2, or `NULL` on end of input before any
+ *                        character was read.
+ *
+ * @note Every character is assumed to take one column, so lines containing wide
+ *       characters (such as CJK ideographs) are not displayed correctly.
+ *
+ * @since 0.4.0
+ * @see   cgets(char*)
+ */
+char* conio_readline(char* buffer) {
+    return conio_readline_ctx(&__conio_def, buffer);
+}
+
+#if defined(__linux__)
+/**
+ * Defined if the event loop (`conio_loop_*` functions) is available.
+ * The event loop is built on `epoll(7)` and `timerfd(2)` and is only available on Linux.
+ *
+ * @since 0.4.0
+ */
+#  define CONIO_HAVE_LOOP  1
+
+/**
+ * @name Event loop file descriptor events
+ *
+ * Flags for @ref conio_loop_add_fd() and the file descriptor callback.
+ *
+ * @since 0.4.0
+ * @{
+ */
+#  define CONIO_LOOP_READ   0x01  /**< The file descriptor is readable. */
+#  define CONIO_LOOP_WRITE  0x02  /**< The file descriptor is writable. */
+#  define CONIO_LOOP_ERROR  0x04  /**< An error or hang-up occurred (callback only). */
+/** @} */
+
+/** Opaque type of the event loop, see @ref conio_loop_new(). */
+typedef struct conio_loop conio_loop_t;
+
+/** Callback for decoded key presses, see @ref conio_loop_on_key(). */
+typedef void (*conio_key_cb)(conio_loop_t* loop, const conio_event_t* ev, void* user);
+/** Callback for expired timers, see @ref conio_loop_add_timer(). */
+typedef void (*conio_timer_cb)(conio_loop_t* loop, int id, void* user);
+/** Callback for file descriptor events, see @ref conio_loop_add_fd(). */
+typedef void (*conio_fd_cb)(conio_loop_t* loop, int fd, int events, void* user);
+/** Callback for terminal resizes, see @ref conio_loop_on_resize(). */
+typedef void (*conio_resize_cb)(conio_loop_t* loop, cpos_t cols, cpos_t rows, void* user);
+/** Callback for key presses of a served terminal, see @ref conio_loop_add_term(). */
+typedef void (*conio_term_cb)(conio_loop_t* loop, conio_term_t* term, const conio_event_t* ev, void* user);
+
+/** Kinds of file descriptors watched by the event loop. */
+enum {
+    __CONIO_WATCH_INPUT, __CONIO_WATCH_WINCH, __CONIO_WATCH_TIMER, __CONIO_WATCH_FD,
+    __CONIO_WATCH_TERM, __CONIO_WATCH_TERM_OUT
+};
+
+/**
+ * @brief A file descriptor registered with the event loop.
+ *
+ * @since 0.4.0
+ */
+struct __conio_watch {
+    int                   type;      /**< One of the `__CONIO_WATCH_*` kinds. */
+    int                   fd;        /**< The watched file descriptor. */
+    int                   id;        /**< Identifier of a timer, see @ref conio_loop_add_timer(). */
+    int                   periodic;  /**< Non-zero for periodic timers. */
+    int                   dead;      /**< Non-zero once removed, freed after the current dispatch. */
+    conio_timer_cb        on_timer;  /**< Callback of a timer. */
+    conio_fd_cb           on_fd;     /**< Callback of a user file descriptor. */
+    conio_term_cb         on_term;   /**< Callback of a served terminal. */
+    void*                 user;      /**< User data passed to the callback. */
+    conio_term_t*         term;      /**< The served terminal, or the one the keys are read from. */
+    struct __conio_watch* out;       /**< Watch of the output of the served terminal, if it differs. */
+    int                   writing;   /**< Non-zero while waiting for the file descriptor to be writable. */
+    int                   esc;       /**< Non-zero while in the list of incomplete escape sequences. */
+    unsigned long         esc_at;    /**< Time at which an incomplete escape sequence is taken as is. */
+    struct __conio_watch* esc_next;  /**< Next watch in the list of incomplete escape sequences. */
+    struct __conio_watch* next;      /**< Next registered watch. */
+};
+
+/**
+ * @brief Internal state of an event loop.
+ *
+ * @since 0.4.0
+ */
+struct conio_loop {
+    conio_term_t*         term;         /**< The terminal context the keys are read from. */
+    int                   epfd;         /**< The `epoll` instance. */
+    int                   running;      /**< Non-zero while `conio_loop_run()` runs. */
+    int                   dispatching;  /**< Non-zero while events are being dispatched. */
+    struct __conio_watch* watches;      /**< Registered file descriptors. */
+    struct __conio_watch* input;        /**< Watch of the terminal input, if any. */
+    conio_key_cb          on_key;       /**< Key press callback. */
+    void*                 key_user;     /**< User data of @ref on_key. */
+    conio_resize_cb       on_resize;    /**< Resize callback. */
+    void*                 resize_user;  /**< User data of @ref on_resize. */
+    int                   ndead;        /**< Number of unregistered watches not freed yet. */
+    int                   timer_id;     /**< Identifier of the last added timer. */
+    conio_term_t*         dirty;        /**< Served terminals with output to write. */
+    struct __conio_watch* esc_head;     /**< Served terminals with an incomplete escape sequence, oldest first. */
+    struct __conio_watch* esc_tail;     /**< Last watch in that list. */
+};
+
+/** Number of event loops using @ref __conio_winch_pipe. */
+static int __conio_winch_users;
+
+/**
+ * @brief Registers a file descriptor with the event loop.
+ *
+ * @return The new watch, or `NULL` on failure.
+ *
+ * @since 0.4.0
+ */
+static struct __conio_watch* __conio_loop_watch(conio_loop_t* __loop, int __type,
+                                                int __fd, int __events) {
+    struct __conio_watch* w = (struct __conio_watch*)calloc(1, sizeof(*w));
+    struct epoll_event ev;
+    if (!w) return NULL;
+
+    w->type = __type;
+    w->fd = __fd;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = ((__events & CONIO_LOOP_READ) ? (uint32_t)EPOLLIN : 0U)
+              | ((__events & CONIO_LOOP_WRITE) ? (uint32_t)EPOLLOUT : 0U);
+    ev.data.ptr = w;
+    if (epoll_ctl(__loop->epfd, EPOLL_CTL_ADD, __fd, &ev) != 0) {
+        free(w);
+        return NULL;
+    }
+
+    w->next = __loop->watches;
+    __loop->watches = w;
+    return w;
+}
+
+/**
+ * @brief Unregisters a watch; it is freed once no event refers to it anymore.
+ *
+ * The watch leaves the list of incomplete escape sequences.
+ *
+ * @since 0.4.0
+ */
+static void __conio_loop_unwatch(conio_loop_t* __loop, struct __conio_watch* __w) {
+    if (__w->esc) {
+        struct __conio_watch *prev = NULL, *e;
+        for (e = __loop->esc_head; e; prev = e, e = e->esc_next) {
+            if (e != __w) continue;
+            if (prev) prev->esc_next = __w->esc_next;
+            else __loop->esc_head = __w->esc_next;
+            if (__loop->esc_tail == __w) __loop->esc_tail = prev;
+            break;
+        }
+    }
+    epoll_ctl(__loop->epfd, EPOLL_CTL_DEL, __w->fd, NULL);
+    if (__w->type == __CONIO_WATCH_TIMER) close(__w->fd);
+    if (__w == __loop->input) __loop->input = NULL;
+    __w->dead = 1;
+    __loop->ndead++;
+}
+
+/**
+ * @brief Frees the watches that have been unregistered.
+ *
+ * @since 0.4.0
+ */
+static void __conio_loop_reap(conio_loop_t* __loop) {
+    struct __conio_watch** pw = &__loop->watches;
+    if (__loop->ndead == 0) return;  /* Nothing to walk the list for */
+    __loop->ndead = 0;
+    while (*pw) {
+        struct __conio_watch* w = *pw;
+        if (w->dead) {
+            *pw = w->next;
+            free(w);
+        } else {
+            pw = &w->next;
+        }
+    }
+}
+
+/**
+ * @brief Same as @ref conio_loop_new(), reading the keys from the given terminal context.
+ *
+ * @param[in] term  The terminal context, it must not use a backend.
+ *
+ * @since 0.4.0
+ */
+conio_loop_t* conio_loop_new_ctx(conio_term_t* term) {
+    conio_loop_t* loop = (conio_loop_t*)calloc(1, sizeof(*loop));
+    if (!loop) return NULL;
+    loop->term = term;
+    loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epfd < 0) {
+        free(loop);
+        return NULL;
+    }
+
+    /* Terminal resizes are delivered through a self-pipe */
+    if (__conio_winch_users == 0) {
+        int fds[2], i;
+        if (pipe(fds) == 0) {
+            for (i = 0; i < 2; i++) {
+                fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+                fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+            }
+            __conio_winch_pipe[0] = fds[0];
+            __conio_winch_pipe[1] = fds[1];
+            __conio_winch_hook();
+        }
+    }
+    __conio_winch_users++;
+    if (__conio_winch_pipe[0] >= 0)
+        __conio_loop_watch(loop, __CONIO_WATCH_WINCH, __conio_winch_pipe[0], CONIO_LOOP_READ);
+
+    return loop;
+}
+
+/**
+ * @brief Creates an event loop.
+ *
+ * The event loop waits on the terminal input, terminal resizes (`SIGWINCH`),
+ * timers and any file descriptors registered by the application with a single
+ * `epoll_wait(2)` call, and dispatches decoded key presses, timer expirations
+ * and file descriptor events to callbacks. While idle, it sleeps in the kernel
+ * instead of polling `kbhit()`.
+ *
+ * Example
+ * -------
+ * ```c
+ * static void on_key(conio_loop_t* loop, const conio_event_t* ev, void* user) {
+ *     if (ev->key == CONIO_KEY_CHAR && ev->codepoint == 'q') conio_loop_stop(loop);
+ * }
+ * static void on_tick(conio_loop_t* loop, int id, void* user) {
+ *     redraw_status();
+ * }
+ *
+ * conio_loop_t* loop = conio_loop_new();
+ * conio_loop_on_key(loop, on_key, NULL);
+ * conio_loop_add_timer(loop, 1000, 1, on_tick, NULL);
+ * conio_loop_run(loop);
+ * conio_loop_free(loop);
+ * ```
+ *
+ * @return The new event loop, or `NULL` on failure.
+ *
+ * @note Available on Linux only, check for the @ref CONIO_HAVE_LOOP macro.
+ *
+ * @since 0.4.0
+ * @see   conio_loop_run(conio_loop_t*)
+ * @see   conio_loop_free(conio_loop_t*)
+ */
+conio_loop_t* conio_loop_new(void) {
+    return conio_loop_new_ctx(&__conio_def);
+}
+
+/**
+ * @brief Destroys an event loop created by @ref conio_loop_new().
+ *
+ * Closes the timers of the loop. File descriptors registered with
+ * @ref conio_loop_add_fd() are not closed.
+ *
+ * @param[in] loop  The event loop.
+ *
+ * @since 0.4.0
+ */
+void conio_loop_free(conio_loop_t* loop) {
+    struct __conio_watch* w;
+    if (!loop) return;
+
+    for (w = loop->watches; w; w = w->next) {
+        if (w->dead) continue;
+        if (w->type == __CONIO_WATCH_TERM) {
+            memset(&w->term->srv, 0, sizeof(w->term->srv));
+            w->term->out.nonblock = 0;
+        }
+        __conio_loop_unwatch(loop, w);
+    }
+    __conio_loop_reap(loop);
+    close(loop->epfd);
+    free(loop);
+
+    if (--__conio_winch_users == 0 && __conio_winch_pipe[0] >= 0) {
+        __conio_winch_unhook();
+        close(__conio_winch_pipe[0]);
+        close(__conio_winch_pipe[1]);
+        __conio_winch_pipe[0] = __conio_winch_pipe[1] = -1;
+    }
+}
+
+/**
+ * @brief Sets the callback for key presses read from the terminal.
+ *
+ * Input is decoded the same way as by @ref conio_read_event(). Setting a callback
+ * starts watching the standard input, passing `NULL` stops it.
+ *
+ * @param[in] loop  The event loop.
+ * @param[in] cb    The callback, or `NULL`.
+ * @param[in] user  User data passed to the callback.
+ * @return          Returns 0 on success, or -1 on failure.
+ *
+ * @since 0.4.0
+ */
+int conio_loop_on_key(conio_loop_t* loop, conio_key_cb const cb, void* user) {
+    if (!loop) return -1;
+    loop->on_key = cb;
+    loop->key_user = user;
+
+    if (cb && !loop->input) {
+        loop->input = __conio_loop_watch(loop, __CONIO_WATCH_INPUT, loop->term->in_fd, CONIO_LOOP_READ);
+        if (!loop->input) return -1;
+        loop->input->term = loop->term;
+    } else if (!cb && loop->input) {
+        __conio_loop_unwatch(loop, loop->input);
+    }
+    return 0;
+}
+
+/**
+ * @brief Sets the callback for terminal resizes.
+ *
+ * @param[in] loop  The event loop.
+ * @param[in] cb    The callback receiving the new size, or `NULL`.
+ * @param[in] user  User data passed to the callback.
+ *
+ * @since 0.4.0
+ */
+void conio_loop_on_resize(conio_loop_t* loop, conio_resize_cb const cb, void* user) {
+    if (!loop) return;
+    loop->on_resize = cb;
+    loop->resize_user = user;
+}
+
+/**
+ * @brief Adds a timer to the event loop.
+ *
+ * @param[in] loop         The event loop.
+ * @param[in] interval_ms  The time until the timer expires in milliseconds, must not be zero.
+ * @param[in] periodic     Non-zero to restart the timer after every expiration,
+ *                         zero to remove it after the first one.
+ * @param[in] cb           The callback.
+ * @param[in] user         User data passed to the callback.
+ * @return                 The timer identifier, a positive number, or -1 on failure.
+ *
+ * @since 0.4.0
+ * @see   conio_loop_remove_timer(conio_loop_t*, int)
+ */
+int conio_loop_add_timer(conio_loop_t* loop, unsigned long const interval_ms, int const periodic,
+                         conio_timer_cb const cb, void* user) {
+    struct itimerspec its;
+    struct __conio_watch* w;
+    int fd;
+
+    if (!loop || !cb || interval_ms == 0) return -1;
+    fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = (time_t)(interval_ms / 1000);
+    its.it_value.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    if (periodic) its.it_interval = its.it_value;
+
+    if (timerfd_settime(fd, 0, &its, NULL) != 0
+        || !(w = __conio_loop_watch(loop, __CONIO_WATCH_TIMER, fd, CONIO_LOOP_READ))) {
+        close(fd);
+        return -1;
+    }
+    /* Not the file descriptor, whose number is reused once a one-shot timer is closed */
+    loop->timer_id = loop->timer_id % 0x7FFFFFFF + 1;
+    w->id = loop->timer_id;
+    w->periodic = periodic;
+    w->on_timer = cb;
+    w->user = user;
+    return w->id;
+}
+
+/**
+ * @brief Removes a timer added with @ref conio_loop_add_timer().
+ *
+ * It is safe to call this function from a callback, including the callback of
+ * the removed timer.
+ *
+ * @param[in] loop  The event loop.
+ * @param[in] id    The timer identifier.
+ * @return          Returns 0 on success, or -1 if there is no such timer.
+ *
+ * @since 0.4.0
+ */
+int conio_loop_remove_timer(conio_loop_t* loop, int const id) {
+    struct __conio_watch* w;
+    if (!loop) return -1;
+    for (w = loop->watches; w; w = w->next) {
+        if (!w->dead && w->type == __CONIO_WATCH_TIMER && w->id == id) {
+            __conio_loop_unwatch(loop, w);
+            if (!loop->dispatching) __conio_loop_reap(loop);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Adds a file descriptor of the application to the event loop.
+ *
+ * @param[in] loop    The event loop.
+ * @param[in] fd      The file descriptor, it is not closed by the event loop.
+ * @param[in] events  Combination of @ref CONIO_LOOP_READ and @ref CONIO_LOOP_WRITE.
+ * @param[in] cb      The callback, receiving the events that occurred.
+ * @param[in] user    User data passed to the callback.
+ * @return            Returns 0 on success, or -1 on failure.
+ *
+ * @since 0.4.0
+ * @see   conio_loop_remove_fd(conio_loop_t*, int)
+ */
+int conio_loop_add_fd(conio_loop_t* loop, int const fd, int const events,
+                      conio_fd_cb const cb, void* user) {
+    struct __conio_watch* w;
+    if (!loop || !cb) return -1;
+    if (!(w = __conio_loop_watch(loop, __CONIO_WATCH_FD, fd, events))) return -1;
+    w->on_fd = cb;
+    w->user = user;
+    return 0;
+}
+
+/**
+ * @brief Removes a file descriptor added with @ref conio_loop_add_fd().
+ *
+ * It is safe to call this function from a callback.
+ *
+ * @param[in] loop  The event loop.
+ * @param[in] fd    The file descriptor.
+ * @return          Returns 0 on success, or -1 if the file descriptor is not registered.
+ *
+ * @since 0.4.0
+ */
+int conio_loop_remove_fd(conio_loop_t* loop, int const fd) {
+    struct __conio_watch* w;
+    if (!loop) return -1;
+    for (w = loop->watches; w; w = w->next) {
+        if (!w->dead && w->type == __CONIO_WATCH_FD && w->fd == fd) {
+            __conio_loop_unwatch(loop, w);
+            if (!loop->dispatching) __conio_loop_reap(loop);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Serves a terminal context with the event loop.
+ *
+ * Turns the loop into a server that handles any number of terminals (pseudo
+ * terminal masters, sockets of remote clients, ...) in a single thread. For each
+ * served terminal, the loop reads the input when it arrives, decodes it into key
+ * events like @ref conio_read_event() and passes them to @p cb. Everything written
+ * to the terminal with the `_ctx` functions is buffered and written by the loop
+ * after each round of callbacks, with one `write(2)` per terminal. Nothing blocks:
+ * the file descriptors are made non-blocking, and output a terminal does not accept
+ * yet is kept and written when it becomes writable.
+ *
+ * When the input ends, reading or writing fails, or more than @ref CONIO_OUTBUF_BACKLOG
+ * bytes of output are pending, @p cb is called with a `NULL` event and the terminal
+ * is removed from the loop; the callback usually frees it there.
+ *
+ * Example
+ * -------
+ * ```c
+ * static void on_key(conio_loop_t* loop, conio_term_t* term, const conio_event_t* ev, void* user) {
+ *     if (!ev) {  // The client went away
+ *         close(term->in_fd);
+ *         conio_term_free(term);
+ *         return;
+ *     }
+ *     gotoxy_ctx(term, 1, 1);
+ *     putch_ctx(term, (int)ev->codepoint);
+ * }
+ *
+ * conio_term_t* term = conio_term_new(client_fd, client_fd);
+ * conio_loop_add_term(loop, term, on_key, NULL);
+ * ```
+ *
+ * @param[in] loop  The event loop.
+ * @param[in] term  The terminal context, it must not use a backend.
+ * @param[in] cb    The callback.
+ * @param[in] user  User data passed to the callback.
+ * @return          Returns 0 on success, or -1 on failure.
+ *
+ * @note The flush policy of the context is set to zero (see @ref conio_setflush()),
+ *       and its file descriptors are left non-blocking when it is removed. Functions
+ *       that wait for a reply of the terminal, like `wherexy_ctx()`, do not work on
+ *       a served terminal unless the cursor is tracked.
+ *
+ * @since 0.4.0
+ * @see   conio_loop_remove_term(conio_loop_t*, conio_term_t*)
+ */
+int conio_loop_add_term(conio_loop_t* loop, conio_term_t* term, conio_term_cb const cb, void* user) {
+    struct __conio_watch* w;
+    if (!loop || !term || !cb || term->be || term->srv.loop) return -1;
+
+    fcntl(term->in_fd, F_SETFL, fcntl(term->in_fd, F_GETFL) | O_NONBLOCK);
+    if (term->out_fd != term->in_fd)
+        fcntl(term->out_fd, F_SETFL, fcntl(term->out_fd, F_GETFL) | O_NONBLOCK);
+
+    if (!(w = __conio_loop_watch(loop, __CONIO_WATCH_TERM, term->in_fd, CONIO_LOOP_READ))) return -1;
+    w->term = term;
+    w->on_term = cb;
+    w->user = user;
+    if (term->out_fd != term->in_fd) {
+        /* Only waits for writability, while output is pending */
+        w->out = __conio_loop_watch(loop, __CONIO_WATCH_TERM_OUT, term->out_fd, 0);
+        if (!w->out) {
+            __conio_loop_unwatch(loop, w);
+            if (!loop->dispatching) __conio_loop_reap(loop);
+            return -1;
+        }
+        w->out->term = term;
+    }
+
+    term->srv.loop = loop;
+    term->srv.watch = w;
+    term->srv.list = &loop->dirty;
+    term->out.nonblock = 1;
+    term->out.overrun = 0;
+    term->out.policy = 0;
+    term->out.custom = 1;
+    if (term->out.len > 0) __conio_out_queue(term);
+    return 0;
+}
+
+/**
+ * @brief Stops serving a terminal added with @ref conio_loop_add_term().
+ *
+ * The context and its file descriptors are not closed. It is safe to call this
+ * function from a callback.
+ *
+ * @param[in] loop  The event loop.
+ * @param[in] term  The terminal context.
+ * @return          Returns 0 on success, or -1 if the terminal is not served by the loop.
+ *
+ * @since 0.4.0
+ */
+int conio_loop_remove_term(conio_loop_t* loop, conio_term_t* term) {
+    struct __conio_watch* w;
+    if (!loop || !term || term->srv.loop != loop) return -1;
+    w = term->srv.watch;
+
+    if (term->srv.queued) {
+        conio_term_t** pt;
+        for (pt = &loop->dirty; *pt; pt = &(*pt)->srv.next) {
+            if (*pt == term) {
+                *pt = term->srv.next;
+                break;
+            }
+        }
+    }
+    if (w->out) __conio_loop_unwatch(loop, w->out);
+    __conio_loop_unwatch(loop, w);
+    memset(&term->srv, 0, sizeof(term->srv));
+    term->out.nonblock = 0;
+    if (!loop->dispatching) __conio_loop_reap(loop);
+    return 0;
+}
+
+/**
+ * @brief Sets whether the loop waits for a served terminal to accept more output.
+ *
+ * @since 0.4.0
+ */
+static void __conio_loop_want_write(conio_loop_t* __loop, struct __conio_watch* __w, int __want) {
+    struct __conio_watch* o = __w->out ? __w->out : __w;
+    struct epoll_event ev;
+    if (o->writing == __want) return;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = ((o == __w) ? (uint32_t)EPOLLIN : 0U) | (__want ? (uint32_t)EPOLLOUT : 0U);
+    ev.data.ptr = o;
+    if (epoll_ctl(__loop->epfd, EPOLL_CTL_MOD, o->fd, &ev) == 0) o->writing = __want;
+}
+
+/**
+ * @brief Ends the service of a terminal: the callback receives a `NULL` event,
+ *        then the terminal is removed from the loop.
+ *
+ * Must be called while dispatching, the watch stays valid until it is reaped.
+ *
+ * @since 0.4.0
+ */
+static void __conio_loop_hangup(conio_loop_t* __loop, struct __conio_watch* __w) {
+    if (__w->dead) return;
+    __w->on_term(__loop, __w->term, NULL, __w->user);
+    if (!__w->dead) conio_loop_remove_term(__loop, __w->term);
+}
+
+/**
+ * @brief Dispatches the key presses read ahead for a served terminal, or for the
+ *        terminal of the loop.
+ *
+ * An incomplete escape sequence is kept until more input arrives, or until
+ * @ref CONIO_ESC_DELAY milliseconds have passed; then @p __final is non-zero
+ * and it is taken as is. The loop does not block meanwhile.
+ *
+ * @since 0.4.0
+ */
+static void __conio_loop_term_keys(conio_loop_t* __loop, struct __conio_watch* __w, int __final) {
+    conio_term_t* t = __w->term;
+    conio_event_t ev;
+
+    while (!__w->dead && __conio_in_avail(t) > 0) {
+        size_t used = __conio_decode(t->in.buf + t->in.head, __conio_in_avail(t), __final, &ev);
+        if (used == 0) {
+            __w->esc_at = __conio_now_ms() + CONIO_ESC_DELAY;
+            if (!__w->esc) {
+                __w->esc = 1;
+                __w->esc_next = NULL;
+                if (__loop->esc_tail) __loop->esc_tail->esc_next = __w;
+                else __loop->esc_head = __w;
+                __loop->esc_tail = __w;
+            }
+            return;
+        }
+        t->in.head += used;
+        if (__w->type == __CONIO_WATCH_INPUT) __loop->on_key(__loop, &ev, __loop->key_user);
+        else __w->on_term(__loop, t, &ev, __w->user);
+    }
+}
+
+/**
+ * @brief Dispatches the input available on the terminal as key events.
+ *
+ * @since 0.4.0
+ */
+static void __conio_loop_input(conio_loop_t* __loop) {
+    struct __conio_watch* w = __loop->input;
+    if (__conio_in_fill(w->term, 0) < 0) {
+        /* End of input, nothing more will ever arrive */
+        __conio_loop_term_keys(__loop, w, 1);
+        if (!w->dead) __conio_loop_unwatch(__loop, w);
+        __loop->running = 0;
+        return;
+    }
+    __conio_loop_term_keys(__loop, w, 0);
+}
+
+/**
+ * @brief Takes the incomplete escape sequences that have waited long enough as is.
+ *
+ * @since 0.4.0
+ */
+static void __conio_loop_term_expire(conio_loop_t* __loop) {
+    struct __conio_watch *w = __loop->esc_head, *next;
+    unsigned long now = __conio_now_ms();
+
+    __loop->esc_head = __loop->esc_tail = NULL;
+    for (; w; w = next) {
+        next = w->esc_next;
+        w->esc = 0;
+        if (w->dead) continue;  /* Removed by a callback meanwhile */
+        if ((long)(w->esc_at - now) <= 0) {
+            __conio_loop_term_keys(__loop, w, 1);
+        } else {
+            /* Still waiting for the rest of the sequence */
+            w->esc = 1;
+            w->esc_next = NULL;
+            if (__loop->esc_tail) __loop->esc_tail->esc_next = w;
+            else __loop->esc_head = w;
+            __loop->esc_tail = w;
+        }
+    }
+}
+
+/**
+ * @brief Writes the pending output of the served terminals.
+ *
+ * Terminals that do not accept all of it are watched for writability.
+ *
+ * @since 0.4.0
+ */
+static void __conio_loop_term_flush(conio_loop_t* __loop) {
+    int dispatching = __loop->dispatching;
+    conio_term_t* t;
+
+    __loop->dispatching = 1;  /* A hang-up must not free the watches */
+    while ((t = __loop->dirty) != NULL) {
+        struct __conio_watch* w = t->srv.watch;
+        __loop->dirty = t->srv.next;
+        t->srv.queued = 0;
+
+        if (t->out.overrun || __conio_out_flush(t) != 0) {
+            __conio_loop_hangup(__loop, w);
+            continue;
+        }
+        __conio_loop_want_write(__loop, w, t->out.len > 0);
+    }
+    __loop->dispatching = dispatching;
+    if (!dispatching) __conio_loop_reap(__loop);
+}
+
+/**
+ * @brief Handles the events of a served terminal.
+ *
+ * @since 0.4.0
+ */
+static void __conio_loop_term_event(conio_loop_t* __loop, struct __conio_watch* __w, uint32_t __events) {
+    struct __conio_watch* w = (__w->type == __CONIO_WATCH_TERM) ? __w : __w->term->srv.watch;
+
+    if (__events & EPOLLIN) {
+        if (__conio_in_fill(w->term, -1) < 0) {  /* Never waits, the file descriptor is non-blocking */
+            __conio_loop_term_keys(__loop, w, 1);
+            __conio_loop_hangup(__loop, w);
+            return;
+        }
+        __conio_loop_term_keys(__loop, w, 0);
+    }
+    if (w->dead) return;
+    if (__events & EPOLLOUT) {
+        __conio_out_queue(w->term);
+    } else if (__events & (EPOLLERR | EPOLLHUP)) {
+        __conio_loop_hangup(__loop, w);
+    }
+}
+
+/**
+ * @brief Waits for events once and dispatches them.
+ *
+ * Pending output is flushed before waiting, according to the flush policy.
+ *
+ * @param[in] loop        The event loop.
+ * @param[in] timeout_ms  Maximum time to wait in milliseconds, negative to wait indefinitely.
+ * @return                The number of dispatched events, or -1 on error.
+ *
+ * @since 0.4.0
+ * @see   conio_loop_run(conio_loop_t*)
+ */
+int conio_loop_run_once(conio_loop_t* loop, int const timeout_ms) {
+    struct epoll_event events[64];
+    int n, i, timeout = timeout_ms;
+    if (!loop) return -1;
+
+    __conio_out_input(loop->term);
+    __conio_loop_term_flush(loop);
+    /* Keys that have been read ahead would not wake up epoll */
+    if (loop->input && !loop->input->esc && __conio_in_avail(loop->term) > 0) {
+        __conio_loop_input(loop);
+        __conio_loop_term_flush(loop);
+        return 1;
+    }
+
+    /* Wake up in time to take incomplete escape sequences as is */
+    if (loop->esc_head) {
+        unsigned long now = __conio_now_ms();
+        struct __conio_watch* w;
+        for (w = loop->esc_head; w; w = w->esc_next) {
+            long left = (long)(w->esc_at - now);
+            if (left < 0) left = 0;
+            if (timeout < 0 || left < timeout) timeout = (int)left;
+        }
+    }
+
+    n = epoll_wait(loop->epfd, events, (int)(sizeof(events) / sizeof(events[0])), timeout);
+    if (n < 0) return (errno == EINTR) ? 0 : -1;
+
+    loop->dispatching = 1;
+    for (i = 0; i < n; i++) {
+        struct __conio_watch* w = (struct __conio_watch*)events[i].data.ptr;
+        if (w->dead) continue;
+
+        switch (w->type) {
+        case __CONIO_WATCH_INPUT:
+            __conio_loop_input(loop);
+            break;
+        case __CONIO_WATCH_TERM:
+        case __CONIO_WATCH_TERM_OUT:
+            __conio_loop_term_event(loop, w, events[i].events);
+            break;
+        case __CONIO_WATCH_WINCH: {
+            char drain[64];
+            cpos_t cols, rows;
+            while (read(w->fd, drain, sizeof(drain)) > 0) {}
+            /* Also refreshes the cached size and calls the callback of the context */
+            if (conio_getsize_ctx(loop->term, &cols, &rows) == 0 && loop->on_resize)
+                loop->on_resize(loop, cols, rows, loop->resize_user);
+            break;
+        }
+        case __CONIO_WATCH_TIMER: {
+            uint64_t expirations;
+            if (read(w->fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations)) break;
+            if (!w->periodic) __conio_loop_unwatch(loop, w);
+            w->on_timer(loop, w->id, w->user);
+            break;
+        }
+        default: {
+            int ev = ((events[i].events & EPOLLIN) ? CONIO_LOOP_READ : 0)
+                   | ((events[i].events & EPOLLOUT) ? CONIO_LOOP_WRITE : 0)
+                   | ((events[i].events & (EPOLLERR | EPOLLHUP)) ? CONIO_LOOP_ERROR : 0);
+            w->on_fd(loop, w->fd, ev, w->user);
+            break;
+        }
+        }
+    }
+    if (loop->esc_head) __conio_loop_term_expire(loop);
+    __conio_loop_term_flush(loop);
+    loop->dispatching = 0;
+    __conio_loop_reap(loop);
+    return n;
+}
+
+/**
+ * @brief Runs the event loop until @ref conio_loop_stop() is called.
+ *
+ * If a key callback is set, the terminal is kept in a raw-mode session
+ * (see @ref conio_session_begin()) while the loop runs.
+ *
+ * @param[in] loop  The event loop.
+ * @return          Returns 0 when stopped, or -1 on error.
+ *
+ * @since 0.4.0
+ * @see   conio_loop_stop(conio_loop_t*)
+ */
+int conio_loop_run(conio_loop_t* loop) {
+    int began, ret = 0;
+    if (!loop) return -1;
+
+    began = (loop->input != NULL && conio_session_begin_ctx(loop->term) == 0);
+    loop->running = 1;
+    while (loop->running) {
+        if (conio_loop_run_once(loop, -1) < 0) {
+            ret = -1;
+            break;
+        }
+    }
+    loop->running = 0;
+    if (began) conio_session_end_ctx(loop->term);
+    return ret;
+}
+
+/**
+ * @brief Makes @ref conio_loop_run() return after the current dispatch.
+ *
+ * @param[in] loop  The event loop.
+ *
+ * @since 0.4.0
+ */
+void conio_loop_stop(conio_loop_t* loop) {
+    if (loop) loop->running = 0;
+}
+#endif  /* __linux__ */
+
+/**
+ * @brief Returns non-zero if two cells hold the same character and attributes.
+ *
+ * @since 0.4.0
+ */
+static int __conio_cell_eq(const conio_cell_t* __a, const conio_cell_t* __b) {
+    return __a->ch == __b->ch && __a->attr == __b->attr;
+}
+
+/**
+ * @brief Finds the first and the last differing cell of two rows, portable implementation.
+ *
+ * @param[in]  __a      The first row.
+ * @param[in]  __b      The second row.
+ * @param[in]  __n      The number of cells of the rows.
+ * @param[out] __first  Receives the index of the first differing cell.
+ * @param[out] __last   Receives the index of the last differing cell.
+ * @return              Returns 1 if the rows differ, 0 if they are equal.
+ *
+ * @since 0.4.0
+ */
+static int __conio_row_span_scalar(const conio_cell_t* __a, const conio_cell_t* __b, cpos_t __n,
+                                   cpos_t* __first, cpos_t* __last) {
+    cpos_t i = 0, j = __n;
+    while (i < __n && __conio_cell_eq(__a + i, __b + i)) i++;
+    if (i == __n) return 0;
+    while (__conio_cell_eq(__a + j - 1, __b + j - 1)) j--;
+    *__first = i;
+    *__last = j - 1;
+    return 1;
+}
+
+#ifdef CONIO_HAVE_SIMD
+/**
+ * @brief Same as @ref __conio_row_span_scalar, comparing 4 cells per step with SSE2.
+ *
+ * @since 0.4.0
+ */
+__attribute__((target("sse2")))
+static int __conio_row_span_sse2(const conio_cell_t* __a, const conio_cell_t* __b, cpos_t __n,
+                                 cpos_t* __first, cpos_t* __last) {
+    cpos_t i = 0, j = __n;
+    for (; i + 4 <= __n; i += 4) {
+        __m128i e0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(__a + i)),
+                                     _mm_loadu_si128((const __m128i*)(__b + i)));
+        __m128i e1 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(__a + i + 2)),
+                                     _mm_loadu_si128((const __m128i*)(__b + i + 2)));
+        if (_mm_movemask_epi8(_mm_and_si128(e0, e1)) != 0xFFFF) break;
+    }
+    while (i < __n && __conio_cell_eq(__a + i, __b + i)) i++;
+    if (i == __n) return 0;
+    for (; j >= i + 4; j -= 4) {
+        __m128i e0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(__a + j - 4)),
+                                     _mm_loadu_si128((const __m128i*)(__b + j - 4)));
+        __m128i e1 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(__a + j - 2)),
+                                     _mm_loadu_si128((const __m128i*)(__b + j - 2)));
+        if (_mm_movemask_epi8(_mm_and_si128(e0, e1)) != 0xFFFF) break;
+    }
+    while (__conio_cell_eq(__a + j - 1, __b + j - 1)) j--;
+    *__first = i;
+    *__last = j - 1;
+    return 1;
+}
+
+/**
+ * @brief Same as @ref __conio_row_span_scalar, comparing 8 cells per step with AVX2.
+ *
+ * @since 0.4.0
+ */
+__attribute__((target("avx2")))
+static int __conio_row_span_avx2(const conio_cell_t* __a, const conio_cell_t* __b, cpos_t __n,
+                                 cpos_t* __first, cpos_t* __last) {
+    cpos_t i = 0, j = __n;
+    for (; i + 8 <= __n; i += 8) {
+        __m256i e0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(__a + i)),
+                                        _mm256_loadu_si256((const __m256i*)(__b + i)));
+        __m256i e1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(__a + i + 4)),
+                                        _mm256_loadu_si256((const __m256i*)(__b + i + 4)));
+        if (_mm256_movemask_epi8(_mm256_and_si256(e0, e1)) != -1) break;
+    }
+    while (i < __n && __conio_cell_eq(__a + i, __b + i)) i++;
+    if (i == __n) return 0;
+    for (; j >= i + 8; j -= 8) {
+        __m256i e0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(__a + j - 8)),
+                                        _mm256_loadu_si256((const __m256i*)(__b + j - 8)));
+        __m256i e1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(__a + j - 4)),
+                                        _mm256_loadu_si256((const __m256i*)(__b + j - 4)));
+        if (_mm256_movemask_epi8(_mm256_and_si256(e0, e1)) != -1) break;
+    }
+    while (__conio_cell_eq(__a + j - 1, __b + j - 1)) j--;
+    *__first = i;
+    *__last = j - 1;
+    return 1;
+}
+#endif  /* CONIO_HAVE_SIMD */
+
+/** Type of the row comparison functions, see @ref __conio_row_span_scalar. */
+typedef int (*__conio_row_span_fn)(const conio_cell_t*, const conio_cell_t*, cpos_t, cpos_t*, cpos_t*);
+
+static int __conio_row_span_init(const conio_cell_t* __a, const conio_cell_t* __b, cpos_t __n,
+                                 cpos_t* __first, cpos_t* __last);
+
+/** The row comparison used, chosen for the processor on the first call. */
+static __conio_row_span_fn __conio_row_span = __conio_row_span_init;
+
+/**
+ * @brief Chooses the fastest row comparison supported by the processor, then compares.
+ *
+ * @since 0.4.0
+ */
+static int __conio_row_span_init(const conio_cell_t* __a, const conio_cell_t* __b, cpos_t __n,
+                                 cpos_t* __first, cpos_t* __last) {
+    __conio_row_span = __conio_row_span_scalar;
+#ifdef CONIO_HAVE_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))      __conio_row_span = __conio_row_span_avx2;
+    else if (__builtin_cpu_supports("sse2")) __conio_row_span = __conio_row_span_sse2;
+#endif  /* CONIO_HAVE_SIMD */
+    return __conio_row_span(__a, __b, __n, __first, __last);
+}
+
+/**
+ * Alignment in bytes of the rows of a @ref conio_grid_t, suitable for the widest
+ * vector loads used by @ref conio_grid_diff().
+ *
+ * @since 0.4.0
+ */
+#define CONIO_GRID_ALIGN  32
+
+/**
+ * @brief A grid of cells, the building block of custom off-screen canvases.
+ *
+ * The cells are stored packed, row after row, and every row starts at an address
+ * aligned to @ref CONIO_GRID_ALIGN bytes. The cell at column `x` and row `y`
+ * (both 1-based) is `cells[(y - 1) * stride + (x - 1)]`, see @ref conio_grid_at().
+ *
+ * @since 0.4.0
+ * @see   conio_grid_init(conio_grid_t*, cpos_t, cpos_t)
+ * @see   conio_grid_diff(const conio_grid_t*, const conio_grid_t*, conio_span_t*)
+ */
+typedef struct conio_grid {
+    conio_cell_t* cells;   /**< The first cell of the first row. */
+    cpos_t        cols;    /**< Number of columns. */
+    cpos_t        rows;    /**< Number of rows. */
+    size_t        stride;  /**< Number of cells from the start of a row to the start of the next one. */
+    void*         mem;     /**< The allocated memory. */
+} conio_grid_t;
+
+/**
+ * @brief The changed columns of a row, reported by @ref conio_grid_diff().
+ *
+ * @since 0.4.0
+ */
+typedef struct conio_span {
+    cpos_t first;  /**< First changed column (1-based), zero if the row is unchanged. */
+    cpos_t last;   /**< Last changed column (1-based), zero if the row is unchanged. */
+} conio_span_t;
+
+/**
+ * @brief Allocates a grid of blank cells.
+ *
+ * @param[out] grid  The grid to initialize.
+ * @param[in]  cols  The number of columns.
+ * @param[in]  rows  The number of rows.
+ * @return           Returns 0 on success, or -1 if the size is invalid or on allocation failure.
+ *
+ * @since 0.4.0
+ * @see   conio_grid_free(conio_grid_t*)
+ */
+int conio_grid_init(conio_grid_t* grid, cpos_t const cols, cpos_t const rows) {
+    const size_t per = CONIO_GRID_ALIGN / sizeof(conio_cell_t);
+    size_t i, n;
+
+    if (!grid) return -1;
+    memset(grid, 0, sizeof(*grid));
+    if (cols <= 0 || rows <= 0) return -1;
+
+    grid->stride = ((size_t)cols + per - 1) / per * per;
+    n = grid->stride * (size_t)rows;
+    grid->mem = malloc(n * sizeof(conio_cell_t) + CONIO_GRID_ALIGN - 1);
+    if (!grid->mem) return -1;
+    grid->cells = (conio_cell_t*)(((uintptr_t)grid->mem + CONIO_GRID_ALIGN - 1)
+                                  & ~(uintptr_t)(CONIO_GRID_ALIGN - 1));
+    grid->cols = cols;
+    grid->rows = rows;
+    for (i = 0; i < n; i++) {
+        grid->cells[i].ch = ' ';
+        grid->cells[i].attr = CONIO_ATTR_DEFAULT;
+    }
+    return 0;
+}
+
+/**
+ * @brief Releases a grid allocated by @ref conio_grid_init().
+ *
+ * @param[in,out] grid  The grid to release.
+ *
+ * @since 0.4.0
+ */
+void conio_grid_free(conio_grid_t* grid) {
+    if (!grid) return;
+    free(grid->mem);
+    memset(grid, 0, sizeof(*grid));
+}
+
+/**
+ * @brief Returns a cell of a grid.
+ *
+ * @param[in] grid  The grid.
+ * @param[in] x     The column of the cell (1-based).
+ * @param[in] y     The row of the cell (1-based).
+ * @return          The cell, or `NULL` if it is outside of the grid.
+ *
+ * @since 0.4.0
+ */
+conio_cell_t* conio_grid_at(const conio_grid_t* grid, cpos_t const x, cpos_t const y) {
+    if (x < 1 || y < 1 || x > grid->cols || y > grid->rows) return NULL;
+    return grid->cells + (size_t)(y - 1) * grid->stride + (size_t)(x - 1);
+}
+
+/**
+ * @brief Compares two grids of the same size row by row.
+ *
+ * For every row, the first and the last column where the grids differ are stored
+ * into @p spans, so the caller only has to look at the cells in between. Rows are
+ * compared with AVX2 or SSE2 instructions when the processor supports them
+ * (see @ref CONIO_HAVE_SIMD), several cells at a time, and cell by cell otherwise.
+ * @ref conio_present() uses the same comparison for its buffers.
+ *
+ * Example
+ * -------
+ * ```c
+ * conio_span_t spans[120];
+ * if (conio_grid_diff(&next, &shown, spans) > 0) {
+ *     for (y = 1; y <= next.rows; y++) {
+ *         if (spans[y - 1].first == 0) continue;  // Unchanged row
+ *         draw(y, spans[y - 1].first, spans[y - 1].last);
+ *     }
+ * }
+ * ```
+ *
+ * @param[in]  a      The first grid.
+ * @param[in]  b      The second grid.
+ * @param[out] spans  Receives the changed columns of every row, must hold `a->rows` spans.
+ * @return            The number of rows that differ, or -1 if the sizes of the grids differ.
+ *
+ * @since 0.4.0
+ */
+int conio_grid_diff(const conio_grid_t* a, const conio_grid_t* b, conio_span_t* spans) {
+    cpos_t y, first, last;
+    int changed = 0;
+
+    if (!a || !b || !spans || a->cols != b->cols || a->rows != b->rows) return -1;
+    for (y = 0; y < a->rows; y++) {
+        if (__conio_row_span(a->cells + (size_t)y * a->stride, b->cells + (size_t)y * b->stride,
+                             a->cols, &first, &last)) {
+            spans[y].first = first + 1;
+            spans[y].last = last + 1;
+            changed++;
+        } else {
+            spans[y].first = spans[y].last = 0;
+        }
+    }
+    return changed;
+}
+
+/** Code point that never matches a real character, marks front buffer cells with unknown content. */
+#define __CONIO_CELL_UNKNOWN  0xFFFFFFFFU
+
+/**
+ * @brief Encodes a Unicode code point as UTF-8.
+ *
+ * @param[in]  __cp   The code point.
+ * @param[out] __out  Buffer of at least 4 bytes that receives the encoded character.
+ * @return            The number of bytes written.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_utf8_encode(uint32_t __cp, char* __out) {
+    if (__cp < 0x80) {
+        __out[0] = (char)__cp;
+        return 1;
+    }
+    if (__cp < 0x800) {
+        __out[0] = (char)(0xC0 | (__cp >> 6));
+        __out[1] = (char)(0x80 | (__cp & 0x3F));
+        return 2;
+    }
+    if (__cp < 0x10000) {
+        __out[0] = (char)(0xE0 | (__cp >> 12));
+        __out[1] = (char)(0x80 | ((__cp >> 6) & 0x3F));
+        __out[2] = (char)(0x80 | (__cp & 0x3F));
+        return 3;
+    }
+    if (__cp > 0x10FFFF) __cp = 0xFFFD;  /* Replacement character */
+    __out[0] = (char)(0xF0 | (__cp >> 18));
+    __out[1] = (char)(0x80 | ((__cp >> 12) & 0x3F));
+    __out[2] = (char)(0x80 | ((__cp >> 6) & 0x3F));
+    __out[3] = (char)(0x80 | (__cp & 0x3F));
+    return 4;
+}
+
+/**
+ * @brief Decodes one UTF-8 encoded character.
+ *
+ * Invalid bytes are decoded as U+FFFD (replacement character).
+ *
+ * @param[in]  __s    The string to decode, must not be empty.
+ * @param[out] __cp   Receives the decoded code point.
+ * @return            The number of bytes consumed.
+ *
+ * @since 0.4.0
+ */
+static size_t __conio_utf8_decode(const char* __s, uint32_t* __cp) {
+    const unsigned char* s = (const unsigned char*)__s;
+    size_t len, i;
+
+    if (s[0] < 0x80)                { *__cp = s[0];        return 1; }
+    else if ((s[0] & 0xE0) == 0xC0) { *__cp = s[0] & 0x1F; len = 2; }
+    else if ((s[0] & 0xF0) == 0xE0) { *__cp = s[0] & 0x0F; len = 3; }
+    else if ((s[0] & 0xF8) == 0xF0) { *__cp = s[0] & 0x07; len = 4; }
+    else                            { *__cp = 0xFFFD;      return 1; }
+
+    for (i = 1; i < len; i++) {
+        if ((s[i] & 0xC0) != 0x80) {  /* Truncated sequence */
+            *__cp = 0xFFFD;
+            return i;
+        }
+        *__cp = (*__cp << 6) | (s[i] & 0x3F);
+    }
+    return len;
+}
+
+/**
+ * @brief Marks columns @p __x0 to @p __x1 (0-based, inclusive) of row @p __y (0-based)
+ *        of the off-screen buffer as written.
+ *
+ * @since 0.4.0
+ */
+static void __conio_scr_touch(struct __conio_scr_state* __s, cpos_t __y, cpos_t __x0, cpos_t __x1) {
+    uint64_t* word = &__s->dirty[__y >> 6];
+    const uint64_t bit = (uint64_t)1 << (__y & 63);
+    if (*word & bit) {
+        if (__x0 < __s->dmin[__y]) __s->dmin[__y] = __x0;
+        if (__x1 > __s->dmax[__y]) __s->dmax[__y] = __x1;
+    } else {
+        *word |= bit;
+        __s->dmin[__y] = __x0;
+        __s->dmax[__y] = __x1;
+    }
+}
+
+/**
+ * @brief Marks every cell of the off-screen buffer as written.
+ *
+ * @since 0.4.0
+ */
+static void __conio_scr_touch_all(struct __conio_scr_state* __s) {
+    cpos_t y;
+    for (y = 0; y < __s->rows; y++) __conio_scr_touch(__s, y, 0, __s->cols - 1);
+}
+
+/**
+ * @brief Returns the index of the lowest set bit of a non-zero word.
+ *
+ * @since 0.4.0
+ */
+static int __conio_ctz64(uint64_t __v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(__v);
+#else
+    int n = 0;
+    while (!(__v & 1)) {
+        __v >>= 1;
+        n++;
+    }
+    return n;
+#endif  /* __GNUC__ || __clang__ */
+}
+
+/**
+ * @brief Same as @ref conio_screen_free(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void conio_screen_free_ctx(conio_term_t* term) {
+    free(term->scr.back);
+    free(term->scr.front);
+    free(term->scr.bhash);
+    free(term->scr.fhash);
+    free(term->scr.dirty);
+    free(term->scr.dmin);
+    free(term->scr.dmax);
+    term->scr.back = term->scr.front = NULL;
+    term->scr.bhash = term->scr.fhash = NULL;
+    term->scr.dirty = NULL;
+    term->scr.dmin = term->scr.dmax = NULL;
+    term->scr.cols = term->scr.rows = 0;
+}
+
+/**
+ * @brief Releases the off-screen buffer allocated by @ref conio_screen_init().
+ *
+ * @since 0.4.0
+ */
+void conio_screen_free(void) {
+    conio_screen_free_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref conio_screen_init(cpos_t, cpos_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_screen_init_ctx(conio_term_t* term, cpos_t cols, cpos_t rows) {
+    size_t n, i;
+    cpos_t c, r;
+
+    /* The terminal size also tells whether the buffer spans whole lines */
+    if (conio_getsize_ctx(term, &c, &r) != 0) c = r = 0;
+    if (cols <= 0) cols = c;
+    if (rows <= 0) rows = r;
+    if (cols <= 0 || rows <= 0) return -1;
+
+    conio_screen_free_ctx(term);
+    n = (size_t)cols * (size_t)rows;
+    term->scr.back  = (conio_cell_t*)malloc(n * sizeof(conio_cell_t));
+    term->scr.front = (conio_cell_t*)malloc(n * sizeof(conio_cell_t));
+    term->scr.bhash = (uint32_t*)malloc((size_t)rows * sizeof(uint32_t));
+    term->scr.fhash = (uint32_t*)calloc((size_t)rows, sizeof(uint32_t));
+    term->scr.dirty = (uint64_t*)calloc(((size_t)rows + 63) / 64, sizeof(uint64_t));
+    term->scr.dmin  = (cpos_t*)malloc((size_t)rows * sizeof(cpos_t));
+    term->scr.dmax  = (cpos_t*)malloc((size_t)rows * sizeof(cpos_t));
+    if (!term->scr.back || !term->scr.front || !term->scr.bhash || !term->scr.fhash
+        || !term->scr.dirty || !term->scr.dmin || !term->scr.dmax) {
+        conio_screen_free_ctx(term);
+        return -1;
+    }
+
+    term->scr.cols = cols;
+    term->scr.rows = rows;
+    term->scr.tcols = c;
+    term->scr.trows = r;
+    for (i = 0; i < n; i++) {
+        term->scr.back[i].ch = ' ';
+        term->scr.back[i].attr = CONIO_ATTR_DEFAULT;
+        term->scr.front[i].ch = __CONIO_CELL_UNKNOWN;
+        term->scr.front[i].attr = CONIO_ATTR_DEFAULT;
+    }
+    __conio_scr_touch_all(&term->scr);
+    return 0;
+}
+
+/**
+ * @brief Allocates the off-screen buffer.
+ *
+ * The off-screen buffer holds a character and its attributes for every cell of
+ * the screen. The application draws into it with @ref conio_screen_putc() and
+ * @ref conio_screen_puts(), and @ref conio_present() writes only the cells that
+ * differ from the previously presented frame. The first presented frame is
+ * written in full.
+ *
+ * Example
+ * -------
+ * ```c
+ * conio_screen_init(0, 0);  // Use the terminal size
+ * for (;;) {
+ *     conio_screen_puts(1, 1, status_line(), CONIO_ATTR_REVERSE);
+ *     conio_present();  // Only the changed cells are written
+ * }
+ * ```
+ *
+ * @param[in] cols  The width of the buffer, or zero to use the terminal width.
+ * @param[in] rows  The height of the buffer, or zero to use the terminal height.
+ * @return          Returns 0 on success, or -1 if the size is unknown or on allocation failure.
+ *
+ * @since 0.4.0
+ * @see   conio_present(void)
+ * @see   conio_screen_free(void)
+ */
+int conio_screen_init(cpos_t cols, cpos_t rows) {
+    return conio_screen_init_ctx(&__conio_def, cols, rows);
+}
+
+/**
+ * @brief Same as @ref conio_screen_clear(uint32_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void conio_screen_clear_ctx(conio_term_t* term, uint32_t const attr) {
+    size_t i, n = (size_t)term->scr.cols * (size_t)term->scr.rows;
+    for (i = 0; i < n; i++) {
+        term->scr.back[i].ch = ' ';
+        term->scr.back[i].attr = attr;
+    }
+    __conio_scr_touch_all(&term->scr);
+}
+
+/**
+ * @brief Fills the off-screen buffer with blanks of the given attributes.
+ *
+ * @param[in] attr  The attributes of the blank cells.
+ *
+ * @since 0.4.0
+ */
+void conio_screen_clear(uint32_t const attr) {
+    conio_screen_clear_ctx(&__conio_def, attr);
+}
+
+/**
+ * @brief Same as @ref conio_screen_invalidate(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void conio_screen_invalidate_ctx(conio_term_t* term) {
+    size_t i, n = (size_t)term->scr.cols * (size_t)term->scr.rows;
+    for (i = 0; i < n; i++) term->scr.front[i].ch = __CONIO_CELL_UNKNOWN;
+    for (i = 0; i < (size_t)term->scr.rows; i++) term->scr.fhash[i] = 0;
+    __conio_scr_touch_all(&term->scr);
+}
+
+/**
+ * @brief Forces the next @ref conio_present() to write every cell.
+ *
+ * Use this after the terminal content has been changed by other means, for
+ * example by `clrscr()` or `printf()`.
+ *
+ * @since 0.4.0
+ */
+void conio_screen_invalidate(void) {
+    conio_screen_invalidate_ctx(&__conio_def);
+}
+
+/**
+ * @brief Same as @ref conio_screen_putc(cpos_t, cpos_t, uint32_t, uint32_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_screen_putc_ctx(conio_term_t* term, cpos_t const x, cpos_t const y, uint32_t const ch, uint32_t const attr) {
+    conio_cell_t* cell;
+    if (x < 1 || y < 1 || x > term->scr.cols || y > term->scr.rows) return -1;
+
+    cell = &term->scr.back[(size_t)(y - 1) * term->scr.cols + (x - 1)];
+    cell->ch = (ch < 0x20 || ch == 0x7F) ? ' ' : ch;  /* Like conio_screen_puts() */
+    cell->attr = attr;
+    __conio_scr_touch(&term->scr, y - 1, x - 1, x - 1);
+    return 0;
+}
+
+/**
+ * @brief Puts a character into a cell of the off-screen buffer.
+ *
+ * A control character is stored as a blank.
+ *
+ * @param[in] x     The column of the cell (1-based).
+ * @param[in] y     The row of the cell (1-based).
+ * @param[in] ch    The Unicode code point of the character.
+ * @param[in] attr  The attributes of the character.
+ * @return          Returns 0 on success, or -1 if the cell is outside of the buffer.
+ *
+ * @since 0.4.0
+ */
+int conio_screen_putc(cpos_t const x, cpos_t const y, uint32_t const ch, uint32_t const attr) {
+    return conio_screen_putc_ctx(&__conio_def, x, y, ch, attr);
+}
+
+/**
+ * @brief Same as @ref conio_screen_puts(cpos_t, cpos_t, char*, uint32_t), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_screen_puts_ctx(conio_term_t* term, cpos_t x, cpos_t const y, const char* str, uint32_t const attr) {
+    conio_cell_t* row;
+    cpos_t start;
+    int count = 0;
+    if (!str || y < 1 || y > term->scr.rows) return 0;
+
+    /* Skip the characters left of the buffer */
+    while (*str && x < 1) {
+        uint32_t cp;
+        str += __conio_utf8_decode(str, &cp);
+        x++;
+    }
+    row = term->scr.back + (size_t)(y - 1) * term->scr.cols;
+    for (start = x; *str && x <= term->scr.cols; x++, count++) {
+        uint32_t cp;
+        str += __conio_utf8_decode(str, &cp);
+        if (cp < 0x20 || cp == 0x7F) cp = ' ';
+        row[x - 1].ch = cp;
+        row[x - 1].attr = attr;
+    }
+    if (count > 0) __conio_scr_touch(&term->scr, y - 1, start - 1, x - 2);
+    return count;
+}
+
+/**
+ * @brief Puts a UTF-8 encoded string into the off-screen buffer.
+ *
+ * The string is written into a single row starting at the given cell, and is
+ * clipped at the right edge of the buffer. Control characters are stored as
+ * blanks.
+ *
+ * @param[in] x     The column of the first cell (1-based).
+ * @param[in] y     The row of the cells (1-based).
+ * @param[in] str   The string to put.
+ * @param[in] attr  The attributes of the characters.
+ * @return          Returns the number of cells written.
+ *
+ * @since 0.4.0
+ */
+int conio_screen_puts(cpos_t x, cpos_t const y, const char* str, uint32_t const attr) {
+    return conio_screen_puts_ctx(&__conio_def, x, y, str, attr);
+}
+
+/**
+ * @brief Returns the hash of a row of cells (64-bit FNV-1a on two lanes), never zero.
+ *
+ * @since 0.4.0
+ */
+static uint32_t __conio_scr_hash(const conio_cell_t* __row, cpos_t __n) {
+    uint64_t h = 14695981039346656037ULL, h2 = h ^ (uint64_t)__n;
+    uint32_t r;
+    cpos_t i;
+    /* One step per cell, on two independent lanes */
+    for (i = 0; i + 1 < __n; i += 2) {
+        h  = (h  ^ (__row[i].ch     | (uint64_t)__row[i].attr     << 32)) * 1099511628211ULL;
+        h2 = (h2 ^ (__row[i + 1].ch | (uint64_t)__row[i + 1].attr << 32)) * 1099511628211ULL;
+    }
+    if (i < __n) h = (h ^ (__row[i].ch | (uint64_t)__row[i].attr << 32)) * 1099511628211ULL;
+    h = (h ^ (h2 >> 29) ^ h2) * 1099511628211ULL;
+    r = (uint32_t)(h ^ (h >> 32));
+    return r ? r : 1;
+}
+
+/**
+ * @brief Estimates the number of bytes written to turn @p __front into @p __row,
+ *        or blank cells into @p __row if @p __front is `NULL`.
+ *
+ * Every changed cell counts one byte, and every run of changed cells a cursor movement.
+ *
+ * @since 0.4.0
+ */
+static long __conio_scr_cost(const conio_cell_t* __row, const conio_cell_t* __front, cpos_t __n) {
+    /* Typical length of the cursor movement before a run */
+    enum { MOVE_COST = 4 };
+    long n = 0;
+    int changed, prev = 0;
+    cpos_t i;
+    for (i = 0; i < __n; i++) {
+        if (__front) changed = ((__row[i].ch ^ __front[i].ch) | (__row[i].attr ^ __front[i].attr)) != 0;
+        else         changed = ((__row[i].ch ^ ' ') | (__row[i].attr ^ CONIO_ATTR_DEFAULT)) != 0;
+        n += changed + (changed & !prev) * MOVE_COST;
+        prev = changed;
+    }
+    return n;
+}
+
+/**
+ * @brief Scrolls a block of rows of the terminal to where the back buffer has moved it.
+ *
+ * Rows are compared by their hashes: the longest runs of back buffer rows found at
+ * another position of the front buffer are candidates, and the one that puts most
+ * changed rows in place is taken. If scrolling saves more output than the scroll
+ * costs, the rows between the old and the new position of the block are scrolled
+ * with `SU` or `SD` inside a scrolling region (`DECSTBM`) covering them exactly, and
+ * the front buffer is moved the same way, so that the remaining difference is small.
+ * A scroll moves whole lines of the terminal, so this is only done if the buffers are
+ * as wide as the terminal.
+ *
+ * @param[in,out] __x  The column of the cursor, set to 1 if the cursor was moved home.
+ * @param[in,out] __y  The row of the cursor, set to 1 if the cursor was moved home.
+ * @return             Returns 1 if the terminal was scrolled, 0 otherwise.
+ *
+ * @since 0.4.0
+ */
+static int __conio_scr_scroll(conio_term_t* __t, cpos_t* __x, cpos_t* __y) {
+    /* Bytes written for a scroll, at most: two scrolling regions and the scroll */
+    enum { SCROLL_COST = 24 };
+    struct __conio_scr_state* s = &__t->scr;
+    const size_t width = (size_t)s->cols;
+    cpos_t y, j, k, len, fixed, top, bottom, d, n, r;
+    cpos_t by = 0, bj = 0, blen = 0, bfixed = 0;
+    long gain = 0;
+    int region;
+    char* p;
+
+    if (s->tcols != s->cols || s->rows < 2) return 0;
+
+    /* Find the run of rows that puts most changed rows in place, starting from changed rows */
+    for (y = 0; y < s->rows; y++) {
+        if (s->bhash[y] == s->fhash[y]) continue;
+        for (j = 0; j < s->rows; j++) {
+            if (j == y || s->fhash[j] != s->bhash[y]) continue;
+            if (j - y == bj - by && y >= by && y < by + blen) continue;  /* Inside the best run */
+            for (k = 0; k < y && k < j && s->bhash[y - k - 1] == s->fhash[j - k - 1]; k++) {}
+            for (len = 0, fixed = 0; y - k + len < s->rows && j - k + len < s->rows
+                 && s->bhash[y - k + len] == s->fhash[j - k + len]; len++) {
+                if (s->bhash[y - k + len] != s->fhash[y - k + len]) fixed++;
+            }
+            if (fixed > bfixed) {
+                by = y - k; bj = j - k; blen = len; bfixed = fixed;
+            }
+        }
+    }
+    if (bfixed == 0) return 0;
+
+    /* Compare the output needed before and after the scroll */
+    d = bj - by;
+    top = (by < bj) ? by : bj;
+    bottom = ((by > bj) ? by : bj) + blen - 1;
+    for (r = top; r <= bottom; r++) {
+        /* Rows with equal hashes are taken as equal, it is an estimate */
+        if (r + d < top || r + d > bottom)
+            gain -= __conio_scr_cost(s->back + (size_t)r * width, NULL, s->cols);
+        else if (s->bhash[r] != s->fhash[r + d])
+            gain -= __conio_scr_cost(s->back + (size_t)r * width, s->front + (size_t)(r + d) * width, s->cols);
+    }
+    for (r = top; r <= bottom && gain <= SCROLL_COST; r++) {
+        if (s->bhash[r] != s->fhash[r])
+            gain += __conio_scr_cost(s->back + (size_t)r * width, s->front + (size_t)r * width, s->cols);
+    }
+    if (gain <= SCROLL_COST) return 0;
+    for (r = top; r <= bottom; r++) __conio_scr_touch(s, r, 0, s->cols - 1);
+
+    /* No region is needed if the terminal would scroll these rows anyway */
+    region = !(top == 0 && bottom + 1 == s->trows && __t->cur.bottom == 0);
+    if (region) __conio_out_region(__t, top + 1, bottom + 1);
+    p = __conio_out_reserve(__t, CONIO_ENC_MAX);
+    __conio_out_commit(__t, p, __conio_enc_csi1(p, d > 0 ? d : -d, 1, d > 0 ? 'S' : 'T'));
+    if (region) {
+        __conio_out_region(__t, __t->cur.top, __t->cur.bottom);
+        *__x = *__y = 1;
+    }
+
+    /* Move the rows of the front buffer like the terminal did */
+    n = bottom - top + 1 - (d > 0 ? d : -d);
+    if (d > 0) {
+        memmove(s->front + (size_t)top * width, s->front + (size_t)(top + d) * width,
+                (size_t)n * width * sizeof(conio_cell_t));
+        memmove(s->fhash + top, s->fhash + top + d, (size_t)n * sizeof(uint32_t));
+        r = top + n;
+    } else {
+        memmove(s->front + (size_t)(top - d) * width, s->front + (size_t)top * width,
+                (size_t)n * width * sizeof(conio_cell_t));
+        memmove(s->fhash + top - d, s->fhash + top, (size_t)n * sizeof(uint32_t));
+        r = top;
+        bottom = top - d - 1;
+    }
+    for (; r <= bottom; r++) {
+        conio_cell_t* row = s->front + (size_t)r * width;
+        for (y = 0; y < s->cols; y++) {
+            row[y].ch = ' ';
+            row[y].attr = CONIO_ATTR_DEFAULT;
+        }
+        s->fhash[r] = __conio_scr_hash(row, s->cols);
+    }
+    return 1;
+}
+
+/** Background color bits of the cell attributes, the only ones erased cells get. */
+#define __CONIO_ATTR_BG_MASK  ((uint32_t)0x1FF << 9)
+
+/**
+ * @brief Writes the cells @p __x to @p __end (exclusive) of a row of the off-screen buffer.
+ *
+ * Depending on the capabilities of the terminal, blanks are erased (`EL` up to the
+ * end of the line, when the rest of the row is blank, or `ECH`) and runs of the same
+ * character are repeated (`REP`) when that is shorter than writing them. Erasing
+ * does not move the cursor; it is moved again before the next cells.
+ *
+ * @param[in]     __y     The row (1-based).
+ * @param[in]     __tail  Index of the first cell of the blank end of the row, see @ref conio_present().
+ * @param[in,out] __attr  The attributes selected in the terminal.
+ * @param[in,out] __curx  The column of the cursor, zero if not known.
+ * @param[in,out] __cury  The row of the cursor, zero if not known.
+ * @return                The index of the cell after the last one written.
+ *
+ * @since 0.4.0
+ */
+static cpos_t __conio_scr_run(conio_term_t* __t, conio_cell_t* __back, conio_cell_t* __front,
+                              cpos_t __x, cpos_t __end, cpos_t __y, cpos_t __tail,
+                              uint32_t* __attr, cpos_t* __curx, cpos_t* __cury) {
+    /* Typical length of the cursor movement after erasing */
+    enum { MOVE_COST = 4 };
+    const cpos_t cols = __t->scr.cols;
+
+    while (__x < __end) {
+        const conio_cell_t cell = __back[__x];
+        const int blank = cell.ch == ' ' && !(cell.attr & ~__CONIO_ATTR_BG_MASK);
+        char utf8[4];
+        size_t len;
+        cpos_t n = 1, k;
+        int how = 0;  /* 0: literal, 1: EL, 2: ECH, 3: REP */
+
+        while (__x + n < __end && __back[__x + n].ch == cell.ch && __back[__x + n].attr == cell.attr) n++;
+        len = __conio_utf8_encode(cell.ch, utf8);
+        if (blank && (__t->caps & CONIO_CAP_EL) && __x >= __tail && cols - __x > 3) {
+            how = 1;
+            n = cols - __x;
+        } else if (blank && (__t->caps & CONIO_CAP_ECH) && (size_t)n > __conio_csi1_len(n, 1) + MOVE_COST) {
+            how = 2;
+        } else if ((__t->caps & CONIO_CAP_REP) && n > 1 && cell.ch >= 0x20 && cell.ch != 0x7F
+                   && (size_t)n * len > len + __conio_csi1_len(n - 1, 1)) {
+            how = 3;
+        }
+
+        if (*__cury != __y || *__curx != __x + 1)
+            __conio_out_move(__t, (*__curx <= cols) ? *__curx : 0, *__cury, __x + 1, __y, __front, *__attr);
+        *__cury = __y;
+        if (cell.attr != *__attr) {
+            char* p = __conio_out_reserve(__t, CONIO_ENC_MAX);
+            *__attr = cell.attr;
+            __conio_out_commit(__t, p, conio_enc_sgr(p, cell.attr));
+        }
+
+        if (how == 0) {
+            __conio_out_put(__t, utf8, len);
+            n = 1;
+            *__curx = __x + 2;
+        } else if (how == 1) {
+            __conio_out_put(__t, ESC "[K", 3);
+            *__curx = __x + 1;
+        } else {
+            char* p;
+            if (how == 3) __conio_out_put(__t, utf8, len);
+            p = __conio_out_reserve(__t, CONIO_ENC_MAX);
+            __conio_out_commit(__t, p, (how == 2) ? conio_enc_ech(p, n) : conio_enc_rep(p, n - 1));
+            *__curx = (how == 2) ? __x + 1 : __x + n + 1;
+        }
+        for (k = 0; k < n; k++) __front[__x + k] = cell;
+        __x += n;
+    }
+    return __x;
+}
+
+/**
+ * @brief Same as @ref conio_present(), on the given terminal context.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+int conio_present_ctx(conio_term_t* term) {
+    /* Maximum number of unchanged cells that are rewritten to join two runs */
+    enum { MERGE_GAP = 4 };
+    /* Maximum number of blocks of rows scrolled per frame */
+    enum { MAX_SCROLLS = 4 };
+    cpos_t x, y, curx = 0, cury = 0, first, last, tail;
+    uint32_t attr = CONIO_ATTR_DEFAULT;
+    uint64_t bits;
+    size_t w, words = ((size_t)term->scr.rows + 63) / 64;
+    int wrote = 0, i;
+
+    if (!term->scr.back) return -1;
+    if (term->cur.enabled && term->cur.valid) {
+        /* Start from the tracked position */
+        curx = term->cur.wrap ? 0 : term->cur.x;
+        cury = term->cur.y;
+    }
+
+    /* Only the rows written since the previous frame are looked at, the other rows
+     * of the back buffer still equal the front buffer and keep their hashes */
+    for (w = 0, i = 0; w < words; w++) {
+        for (bits = term->scr.dirty[w]; bits; bits &= bits - 1) {
+            const cpos_t r = (cpos_t)(w * 64 + __conio_ctz64(bits));
+            const size_t at = (size_t)r * term->scr.cols + term->scr.dmin[r];
+            if (term->scr.fhash[r]
+                && !__conio_row_span(term->scr.back + at, term->scr.front + at,
+                                     term->scr.dmax[r] - term->scr.dmin[r] + 1, &first, &last)) {
+                term->scr.bhash[r] = term->scr.fhash[r];  /* Rewritten with the same cells */
+                term->scr.dirty[w] &= ~((uint64_t)1 << (r & 63));
+            } else {
+                term->scr.bhash[r] = __conio_scr_hash(term->scr.back + (size_t)r * term->scr.cols, term->scr.cols);
+                i++;
+            }
+        }
+    }
+
+    /* Scroll the rows that have moved, then write what still differs */
+    if (i > 0) {
+        for (i = 0; i < MAX_SCROLLS && __conio_scr_scroll(term, &curx, &cury); i++) wrote = 1;
+    }
+
+    for (w = 0; w < words; w++) {
+        for (bits = term->scr.dirty[w]; bits; bits &= bits - 1) {
+            const cpos_t r = (cpos_t)(w * 64 + __conio_ctz64(bits));
+            conio_cell_t* back  = term->scr.back  + (size_t)r * term->scr.cols;
+            conio_cell_t* front = term->scr.front + (size_t)r * term->scr.cols;
+
+            /* Only the cells between the first and the last change are looked at */
+            y = r + 1;
+            term->scr.fhash[r] = term->scr.bhash[r];
+            if (!__conio_row_span(back + term->scr.dmin[r], front + term->scr.dmin[r],
+                                  term->scr.dmax[r] - term->scr.dmin[r] + 1, &first, &last))
+                continue;
+            first += term->scr.dmin[r];
+            last += term->scr.dmin[r];
+
+            /* The blank end of the row can be erased at once */
+            tail = term->scr.cols;
+            if ((term->caps & CONIO_CAP_EL) && back[tail - 1].ch == ' ') {
+                while (tail > 0 && back[tail - 1].ch == back[term->scr.cols - 1].ch
+                       && back[tail - 1].attr == back[term->scr.cols - 1].attr) tail--;
+            }
+            for (x = first; x <= last; x++) {
+                cpos_t end, gap;
+                if (back[x].ch == front[x].ch && back[x].attr == front[x].attr) continue;
+
+                /* Find the end of the run, joining runs separated by a short gap */
+                end = x + 1;
+                for (gap = 0; end + gap <= last && gap <= MERGE_GAP; ) {
+                    conio_cell_t* b = &back[end + gap];
+                    conio_cell_t* f = &front[end + gap];
+                    if (b->ch != f->ch || b->attr != f->attr) {
+                        end += gap + 1;
+                        gap = 0;
+                    } else {
+                        gap++;
+                    }
+                }
+
+                x = __conio_scr_run(term, back, front, x, end, y, tail, &attr, &curx, &cury);
+                wrote = 1;
+            }
+        }
+        term->scr.dirty[w] = 0;
+    }
+
+    if (attr != CONIO_ATTR_DEFAULT) __conio_out_put(term, ESC "[0m", 4);
+    if (wrote) {
+        /* The terminal defers the wrap after the last column */
+        if (curx > term->scr.cols) curx = term->scr.cols;
+        __conio_cur_set(term, curx, cury);
+    }
+    return __conio_out_flush(term);
+}
+
+/**
+ * @brief Writes the changes of the off-screen buffer to the terminal.
+ *
+ * Compares the off-screen buffer with the previously presented frame and writes
+ * only the runs of cells that differ, each preceded by a cursor movement and, when
+ * the attributes change, an `SGR` sequence. Runs on the same row separated by a few
+ * unchanged cells are merged, as rewriting these cells is shorter than moving the
+ * cursor. The whole update is written to the terminal at once.
+ *
+ * Runs of blanks and of the same character are shortened with the sequences the
+ * terminal supports, see @ref conio_setcaps().
+ *
+ * The off-screen buffer remembers which rows, and which columns of them, have been
+ * written since the previous frame. Only these cells are compared, so the cost of
+ * presenting depends on the amount of changes, not on the size of the screen.
+ * @ref conio_screen_clear() and @ref conio_screen_invalidate() mark every row.
+ *
+ * Rows that have moved up or down since the previous frame, for example the lines
+ * of a log view, are detected by comparing row hashes and scrolled by the terminal
+ * (`SU` or `SD`, inside a scrolling region if only a part of the screen moves), so
+ * only the rows that are really new are written. This requires the buffer to be as
+ * wide as the terminal.
+ *
+ * After presenting, the cursor is left after the last written cell and the
+ * attributes are reset to the defaults.
+ *
+ * @return Returns 0 on success, or -1 if there is no off-screen buffer or
+ *         writing to the terminal failed.
+ *
+ * @since 0.4.0
+ * @see   conio_screen_init(cpos_t, cpos_t)
+ */
+int conio_present(void) {
+    return conio_present_ctx(&__conio_def);
+}
+
+/**
+ * @brief Creates a terminal context on the given file descriptors.
+ *
+ * A context holds its own raw-mode session, output and input buffers, cursor
+ * model and off-screen buffer, so a single process can drive several terminals
+ * (for example one per pseudo terminal of a server) with the `_ctx` variants of
+ * the functions of this library. Contexts are independent of each other and of
+ * the default context used by the functions without the `_ctx` suffix.
  *
- * @since 0.2.0
- * @see   gotox(cpos_t)
- * @see   gotoxy(cpos_t, cpos_t)
+ * Example
+ * -------
+ * ```c
+ * conio_term_t* term = conio_term_new(master_fd, master_fd);
+ * conio_session_begin_ctx(term);
+ * gotoxy_ctx(term, 1, 1);
+ * cputs_ctx(term, "Hello");
+ * conio_term_free(term);
+ * ```
+ *
+ * @param[in] in_fd   The file descriptor the input is read from.
+ * @param[in] out_fd  The file descriptor the output is written to.
+ * @return            The new context, or `NULL` if out of memory.
+ *
+ * @note On Windows, the console functions always operate on the console of the
+ *       process; use a backend (see @ref conio_set_backend_ctx()) for anything else.
+ *
+ * @since 0.4.0
+ * @see   conio_term_free(conio_term_t*)
  */
-void gotoy(cpos_t const y) {
-    gotoxy(wherex(), y);
+conio_term_t* conio_term_new(int const in_fd, int const out_fd) {
+    conio_term_t* term = (conio_term_t*)calloc(1, sizeof(*term));
+    if (!term) return NULL;
+    term->in_fd = in_fd;
+    term->out_fd = out_fd;
+    term->caps = CONIO_CAP_DEFAULT;
+
+    /* Linked after the default context, so the exit handlers see it */
+    term->next = __conio_def.next;
+    __conio_def.next = term;
+    return term;
 }
 
+/**
+ * @brief Destroys a terminal context created by @ref conio_term_new().
+ *
+ * Flushes the pending output, ends the session (however deeply nested) and
+ * releases the buffers. The file descriptors are not closed. Passing the default
+ * context or `NULL` does nothing.
+ *
+ * @param[in] term  The terminal context.
+ *
+ * @since 0.4.0
+ */
+void conio_term_free(conio_term_t* term) {
+    conio_term_t** link;
+    if (!term || term == &__conio_def) return;
+
+#ifdef CONIO_HAVE_LOOP
+    if (term->srv.loop) conio_loop_remove_term(term->srv.loop, term);
+#endif  /* CONIO_HAVE_LOOP */
+    conio_flush_ctx(term);
+    if (term->sess.depth > 0) {
+        term->sess.depth = 1;
+        conio_session_end_ctx(term);
+    }
+    conio_screen_free_ctx(term);
+#ifndef __HAVE_WINDOWS_API
+    if (term->win.hooked) __conio_winch_unhook();
+#endif  /* ! __HAVE_WINDOWS_API */
+
+    for (link = &__conio_def.next; *link; link = &(*link)->next) {
+        if (*link == term) {
+            *link = term->next;
+            break;
+        }
+    }
+    free(term->out.data);
+    free(term->hist.slots);
+    free(term);
+}
 
 /**
- * @brief Clears the current line in the terminal.
+ * @brief Returns the default terminal context.
  *
- * This function clears the entire line where the cursor is currently positioned.
- * It is a cross-platform implementation that uses Windows API on Windows systems and
- * ANSI escape sequences on Unix-like systems.
+ * The default context uses the standard input and output, and is the one the
+ * functions without the `_ctx` suffix operate on.
  *
- * On Unix-like systems, this function uses ANSI escape sequences to manipulate the terminal.
- * The following sequences are used:
+ * @return The default terminal context.
  *
- * | Escape Sequence | Description                                 |
- * |-----------------|---------------------------------------------|
- * | `\033[2K`       | Clears the entire line                      |
+ * @since 0.4.0
+ */
+conio_term_t* conio_term_default(void) {
+    return &__conio_def;
+}
+
+/**
+ * @brief An in-memory terminal emulator, usable as a backend.
  *
- * - `\033` - is the escape character (ASCII code 27, see @ref ESC) used to start an escape sequence.
- * - `[2K` - is the control sequence for clearing the entire line.
- * - `\r` - moves the cursor back to the beginning of the line.
+ * The emulator interprets the output of this library (a VT100/xterm subset:
+ * cursor movement, erasing, scrolling regions, line insertion and deletion,
+ * `SGR` attributes and UTF-8 text) into a grid of cells, answers cursor position,
+ * device attributes, name and mode queries (`"\033[6n"`, `"\033[c"`, `"\033[>c"`,
+ * `"\033[>0q"`, `"\033[?2026$p"`) locally, and serves input queued with @ref conio_vterm_feed().
+ * A line feed also returns the cursor to the first column, like a terminal whose
+ * output is post-processed with `ONLCR`.
  *
- * @note  For Windows systems, the function uses [`SetConsoleCursorPosition`](https://learn.microsoft.com/en-us/windows/console/setconsolecursorposition)
- *        and [`FillConsoleOutputCharacter`](https://learn.microsoft.com/en-us/windows/console/fillconsoleoutputcharacter)
- *        to achieve the same functionality.
+ * Install it with `conio_set_backend(&vt.backend)`. The fields are read-only for
+ * the application; @ref x and @ref y hold the cursor position.
  *
- * @pre   Ensure the console supports ANSI escape sequences for Unix-specific implementation.
+ * @since 0.4.0
+ * @see   conio_vterm_init(conio_vterm_t*, cpos_t, cpos_t)
+ * @see   conio_set_backend(conio_backend_t*)
+ */
+typedef struct {
+    conio_backend_t backend;     /**< Backend interface, pass its address to `conio_set_backend()`. */
+    conio_cell_t*   cells;       /**< The cells, row by row. */
+    cpos_t          cols;        /**< Width of the screen. */
+    cpos_t          rows;        /**< Height of the screen. */
+    cpos_t          x;           /**< Cursor column (1-based). */
+    cpos_t          y;           /**< Cursor row (1-based). */
+    cpos_t          top;         /**< First row of the scrolling region. */
+    cpos_t          bottom;      /**< Last row of the scrolling region. */
+    cpos_t          saved_x;     /**< Column saved by `"\0337"` or `"\033[s"`. */
+    cpos_t          saved_y;     /**< Row saved by `"\0337"` or `"\033[s"`. */
+    int             wrap;        /**< Non-zero if the next character wraps to the next line. */
+    uint32_t        attr;        /**< Attributes of written characters. */
+    uint32_t        last;        /**< Last written character, repeated by `REP`. */
+    int             state;       /**< Escape sequence parser state. */
+    unsigned int    params[16];  /**< Parameters of the current control sequence. */
+    int             nparams;     /**< Number of parameters. */
+    int             priv;        /**< Private marker of the control sequence (`'?'` in `"\033[?..."`), zero if none. */
+    int             inter;       /**< Intermediate byte of the control sequence (`'$'` in `"\033[?2026$p"`), zero if none. */
+    int             sync;        /**< Non-zero while synchronized output (`"\033[?2026h"`) is set. */
+    uint32_t        cp;          /**< Code point of the UTF-8 character being decoded. */
+    int             cont;        /**< Number of pending UTF-8 continuation bytes. */
+    unsigned char*  in;          /**< Queued input. */
+    size_t          in_head;     /**< Index of the first unread input byte. */
+    size_t          in_len;      /**< Number of bytes in @ref in. */
+    size_t          in_cap;      /**< Allocated size of @ref in. */
+} conio_vterm_t;
+
+/** Parser states of the emulator. */
+enum { __CONIO_VT_GROUND, __CONIO_VT_ESC, __CONIO_VT_CSI, __CONIO_VT_OSC, __CONIO_VT_CHARSET };
+
+/**
+ * @brief Returns the cell at the given position, which must be on the screen.
  *
- * @since 0.3.0
- * @see   dellines(cpos_t, cpos_t)
+ * @since 0.4.0
  */
-void delline(void) {
-/* Windows-specific implementation */
-#ifdef __HAVE_WINDOWS_API
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-    DWORD dw;
+static conio_cell_t* __conio_vt_at(conio_vterm_t* __vt, cpos_t __x, cpos_t __y) {
+    return &__vt->cells[(size_t)(__y - 1) * __vt->cols + (__x - 1)];
+}
 
-    if (GetConsoleScreenBufferInfo(hConsole, &csbi)) {
-        COORD lineStart = { 0, csbi.dwCursorPosition.Y };  /* Start of the current line */
-        FillConsoleOutputCharacter(hConsole, ' ', csbi.dwSize.X, lineStart, &dw);  /* Clear the line */
-        SetConsoleCursorPosition(hConsole, lineStart);  /* Reset cursor to line start */
+/**
+ * @brief Blanks `__n` cells starting at the given position, using the current background.
+ *
+ * @since 0.4.0
+ */
+static void __conio_vt_blank(conio_vterm_t* __vt, cpos_t __x, cpos_t __y, size_t __n) {
+    conio_cell_t* c = __conio_vt_at(__vt, __x, __y);
+    uint32_t attr = __vt->attr & ((uint32_t)0x1FF << 9);
+    while (__n--) {
+        c->ch = ' ';
+        c->attr = attr;
+        c++;
     }
-#else
-    /* Unix-like systems using ANSI escape sequences */
-    printf("%s[2K\r", ESC);  /* Clear the line and reset cursor to the beginning */
-#endif  /* __HAVE_WINDOWS_API */
-    fflush(stdout);          /* Ensure immediate display */
 }
 
 /**
- * @brief Clears multiple lines in the terminal.
+ * @brief Scrolls rows `__top` to `__bottom` by `__n` lines, up if `__n` is positive, down otherwise.
  *
- * This function takes a range of line numbers (@p from and @p to) and clears
- * all lines in that range. The range is inclusive, meaning that both the
- * line at @p from and @p to are cleared. If @p from is greater than @p to,
- * the range is swapped internally to ensure that the correct lines are cleared.
+ * @since 0.4.0
+ */
+static void __conio_vt_scroll(conio_vterm_t* __vt, cpos_t __top, cpos_t __bottom, int __n) {
+    int height = __bottom - __top + 1;
+    int count = __n < 0 ? -__n : __n;
+    size_t w = (size_t)__vt->cols;
+
+    if (height <= 0 || count == 0) return;
+    if (count > height) count = height;
+    if (__n > 0) {
+        memmove(__conio_vt_at(__vt, 1, __top), __conio_vt_at(__vt, 1, (cpos_t)(__top + count)),
+                (size_t)(height - count) * w * sizeof(conio_cell_t));
+        __conio_vt_blank(__vt, 1, (cpos_t)(__bottom - count + 1), (size_t)count * w);
+    } else {
+        memmove(__conio_vt_at(__vt, 1, (cpos_t)(__top + count)), __conio_vt_at(__vt, 1, __top),
+                (size_t)(height - count) * w * sizeof(conio_cell_t));
+        __conio_vt_blank(__vt, 1, __top, (size_t)count * w);
+    }
+}
+
+/**
+ * @brief Moves the cursor down one line, scrolling at the bottom of the scrolling region.
  *
- * The function first saves the current Y-coordinate of the cursor position
- * and then moves the cursor to the first line in the range ( @p from ). It then
- * iterates through the range and clears each line by calling @ref delline().
- * After clearing the lines, the function resets the Y-coordinate of the cursor
- * to the original position.
+ * @since 0.4.0
+ */
+static void __conio_vt_linefeed(conio_vterm_t* __vt) {
+    if (__vt->y == __vt->bottom) __conio_vt_scroll(__vt, __vt->top, __vt->bottom, 1);
+    else if (__vt->y < __vt->rows) __vt->y++;
+    __vt->wrap = 0;
+}
+
+/**
+ * @brief Moves the cursor to the given position, clamped to the screen.
  *
- * @note
- * This function will behave the same as @ref clrscr() if @p from set to 0 and @p to
- * set to the returned value of @ref wherey(). However the cursor position will not be reset
- * and will remain at the original position, unlike @ref clrscr() where the cursor position
- * is reset to the top-left corner of the screen.
+ * @since 0.4.0
+ */
+static void __conio_vt_move(conio_vterm_t* __vt, int __x, int __y) {
+    if (__x < 1) __x = 1;
+    if (__y < 1) __y = 1;
+    if (__x > __vt->cols) __x = __vt->cols;
+    if (__y > __vt->rows) __y = __vt->rows;
+    __vt->x = (cpos_t)__x;
+    __vt->y = (cpos_t)__y;
+    __vt->wrap = 0;
+}
+
+/**
+ * @brief Writes a character at the cursor and advances it, with deferred wrapping.
  *
- * @param[in] from  The starting line number to clear.
- * @param[in] to    The ending line number to clear.
+ * @since 0.4.0
+ */
+static void __conio_vt_put(conio_vterm_t* __vt, uint32_t __cp) {
+    conio_cell_t* c;
+    if (__vt->wrap) {
+        __vt->x = 1;
+        __conio_vt_linefeed(__vt);
+    }
+    c = __conio_vt_at(__vt, __vt->x, __vt->y);
+    c->ch = __cp;
+    c->attr = __vt->attr;
+    __vt->last = __cp;
+    if (__vt->x == __vt->cols) __vt->wrap = 1;
+    else __vt->x++;
+}
+
+/**
+ * @brief Resets the emulator to its initial state and clears the screen.
  *
- * @pre   Ensure the console supports ANSI escape sequences for Unix-specific implementation.
+ * @since 0.4.0
+ */
+static void __conio_vt_reset(conio_vterm_t* __vt) {
+    __vt->attr = CONIO_ATTR_DEFAULT;
+    __vt->top = 1;
+    __vt->bottom = __vt->rows;
+    __vt->saved_x = __vt->saved_y = 1;
+    __vt->state = __CONIO_VT_GROUND;
+    __vt->cont = 0;
+    __vt->sync = 0;
+    __vt->last = ' ';
+    __conio_vt_blank(__vt, 1, 1, (size_t)__vt->cols * (size_t)__vt->rows);
+    __conio_vt_move(__vt, 1, 1);
+}
+
+/**
+ * @brief Applies the parameters of an `SGR` sequence to the current attributes.
  *
- * @since 0.3.0
- * @see   delline(void)
- * @see   gotoy(cpos_t)
+ * @since 0.4.0
  */
-void dellines(cpos_t from, cpos_t to) {
-    /* Ensure valid range */
-    if ((from < 0) || (to < 0)) {
-        fprintf(stderr,
-            "conio_lt: dellines: Position out of range (from: %d, to: %d)\n", from, to);
-        return;
+static void __conio_vt_sgr(conio_vterm_t* __vt) {
+    static const uint32_t styles[] = {
+        0, CONIO_ATTR_BOLD, CONIO_ATTR_DIM, CONIO_ATTR_ITALIC,
+        CONIO_ATTR_UNDERLINE, CONIO_ATTR_BLINK, 0, CONIO_ATTR_REVERSE
+    };
+    uint32_t const fg_mask = 0x1FF, bg_mask = (uint32_t)0x1FF << 9;
+    int i;
+
+    if (__vt->nparams == 0) __vt->attr = CONIO_ATTR_DEFAULT;
+    for (i = 0; i < __vt->nparams; i++) {
+        unsigned int p = __vt->params[i];
+        if (p == 0)                  __vt->attr = CONIO_ATTR_DEFAULT;
+        else if (p < 8)              __vt->attr |= styles[p];
+        else if (p == 22)            __vt->attr &= ~(CONIO_ATTR_BOLD | CONIO_ATTR_DIM);
+        else if (p >= 23 && p <= 27) __vt->attr &= ~styles[p - 20];
+        else if (p >= 30 && p <= 37) __vt->attr = (__vt->attr & ~fg_mask) | CONIO_FG(p - 30);
+        else if (p == 39)            __vt->attr &= ~fg_mask;
+        else if (p >= 40 && p <= 47) __vt->attr = (__vt->attr & ~bg_mask) | CONIO_BG(p - 40);
+        else if (p == 49)            __vt->attr &= ~bg_mask;
+        else if (p >= 90 && p <= 97)   __vt->attr = (__vt->attr & ~fg_mask) | CONIO_FG(p - 90 + 8);
+        else if (p >= 100 && p <= 107) __vt->attr = (__vt->attr & ~bg_mask) | CONIO_BG(p - 100 + 8);
+        else if ((p == 38 || p == 48) && i + 1 < __vt->nparams) {
+            if (__vt->params[i + 1] == 5 && i + 2 < __vt->nparams) {  /* 256 colors */
+                unsigned int n = __vt->params[i + 2];
+                __vt->attr = (p == 38) ? ((__vt->attr & ~fg_mask) | CONIO_FG(n))
+                                       : ((__vt->attr & ~bg_mask) | CONIO_BG(n));
+                i += 2;
+            } else if (__vt->params[i + 1] == 2) {  /* Direct colors are not supported */
+                i += 4;
+            }
+        }
     }
+}
 
-    /* Swap `from` and `to` if `from` is greater than `to` with XOR logic */
-    if (from > to) {
-        from ^= to; to ^= from; from ^= to;
+/**
+ * @brief Queues bytes as input, as if they had been typed on the terminal.
+ *
+ * @param[in] vt  The emulator.
+ * @param[in] s   The bytes to queue, e.g. `"q"` or `ESC "[A"`.
+ * @param[in] n   The number of bytes.
+ * @return        Returns 0 on success, or -1 on allocation failure.
+ *
+ * @since 0.4.0
+ */
+int conio_vterm_feed(conio_vterm_t* vt, const char* s, size_t n) {
+    if (vt->in_head > 0 && vt->in_head == vt->in_len) vt->in_head = vt->in_len = 0;
+    if (vt->in_len + n > vt->in_cap) {
+        size_t cap = vt->in_cap ? vt->in_cap : 64;
+        unsigned char* in;
+        while (cap < vt->in_len + n) cap *= 2;
+        in = (unsigned char*)realloc(vt->in, cap);
+        if (!in) return -1;
+        vt->in = in;
+        vt->in_cap = cap;
     }
+    memcpy(vt->in + vt->in_len, s, n);
+    vt->in_len += n;
+    return 0;
+}
 
-    /* Save the current Y-coordinate of cursor position */
-    cpos_t orig_y = wherey();
-    gotoy(from);  /* Move first the cursor to `from` line */
+/**
+ * @brief Queues the reply to a device status report request.
+ *
+ * @since 0.4.0
+ */
+static void __conio_vt_report(conio_vterm_t* __vt, unsigned int __what) {
+    char buf[CONIO_ENC_MAX];
+    size_t len = 2;
 
-    cpos_t i;
-    for (i = from; i <= to; i++) {
-        gotoy(i);  /* Move the cursor to `i` line */
-        /* Clear the current line and move the cursor to the start of the line */
-        delline();
+    buf[0] = '\033';
+    buf[1] = '[';
+    if (__what == 6) {  /* Cursor position report, "\033[{y};{x}R" */
+        len += __conio_enc_uint(buf + len, (unsigned int)__vt->y);
+        buf[len++] = ';';
+        len += __conio_enc_uint(buf + len, (unsigned int)__vt->x);
+        buf[len++] = 'R';
+    } else if (__what == 5) {  /* Status report, "\033[0n" */
+        buf[len++] = '0';
+        buf[len++] = 'n';
+    } else {
+        return;
     }
-    /* Reset the Y-coordinate of cursor after clearing lines */
-    gotoy(orig_y);
+    conio_vterm_feed(__vt, buf, len);
 }
 
+/**
+ * @brief Executes a private control sequence (`"\033[?..."`, `"\033[>..."`).
+ *
+ * Only synchronized output (mode 2026) is supported: it can be set, reset and
+ * queried with `DECRQM`. Queries for other modes are answered as not recognized.
+ * The secondary device attributes (`DA2`) and the name (`XTVERSION`) are reported.
+ *
+ * @since 0.4.0
+ */
+static void __conio_vt_private(conio_vterm_t* __vt, unsigned char __final) {
+    unsigned int mode = __vt->nparams > 0 ? __vt->params[0] : 0;
+    char buf[CONIO_ENC_MAX];
+    size_t len = 3;
+
+    if (__vt->priv == '>') {
+        if (__final == 'c' && mode == 0 && !__vt->inter)       /* A VT220, firmware version 10 */
+            conio_vterm_feed(__vt, "\033[>1;10;0c", 10);
+        else if (__final == 'q' && mode == 0 && !__vt->inter)  /* "\033P>|{name}\033\\" */
+            conio_vterm_feed(__vt, "\033P>|conio_vterm\033\\", 17);
+        return;
+    }
+    if (__vt->priv != '?') return;
+    if ((__final == 'h' || __final == 'l') && !__vt->inter) {
+        if (mode == 2026) __vt->sync = (__final == 'h');
+    } else if (__final == 'p' && __vt->inter == '$') {  /* "\033[?{mode};{Ps}$y" */
+        memcpy(buf, "\033[?", 3);
+        len += __conio_enc_uint(buf + len, mode);
+        buf[len++] = ';';
+        buf[len++] = (mode == 2026) ? (__vt->sync ? '1' : '2') : '0';
+        buf[len++] = '$';
+        buf[len++] = 'y';
+        conio_vterm_feed(__vt, buf, len);
+    }
+}
 
 /**
- * @brief Outputs a string to the standard output and ensures immediate display.
+ * @brief Executes the control sequence that ends with the given final byte.
  *
- * This function takes a string as input and writes it to the standard output.
- * After writing the string, it flushes the output buffer to ensure that the
- * string is displayed immediately. If the input string is `NULL` or if there
- * is an error during writing, the function returns `NULL`.
+ * @since 0.4.0
+ */
+static void __conio_vt_csi(conio_vterm_t* __vt, unsigned char __final) {
+    unsigned int* p = __vt->params;
+    int n = (__vt->nparams > 0 && p[0] > 0) ? (int)p[0] : 1;  /* First parameter, default 1 */
+    size_t w = (size_t)__vt->cols;
+
+    if (__vt->priv) {  /* Private modes do not affect the screen content */
+        __conio_vt_private(__vt, __final);
+        return;
+    }
+    if (__vt->inter) return;  /* Not supported, ignored */
+
+    switch (__final) {
+    case 'A': __conio_vt_move(__vt, __vt->x, __vt->y - n); break;
+    case 'B': __conio_vt_move(__vt, __vt->x, __vt->y + n); break;
+    case 'C': __conio_vt_move(__vt, __vt->x + n, __vt->y); break;
+    case 'D': __conio_vt_move(__vt, __vt->x - n, __vt->y); break;
+    case 'E': __conio_vt_move(__vt, 1, __vt->y + n); break;
+    case 'F': __conio_vt_move(__vt, 1, __vt->y - n); break;
+    case 'G': case '`': __conio_vt_move(__vt, n, __vt->y); break;
+    case 'd': __conio_vt_move(__vt, __vt->x, n); break;
+    case 'H': case 'f':
+        __conio_vt_move(__vt, (__vt->nparams > 1 && p[1] > 0) ? (int)p[1] : 1, n);
+        break;
+    case 'J': {
+        size_t pos = (size_t)(__vt->y - 1) * w + (size_t)(__vt->x - 1);
+        size_t all = w * (size_t)__vt->rows;
+        unsigned int mode = __vt->nparams > 0 ? p[0] : 0;
+        if (mode == 0)      __conio_vt_blank(__vt, __vt->x, __vt->y, all - pos);
+        else if (mode == 1) __conio_vt_blank(__vt, 1, 1, pos + 1);
+        else if (mode == 2 || mode == 3) __conio_vt_blank(__vt, 1, 1, all);
+        break;
+    }
+    case 'K': {
+        unsigned int mode = __vt->nparams > 0 ? p[0] : 0;
+        if (mode == 0)      __conio_vt_blank(__vt, __vt->x, __vt->y, w - (size_t)(__vt->x - 1));
+        else if (mode == 1) __conio_vt_blank(__vt, 1, __vt->y, (size_t)__vt->x);
+        else if (mode == 2) __conio_vt_blank(__vt, 1, __vt->y, w);
+        break;
+    }
+    case 'L': case 'M':
+        if (__vt->y >= __vt->top && __vt->y <= __vt->bottom) {
+            __conio_vt_scroll(__vt, __vt->y, __vt->bottom, __final == 'M' ? n : -n);
+            __conio_vt_move(__vt, 1, __vt->y);
+        }
+        break;
+    case 'S': __conio_vt_scroll(__vt, __vt->top, __vt->bottom, n); break;
+    case 'T': __conio_vt_scroll(__vt, __vt->top, __vt->bottom, -n); break;
+    case '@': case 'P': {
+        conio_cell_t* c = __conio_vt_at(__vt, __vt->x, __vt->y);
+        size_t rest = w - (size_t)(__vt->x - 1);
+        size_t k = (size_t)n < rest ? (size_t)n : rest;
+        if (__final == 'P') {
+            memmove(c, c + k, (rest - k) * sizeof(conio_cell_t));
+            __conio_vt_blank(__vt, (cpos_t)(__vt->cols - k + 1), __vt->y, k);
+        } else {
+            memmove(c + k, c, (rest - k) * sizeof(conio_cell_t));
+            __conio_vt_blank(__vt, __vt->x, __vt->y, k);
+        }
+        __vt->wrap = 0;
+        break;
+    }
+    case 'X': {
+        size_t rest = w - (size_t)(__vt->x - 1);
+        __conio_vt_blank(__vt, __vt->x, __vt->y, (size_t)n < rest ? (size_t)n : rest);
+        break;
+    }
+    case 'b':
+        while (n-- > 0) __conio_vt_put(__vt, __vt->last);
+        break;
+    case 'm': __conio_vt_sgr(__vt); break;
+    case 'c':  /* Device attributes, a VT220 with ANSI colors */
+        if (__vt->nparams == 0 || p[0] == 0) conio_vterm_feed(__vt, "\033[?62;22c", 9);
+        break;
+    case 'n': __conio_vt_report(__vt, __vt->nparams > 0 ? p[0] : 0); break;
+    case 'r': {
+        int top = n, bottom = (__vt->nparams > 1 && p[1] > 0) ? (int)p[1] : __vt->rows;
+        if (bottom > __vt->rows) bottom = __vt->rows;
+        if (top < bottom) {
+            __vt->top = (cpos_t)top;
+            __vt->bottom = (cpos_t)bottom;
+            __conio_vt_move(__vt, 1, 1);
+        }
+        break;
+    }
+    case 's': __vt->saved_x = __vt->x; __vt->saved_y = __vt->y; break;
+    case 'u': __conio_vt_move(__vt, __vt->saved_x, __vt->saved_y); break;
+    default: break;  /* Not supported, ignored */
+    }
+}
+
+/**
+ * @brief Interprets output bytes as a terminal does.
  *
- * @param[in] str  The string to be written to the standard output.
- * @return         Returns the input string on success, or NULL on failure.
+ * Sequences may be split across calls. Unsupported sequences are ignored.
  *
- * @pre     The input string must not be `NULL` before calling this function.
+ * @param[in] vt  The emulator.
+ * @param[in] s   The bytes written to the terminal.
+ * @param[in] n   The number of bytes.
  *
- * @since   0.3.0
+ * @since 0.4.0
+ * @see   conio_vterm_t
  */
-const char* cputs(char* const str) {
-    if (!str) return NULL;                      /* Handle null input */
-    if (fputs(str, stdout) == EOF) return NULL; /* Print string and check for errors */
-    fflush(stdout);                             /* Ensure the output is flushed immediately */
-    return str;
+void conio_vterm_write(conio_vterm_t* vt, const char* s, size_t n) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)s[i];
+
+        switch (vt->state) {
+        case __CONIO_VT_ESC:
+            vt->state = __CONIO_VT_GROUND;
+            switch (c) {
+            case '[':
+                vt->state = __CONIO_VT_CSI;
+                vt->nparams = vt->priv = vt->inter = 0;
+                vt->params[0] = 0;
+                break;
+            case ']': vt->state = __CONIO_VT_OSC; break;
+            case '(': case ')': vt->state = __CONIO_VT_CHARSET; break;
+            case 'c': __conio_vt_reset(vt); break;
+            case '7': vt->saved_x = vt->x; vt->saved_y = vt->y; break;
+            case '8': __conio_vt_move(vt, vt->saved_x, vt->saved_y); break;
+            case 'D': __conio_vt_linefeed(vt); break;
+            case 'E': vt->x = 1; __conio_vt_linefeed(vt); break;
+            case 'M':
+                if (vt->y == vt->top) __conio_vt_scroll(vt, vt->top, vt->bottom, -1);
+                else if (vt->y > 1) vt->y--;
+                vt->wrap = 0;
+                break;
+            default: break;
+            }
+            continue;
+        case __CONIO_VT_CSI:
+            if (c >= '0' && c <= '9') {
+                if (vt->nparams == 0) vt->nparams = 1;
+                if (vt->nparams <= 16)
+                    vt->params[vt->nparams - 1] = vt->params[vt->nparams - 1] * 10 + (c - '0');
+            } else if (c == ';') {
+                vt->nparams = (vt->nparams == 0) ? 2 : vt->nparams + 1;
+                if (vt->nparams <= 16) vt->params[vt->nparams - 1] = 0;
+            } else if (c >= 0x3C && c <= 0x3F) {
+                vt->priv = c;
+            } else if (c >= 0x20 && c <= 0x2F) {
+                vt->inter = c;
+            } else if (c >= 0x40 && c <= 0x7E) {
+                if (vt->nparams > 16) vt->nparams = 16;
+                vt->state = __CONIO_VT_GROUND;
+                __conio_vt_csi(vt, c);
+            } else if (c == 0x1B) {
+                vt->state = __CONIO_VT_ESC;
+            }
+            continue;
+        case __CONIO_VT_OSC:  /* Skipped until BEL or ST */
+            if (c == 0x07) vt->state = __CONIO_VT_GROUND;
+            else if (c == 0x1B) vt->state = __CONIO_VT_ESC;
+            continue;
+        case __CONIO_VT_CHARSET:
+            vt->state = __CONIO_VT_GROUND;
+            continue;
+        default:
+            break;
+        }
+
+        /* Continuation of a UTF-8 encoded character */
+        if (vt->cont > 0) {
+            if ((c & 0xC0) == 0x80) {
+                vt->cp = (vt->cp << 6) | (c & 0x3F);
+                if (--vt->cont == 0) __conio_vt_put(vt, vt->cp);
+                continue;
+            }
+            vt->cont = 0;
+            __conio_vt_put(vt, 0xFFFD);
+        }
+
+        switch (c) {
+        case 0x1B: vt->state = __CONIO_VT_ESC; break;
+        case '\r': vt->x = 1; vt->wrap = 0; break;
+        case '\n': case '\v': case '\f':
+            vt->x = 1;
+            __conio_vt_linefeed(vt);
+            break;
+        case '\b':
+            if (vt->x > 1) vt->x--;
+            vt->wrap = 0;
+            break;
+        case '\t':
+            __conio_vt_move(vt, ((vt->x - 1) / 8 + 1) * 8 + 1, vt->y);
+            break;
+        default:
+            if (c < 0x20 || c == 0x7F) break;  /* Other control characters */
+            if (c < 0x80)                 __conio_vt_put(vt, c);
+            else if ((c & 0xE0) == 0xC0) { vt->cp = c & 0x1F; vt->cont = 1; }
+            else if ((c & 0xF0) == 0xE0) { vt->cp = c & 0x0F; vt->cont = 2; }
+            else if ((c & 0xF8) == 0xF0) { vt->cp = c & 0x07; vt->cont = 3; }
+            else                          __conio_vt_put(vt, 0xFFFD);
+            break;
+        }
+    }
+}
+
+/** @ref conio_backend::output of the emulator. */
+static int __conio_vt_be_write(conio_backend_t* __be, const char* __s, size_t __n) {
+    conio_vterm_write((conio_vterm_t*)__be, __s, __n);
+    return 0;
+}
+
+/** @ref conio_backend::input of the emulator, there is never more input than what has been queued. */
+static int __conio_vt_be_read(conio_backend_t* __be, unsigned char* __buf, size_t __n, int __timeout_ms) {
+    conio_vterm_t* vt = (conio_vterm_t*)__be;
+    size_t avail = vt->in_len - vt->in_head;
+
+    if (avail == 0) return (__timeout_ms >= 0) ? 0 : -1;
+    if (__n > avail) __n = avail;
+    memcpy(__buf, vt->in + vt->in_head, __n);
+    vt->in_head += __n;
+    return (int)__n;
+}
+
+/** @ref conio_backend::getsize of the emulator. */
+static int __conio_vt_be_getsize(conio_backend_t* __be, cpos_t* __cols, cpos_t* __rows) {
+    conio_vterm_t* vt = (conio_vterm_t*)__be;
+    *__cols = vt->cols;
+    *__rows = vt->rows;
+    return 0;
 }
 
 /**
- * @brief Reads a string from the standard input into the provided buffer.
+ * @brief Initializes an in-memory terminal with a blank screen.
  *
- * This function reads a line of text from the standard input and stores it in
- * the provided buffer. The buffer must have its first byte set to the maximum
- * number of characters (including the null terminator) that can be read.
- * The function reads at most this number minus one characters, leaving space
- * for the null terminator. If a newline character is read, it is replaced with
- * a null terminator.
+ * Example
+ * -------
+ * ```c
+ * conio_vterm_t vt;
+ * char line[81];
+ * conio_vterm_init(&vt, 80, 24);
+ * conio_set_backend(&vt.backend);
+ * clrscr();
+ * gotoxy(1, 1); cputs("Status: OK");
+ * conio_vterm_row(&vt, 1, line, sizeof(line));
+ * assert(strcmp(line, "Status: OK") == 0);
+ * ```
  *
- * @param[in,out] buffer A pointer to the buffer where the input string will
- *                       be stored. The first byte should be set to the maximum
- *                       length of the input string (including null terminator).
- * @return               A pointer to the buffer containing the input string, or `NULL` if the
- *                       buffer is `NULL` or if an error occurs while reading input.
+ * @param[out] vt    The emulator to initialize.
+ * @param[in]  cols  The width of the screen.
+ * @param[in]  rows  The height of the screen.
+ * @return           Returns 0 on success, or -1 if the size is invalid or on allocation failure.
  *
- * @warning     Ensure that the buffer is not `NULL` and that its first byte is
- *              correctly set before calling this function.
+ * @since 0.4.0
+ * @see   conio_vterm_free(conio_vterm_t*)
+ * @see   conio_set_backend(conio_backend_t*)
+ */
+int conio_vterm_init(conio_vterm_t* vt, cpos_t const cols, cpos_t const rows) {
+    memset(vt, 0, sizeof(*vt));
+    if (cols <= 0 || rows <= 0) return -1;
+    vt->cells = (conio_cell_t*)malloc((size_t)cols * (size_t)rows * sizeof(conio_cell_t));
+    if (!vt->cells) return -1;
+
+    vt->backend.output = __conio_vt_be_write;
+    vt->backend.input = __conio_vt_be_read;
+    vt->backend.getsize = __conio_vt_be_getsize;
+    vt->cols = cols;
+    vt->rows = rows;
+    __conio_vt_reset(vt);
+    return 0;
+}
+
+/**
+ * @brief Releases the memory of an in-memory terminal.
  *
- * @since       0.3.0
+ * The emulator must not be installed as the backend anymore.
+ *
+ * @param[in] vt  The emulator.
+ *
+ * @since 0.4.0
  */
-char* cgets(char* buffer) {
-    if (!buffer) return NULL;  /* Handle null buffer */
-    int maxLength = (unsigned char)buffer[0];  /* Maximum length is stored in the first byte */
-    if (fgets(buffer, maxLength, stdin) == NULL) return NULL;
-    /* Remove trailing newline if present */
-    char* newline = buffer + 1;
-    while (*newline && *newline != '\n') newline++;
-    *newline = '\0';  /* Null-terminate the string */
-    return buffer;
+void conio_vterm_free(conio_vterm_t* vt) {
+    free(vt->cells);
+    free(vt->in);
+    memset(vt, 0, sizeof(*vt));
 }
 
 /**
- * @brief Reads input from the standard input according to the given format.
+ * @brief Returns a cell of the in-memory terminal.
  *
- * This function reads formatted input from the standard input and assigns it
- * to the variables in the argument list. The function returns the number of
- * input items assigned, which may be less than the number of arguments provided
- * if the format string is not fully satisfied.
+ * @param[in] vt  The emulator.
+ * @param[in] x   The column (1-based).
+ * @param[in] y   The row (1-based).
+ * @return        The cell, or `NULL` if the position is outside of the screen.
  *
- * @param[in] fmt   A pointer to a format string that specifies how the input
- *                  should be interpreted.
- * @param[in] ...   A variable number of arguments to which the input values will
- *                  be assigned.
- * @return          The number of input items assigned, which may be less than the number
- *                  of arguments provided if the format string is not fully satisfied.
+ * @since 0.4.0
+ */
+const conio_cell_t* conio_vterm_cell(conio_vterm_t* vt, cpos_t const x, cpos_t const y) {
+    if (x < 1 || y < 1 || x > vt->cols || y > vt->rows) return NULL;
+    return __conio_vt_at(vt, x, y);
+}
+
+/**
+ * @brief Retrieves the text of a row of the in-memory terminal.
  *
- * @warning     Ensure that the format string is well-formed and the arguments are
- *              correct, or the behavior is undefined.
+ * The characters are encoded as UTF-8 and trailing blanks are removed, which
+ * makes the result convenient to compare against expected screen content.
  *
- * @since       0.3.0
+ * @param[in]  vt    The emulator.
+ * @param[in]  y     The row (1-based).
+ * @param[out] buf   The buffer that receives the null-terminated text.
+ * @param[in]  size  The size of @p buf, the text is truncated to fit.
+ * @return           The length of the text, or 0 if the row is outside of the screen.
+ *
+ * @since 0.4.0
  */
-int cscanf(char* const fmt, ...) {
-    va_list args;
-    va_start(args, fmt);  /* Initialize variable argument list */
-    int result = vscanf(fmt, args);  /* Use `vscanf` for variable arguments */
-    /* Exclude the last character (newline) from input buffer */
-    int ch;
-    while ((ch = getchar()) != '\n' && ch != EOF);
-    va_end(args);  /* Clean up variable argument list */
-    return result;
+size_t conio_vterm_row(conio_vterm_t* vt, cpos_t const y, char* buf, size_t const size) {
+    size_t len = 0, end = 0;
+    cpos_t x;
+
+    if (size == 0) return 0;
+    buf[0] = '\0';
+    if (y < 1 || y > vt->rows) return 0;
+
+    for (x = 1; x <= vt->cols; x++) {
+        char utf8[4];
+        size_t n = __conio_utf8_encode(__conio_vt_at(vt, x, y)->ch, utf8);
+        if (len + n >= size) break;
+        memcpy(buf + len, utf8, n);
+        len += n;
+        if (utf8[0] != ' ' || n > 1) end = len;
+    }
+    buf[end] = '\0';
+    return end;
 }
 
 _CONIO_END_C_DECLS_
 
+#ifdef __cplusplus
+/**
+ * @brief Scope guard for the raw-mode session in C++.
+ *
+ * Calls @ref conio_session_begin() on construction and @ref conio_session_end()
+ * on destruction, so the terminal is restored even if the scope is left by an
+ * exception.
+ *
+ * Example
+ * -------
+ * ```cpp
+ * {
+ *     conio_session_guard guard;
+ *     int c = getch();
+ * }  // terminal restored here
+ * ```
+ *
+ * @since 0.4.0
+ */
+class conio_session_guard {
+public:
+    conio_session_guard() : __ok(conio_session_begin() == 0) {}
+    ~conio_session_guard() { if (__ok) conio_session_end(); }
+
+    /** Returns `true` if the session has been started successfully. */
+    bool ok() const { return __ok; }
+
+private:
+    bool __ok;
+
+    /* Non-copyable */
+    conio_session_guard(const conio_session_guard&);
+    conio_session_guard& operator=(const conio_session_guard&);
+};
+#endif  /* __cplusplus */
+
 
 #undef __UNIX_PLATFORM
 #undef __UNIX_PLATFORM_ANDRO
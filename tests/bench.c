@@ -0,0 +1,309 @@
+/**
+ * @file bench.c
+ *
+ * @brief Unattended benchmark of the `conio_lt` APIs on a pseudo terminal.
+ *
+ * Every scenario runs in a child process whose standard input and output are
+ * the slave side of a new pseudo terminal (`openpty()`). This process plays the
+ * terminal on the master side: it answers cursor position queries (`"\033[6n"`)
+ * with a scripted reply, feeds keystrokes and drains the output. For each
+ * scenario the time, the number of system calls and the number of bytes written
+ * per operation are reported. System calls are counted by redirecting the calls
+ * made by `conio_lt.h` to counting wrappers.
+ *
+ * Build and run (on Linux):
+ * ```
+ * cc -O2 -o bench tests/bench.c -lutil
+ * ./bench           # all scenarios
+ * ./bench wherexy   # scenarios whose name contains "wherexy"
+ * ```
+ */
+
+/* The system headers come before conio_lt.h, whose calls are wrapped below */
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <termios.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <pty.h>
+#include <utmp.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+
+/* Counters of the calls made by the library */
+static unsigned long bench_syscalls;
+static unsigned long bench_bytes;
+
+static ssize_t bench_read(int fd, void* buf, size_t n) {
+    bench_syscalls++;
+    return read(fd, buf, n);
+}
+
+static ssize_t bench_write(int fd, const void* buf, size_t n) {
+    ssize_t w;
+    bench_syscalls++;
+    w = write(fd, buf, n);
+    if (w > 0) bench_bytes += (unsigned long)w;
+    return w;
+}
+
+static int bench_poll(struct pollfd* fds, nfds_t n, int timeout) {
+    bench_syscalls++;
+    return poll(fds, n, timeout);
+}
+
+static int bench_tcgetattr(int fd, struct termios* t) {
+    bench_syscalls++;
+    return tcgetattr(fd, t);
+}
+
+static int bench_tcsetattr(int fd, int act, const struct termios* t) {
+    bench_syscalls++;
+    return tcsetattr(fd, act, t);
+}
+
+static int bench_ioctl(int fd, unsigned long req, void* arg) {
+    bench_syscalls++;
+    return ioctl(fd, req, arg);
+}
+
+static int bench_sigaction(int sig, const struct sigaction* act, struct sigaction* old) {
+    bench_syscalls++;
+    return sigaction(sig, act, old);
+}
+
+#define read(fd, buf, n)            bench_read(fd, buf, n)
+#define write(fd, buf, n)           bench_write(fd, buf, n)
+#define poll(fds, n, timeout)       bench_poll(fds, n, timeout)
+#define tcgetattr(fd, t)            bench_tcgetattr(fd, t)
+#define tcsetattr(fd, act, t)       bench_tcsetattr(fd, act, t)
+#define ioctl(fd, req, arg)         bench_ioctl(fd, req, arg)
+#define sigaction(sig, act, old)    bench_sigaction(sig, act, old)
+#include "../conio_lt.h"
+#undef read
+#undef write
+#undef poll
+#undef tcgetattr
+#undef tcsetattr
+#undef ioctl
+#undef sigaction
+
+/** Reply of the simulated terminal to a cursor position query. */
+#define BENCH_CPR  "\033[12;34R"
+
+/** Describes a benchmark scenario. */
+typedef struct {
+    const char* name;      /**< Name of the scenario. */
+    long        iters;     /**< Number of timed operations. */
+    int         feed;      /**< Number of keystrokes fed to the scenario per operation. */
+    void      (*setup)(void);
+    void      (*op)(long i);
+} bench_t;
+
+/** Result sent by the child process. */
+typedef struct {
+    long          iters;
+    double        ns;
+    unsigned long syscalls;
+    unsigned long bytes;
+} bench_result_t;
+
+static void setup_none(void)    { }
+static void setup_session(void) { conio_session_begin(); }
+static void setup_track(void)   { conio_cursor_track(1); }
+static void setup_screen(void)  { conio_screen_init(0, 0); }
+
+static void op_gotoxy(long i)   { gotoxy((cpos_t)(i % 80 + 1), (cpos_t)(i % 24 + 1)); }
+static void op_wherexy(long i)  { cpos_t x, y; (void)i; wherexy(&x, &y); }
+static void op_getch(long i)    { (void)i; getch(); }
+static void op_kbhit(long i)    { (void)i; kbhit(); }
+static void op_paste(long i)    { int k; (void)i; for (k = 0; k < 10240; k++) getch(); }
+static void op_cputs(long i)    { static char s[] = "CPU: 42%  MEM: 17%"; (void)i; cputs(s); }
+static void op_clrscr(long i)   { (void)i; clrscr(); }
+static void op_dellines(long i) { (void)i; dellines(2, 6); }
+static void op_getsize(long i)  { cpos_t c, r; (void)i; conio_getsize(&c, &r); }
+
+/* A log view: every frame, the lines move up by one and a new line is added */
+static void op_present_log(long i) {
+    char line[48];
+    cpos_t y;
+    for (y = 1; y <= 24; y++) {
+        snprintf(line, sizeof(line), "%08ld  GET /index.html 200", i + y);
+        conio_screen_puts(1, y, line, CONIO_ATTR_DEFAULT);
+    }
+    conio_present();
+}
+
+/* A dashboard: a few counters change every frame */
+static void op_present_counters(long i) {
+    char value[16];
+    cpos_t y;
+    for (y = 2; y <= 20; y += 6) {
+        snprintf(value, sizeof(value), "%8ld", i * y);
+        conio_screen_puts(40, y, value, CONIO_FG(2));
+    }
+    conio_present();
+}
+
+static const bench_t benches[] = {
+    { "gotoxy",             200000, 0, setup_none,    op_gotoxy   },
+    { "gotoxy (tracked)",   200000, 0, setup_track,   op_gotoxy   },
+    { "wherexy",              5000, 0, setup_none,    op_wherexy  },
+    { "wherexy (session)",    5000, 0, setup_session, op_wherexy  },
+    { "wherexy (tracked)",  200000, 0, setup_track,   op_wherexy  },
+    { "getch",              100000, 1, setup_none,    op_getch    },
+    { "getch (session)",    100000, 1, setup_session, op_getch    },
+    { "paste (10 KB)",         200, 10240, setup_none, op_paste  },
+    { "kbhit",              100000, 0, setup_none,    op_kbhit    },
+    { "kbhit (session)",    100000, 0, setup_session, op_kbhit    },
+    { "cputs",              200000, 0, setup_none,    op_cputs    },
+    { "clrscr",             200000, 0, setup_none,    op_clrscr   },
+    { "dellines",            50000, 0, setup_none,    op_dellines },
+    { "dellines (tracked)",  50000, 0, setup_track,   op_dellines },
+    { "getsize",            200000, 0, setup_none,    op_getsize  },
+    { "present (log)",       50000, 0, setup_screen,  op_present_log },
+    { "present (counters)", 200000, 0, setup_screen,  op_present_counters }
+};
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Runs a scenario on the terminal, in the child process */
+static void run_child(const bench_t* b, int out) {
+    bench_result_t res;
+    long i, warmup = b->iters / 10;
+    double start;
+
+    b->setup();
+    for (i = 0; i < warmup; i++) b->op(i);
+
+    bench_syscalls = bench_bytes = 0;
+    start = now_ns();
+    for (i = 0; i < b->iters; i++) b->op(i);
+    res.ns = now_ns() - start;
+    res.syscalls = bench_syscalls;
+    res.bytes = bench_bytes;
+    res.iters = b->iters;
+
+    conio_session_end();
+    if (write(out, &res, sizeof(res)) != (ssize_t)sizeof(res)) _exit(1);
+    _exit(0);
+}
+
+/* Plays the terminal until the child reports its result */
+static int serve(const bench_t* b, int master, int in, bench_result_t* res) {
+    static const char query[] = "\033[6n";
+    char line[64];
+    size_t matched = 0, fed = 0, got = 0;
+    size_t tofeed = b->feed ? (size_t)b->feed * (size_t)(b->iters + b->iters / 10) + 64 : 0;
+
+    /* Keystrokes are fed as short lines, so they also fit into the canonical mode buffer */
+    memset(line, 'a', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\n';
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    while (got < sizeof(*res)) {
+        struct pollfd pfd[2];
+        char buf[4096];
+        ssize_t n, i;
+
+        pfd[0].fd = master;
+        pfd[0].events = POLLIN | (fed < tofeed ? POLLOUT : 0);
+        pfd[1].fd = in;
+        pfd[1].events = POLLIN;
+        pfd[0].revents = pfd[1].revents = 0;
+        if (poll(pfd, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        if (pfd[0].revents & POLLIN) {
+            n = read(master, buf, sizeof(buf));
+            for (i = 0; i < n; i++) {
+                matched = (buf[i] == query[matched]) ? matched + 1 : (buf[i] == query[0]);
+                if (matched == sizeof(query) - 1) {
+                    matched = 0;
+                    if (write(master, BENCH_CPR, sizeof(BENCH_CPR) - 1) < 0) return -1;
+                }
+            }
+        }
+        if ((pfd[0].revents & POLLOUT) && fed < tofeed) {
+            size_t chunk = tofeed - fed < sizeof(line) ? tofeed - fed : sizeof(line);
+            n = write(master, line + sizeof(line) - chunk, chunk);
+            if (n > 0) fed += (size_t)n;
+        }
+        if (pfd[1].revents & (POLLIN | POLLHUP)) {
+            n = read(in, (char*)res + got, sizeof(*res) - got);
+            if (n <= 0) return -1;
+            got += (size_t)n;
+        }
+    }
+    return 0;
+}
+
+static int run(const bench_t* b) {
+    struct winsize ws;
+    bench_result_t res;
+    int master, slave, fds[2], status, ok;
+    pid_t pid;
+
+    memset(&ws, 0, sizeof(ws));
+    ws.ws_col = 80;
+    ws.ws_row = 24;
+    if (openpty(&master, &slave, NULL, NULL, &ws) != 0 || pipe(fds) != 0) {
+        perror("bench");
+        return -1;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        perror("bench: fork");
+        return -1;
+    }
+    if (pid == 0) {
+        close(master);
+        close(fds[0]);
+        if (login_tty(slave) != 0) _exit(1);
+        run_child(b, fds[1]);
+    }
+
+    close(slave);
+    close(fds[1]);
+    ok = serve(b, master, fds[0], &res);
+    waitpid(pid, &status, 0);  /* Closing the master first would hang up the child */
+    close(fds[0]);
+    close(master);
+
+    if (ok != 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        printf("%-20s  failed\n", b->name);
+        return -1;
+    }
+    printf("%-20s %9ld %12.1f %12.3f %12.2f\n", b->name, res.iters,
+           res.ns / (double)res.iters,
+           (double)res.syscalls / (double)res.iters,
+           (double)res.bytes / (double)res.iters);
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    size_t i;
+    int failed = 0;
+
+    signal(SIGPIPE, SIG_IGN);
+    printf("%-20s %9s %12s %12s %12s\n", "scenario", "ops", "ns/op", "syscalls/op", "bytes/op");
+    for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (argc > 1 && !strstr(benches[i].name, argv[1])) continue;
+        if (run(&benches[i]) != 0) failed = 1;
+    }
+    return failed;
+}
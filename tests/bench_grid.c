@@ -0,0 +1,123 @@
+/**
+ * @file bench_grid.c
+ *
+ * @brief Unattended microbenchmark of `conio_grid_diff()`.
+ *
+ * Two 400x120 grids (the size of a large virtual screen) are compared with every
+ * row comparison the processor supports: the portable cell by cell implementation,
+ * SSE2 and AVX2. For reference, a hand-rolled loop comparing every cell of the grids
+ * is also measured. Three cases are run: equal grids, a few changed cells (a typical
+ * frame) and grids where every row has changed at both ends.
+ *
+ * Build and run:
+ * ```
+ * cc -O2 -o bench_grid tests/bench_grid.c
+ * ./bench_grid              # 400x120
+ * ./bench_grid 200 60       # 200x60
+ * ```
+ */
+
+#include "../conio_lt.h"  /* First, for its feature test macros */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static conio_grid_t a, b;
+static conio_span_t* spans;
+static volatile int sink;
+
+/* Compares every cell, the way applications did it by hand */
+static int hand_rolled(void) {
+    cpos_t x, y;
+    int changed = 0;
+    for (y = 1; y <= a.rows; y++) {
+        for (x = 1; x <= a.cols; x++) {
+            const conio_cell_t* p = conio_grid_at(&a, x, y);
+            const conio_cell_t* q = conio_grid_at(&b, x, y);
+            if (p->ch != q->ch || p->attr != q->attr) {
+                changed++;
+                break;
+            }
+        }
+    }
+    return changed;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Returns the time of one comparison, the best of a few runs */
+static double measure(__conio_row_span_fn impl) {
+    double best = 0;
+    int run, i, iters = 2000;
+    for (run = 0; run < 5; run++) {
+        double start = now_ns(), t;
+        for (i = 0; i < iters; i++) {
+            if (impl) {
+                __conio_row_span = impl;
+                sink = conio_grid_diff(&a, &b, spans);
+            } else {
+                sink = hand_rolled();
+            }
+        }
+        t = (now_ns() - start) / iters;
+        if (run == 0 || t < best) best = t;
+    }
+    return best;
+}
+
+/* Prepares the grids for a case */
+static void prepare(int which) {
+    cpos_t x, y;
+    for (y = 1; y <= a.rows; y++) {
+        for (x = 1; x <= a.cols; x++) {
+            conio_cell_t* p = conio_grid_at(&a, x, y);
+            p->ch = 'a' + (x + y) % 26;
+            p->attr = CONIO_FG(y % 8);
+            *conio_grid_at(&b, x, y) = *p;
+        }
+    }
+    if (which == 1) {  /* A few changed cells */
+        for (y = 1; y <= a.rows; y += 10) conio_grid_at(&a, 1 + (y * 37) % a.cols, y)->ch = '#';
+    } else if (which == 2) {  /* Every row changed at both ends */
+        for (y = 1; y <= a.rows; y++) {
+            conio_grid_at(&a, 1, y)->ch = '#';
+            conio_grid_at(&a, a.cols, y)->ch = '#';
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    static const char* cases[] = { "equal", "sparse", "ends" };
+    cpos_t cols = argc > 1 ? (cpos_t)atoi(argv[1]) : 400;
+    cpos_t rows = argc > 2 ? (cpos_t)atoi(argv[2]) : 120;
+    int c;
+
+    if (conio_grid_init(&a, cols, rows) != 0 || conio_grid_init(&b, cols, rows) != 0) {
+        fprintf(stderr, "usage: %s [cols] [rows]\n", argv[0]);
+        return 2;
+    }
+    spans = (conio_span_t*)malloc((size_t)rows * sizeof(conio_span_t));
+    if (!spans) return 1;
+
+    printf("grid %dx%d, ns per comparison\n", (int)cols, (int)rows);
+    printf("%-8s %12s %12s %12s %12s\n", "case", "hand-rolled", "scalar", "sse2", "avx2");
+    for (c = 0; c < 3; c++) {
+        double sse2 = 0, avx2 = 0;
+        prepare(c);
+#ifdef CONIO_HAVE_SIMD
+        if (__builtin_cpu_supports("sse2")) sse2 = measure(__conio_row_span_sse2);
+        if (__builtin_cpu_supports("avx2")) avx2 = measure(__conio_row_span_avx2);
+#endif  /* CONIO_HAVE_SIMD */
+        printf("%-8s %12.0f %12.0f %12.0f %12.0f\n", cases[c], measure(NULL),
+               measure(__conio_row_span_scalar), sse2, avx2);
+    }
+
+    conio_grid_free(&a);
+    conio_grid_free(&b);
+    free(spans);
+    return 0;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file bench_server.c
+ *
+ * @brief Unattended benchmark of terminals served by one event loop thread.
+ *
+ * A child process serves N terminals with @ref conio_loop_add_term(); each of them
+ * is one end of a Unix socket pair, like a remote client attached to a server.
+ * This process plays the N clients: every round, each client sends a key press and
+ * waits for the reply (a cursor movement and a short status text). The CPU time used
+ * by the server is measured, from which the number of sessions one core can serve
+ * is estimated for a given typing rate.
+ *
+ * Build and run (on Linux):
+ * ```
+ * cc -O2 -o bench_server tests/bench_server.c
+ * ./bench_server                # 5000 sessions, 20 rounds
+ * ./bench_server 1000 100       # 1000 sessions, 100 rounds
+ * ```
+ */
+
+#include "../conio_lt.h"  /* First, for its feature test macros */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/** Status text written in reply to every key press. */
+#define BENCH_STATUS  "key received"
+
+/** Reply of the server to a key press: the cursor movement and the status text. */
+#define BENCH_REPLY   "\033[1;1H" BENCH_STATUS
+
+/** Key presses per second and session assumed for the estimate. */
+#define BENCH_RATE    10
+
+static int served;
+
+static void on_key(conio_loop_t* loop, conio_term_t* term, const conio_event_t* ev, void* user) {
+    (void)user;
+    if (!ev) {  /* The client has gone away */
+        close(term->in_fd);
+        conio_term_free(term);
+        if (--served == 0) conio_loop_stop(loop);
+        return;
+    }
+    gotoxy_ctx(term, 1, 1);
+    cputs_ctx(term, (char*)BENCH_STATUS);
+}
+
+static double cpu_s(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec)
+         + (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+/* Serves the terminals until every client has gone away, reports the CPU time used */
+static void run_server(int (*fds)[2], int n, int report) {
+    conio_loop_t* loop = conio_loop_new();
+    double cpu;
+    int i;
+
+    if (!loop) _exit(1);
+    for (i = 0; i < n; i++) {
+        conio_term_t* term = conio_term_new(fds[i][1], fds[i][1]);
+        if (!term || conio_loop_add_term(loop, term, on_key, NULL) != 0) _exit(1);
+    }
+    served = n;
+    if (write(report, "", 1) != 1) _exit(1);  /* Ready */
+
+    cpu = cpu_s();
+    if (conio_loop_run(loop) != 0) _exit(1);
+    cpu = cpu_s() - cpu;
+    conio_loop_free(loop);
+    if (write(report, &cpu, sizeof(cpu)) != (ssize_t)sizeof(cpu)) _exit(1);
+    _exit(0);
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 5000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+    int (*fds)[2];
+    int report[2], i, r, status;
+    double *times, cpu, events;
+    struct rlimit rl;
+    char ready;
+    pid_t pid;
+
+    if (n <= 0 || rounds <= 0) {
+        fprintf(stderr, "usage: %s [sessions] [rounds]\n", argv[0]);
+        return 2;
+    }
+
+    /* Two file descriptors per session */
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < (rlim_t)(2 * n + 64)) {
+        rl.rlim_cur = (rl.rlim_max < (rlim_t)(2 * n + 64)) ? rl.rlim_max : (rlim_t)(2 * n + 64);
+        setrlimit(RLIMIT_NOFILE, &rl);
+        if ((rlim_t)(2 * n + 64) > rl.rlim_cur) {
+            n = (int)(rl.rlim_cur - 64) / 2;
+            fprintf(stderr, "bench_server: limited to %d sessions by RLIMIT_NOFILE\n", n);
+        }
+    }
+
+    fds = (int (*)[2])malloc((size_t)n * sizeof(*fds));
+    times = (double*)malloc((size_t)rounds * sizeof(*times));
+    if (!fds || !times || pipe(report) != 0) return 1;
+    for (i = 0; i < n; i++) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]) != 0) {
+            perror("bench_server: socketpair");
+            return 1;
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    pid = fork();
+    if (pid < 0) {
+        perror("bench_server: fork");
+        return 1;
+    }
+    if (pid == 0) {
+        close(report[0]);
+        for (i = 0; i < n; i++) close(fds[i][0]);
+        run_server(fds, n, report[1]);
+    }
+    close(report[1]);
+    for (i = 0; i < n; i++) close(fds[i][1]);
+    if (read(report[0], &ready, 1) != 1) return 1;
+
+    /* Every client sends a key, then all replies are collected */
+    for (r = 0; r < rounds; r++) {
+        double start = now_s();
+        for (i = 0; i < n; i++) {
+            if (write(fds[i][0], "k", 1) != 1) return 1;
+        }
+        for (i = 0; i < n; i++) {
+            char buf[sizeof(BENCH_REPLY)];
+            size_t got = 0;
+            while (got < sizeof(BENCH_REPLY) - 1) {
+                ssize_t k = read(fds[i][0], buf + got, sizeof(BENCH_REPLY) - 1 - got);
+                if (k <= 0) {
+                    fprintf(stderr, "bench_server: session %d: no reply\n", i);
+                    return 1;
+                }
+                got += (size_t)k;
+            }
+            if (memcmp(buf, BENCH_REPLY, got) != 0) {
+                fprintf(stderr, "bench_server: session %d: unexpected reply\n", i);
+                return 1;
+            }
+        }
+        times[r] = now_s() - start;
+    }
+
+    for (i = 0; i < n; i++) close(fds[i][0]);
+    if (read(report[0], &cpu, sizeof(cpu)) != (ssize_t)sizeof(cpu)) return 1;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fputs("bench_server: the server failed\n", stderr);
+        return 1;
+    }
+
+    qsort(times, (size_t)rounds, sizeof(*times), cmp_double);
+    events = (double)n * (double)rounds;
+    printf("sessions             %d\n", n);
+    printf("key presses          %.0f\n", events);
+    printf("server CPU time      %.3f s\n", cpu);
+    printf("CPU per key press    %.2f us\n", cpu / events * 1e6);
+    printf("key presses/core/s   %.0f\n", events / cpu);
+    printf("round trip (all)     median %.2f ms, max %.2f ms\n",
+           times[rounds / 2] * 1e3, times[rounds - 1] * 1e3);
+    printf("sessions/core        %.0f at %d key presses/s per session\n",
+           events / cpu / BENCH_RATE, BENCH_RATE);
+    free(fds);
+    free(times);
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file test_caps.c
+ *
+ * @brief Test for the terminal capabilities used by `conio_present()` (`EL`, `ECH`
+ *        and `REP`).
+ *
+ * Screens with borders and blank areas are presented with every combination of
+ * capabilities; the terminal must show the same content, with less output when
+ * more capabilities are available. The output goes to the in-memory terminal, this
+ * test runs unattended.
+ */
+
+#include "test_util.h"
+#include <stdlib.h>
+
+#define COLS  80
+#define ROWS  24
+
+static test_backend_t cnt;
+
+static void expect_screen(const char* what, unsigned int caps) {
+    cpos_t x, y;
+    for (y = 1; y <= ROWS; y++) {
+        for (x = 1; x <= COLS; x++) {
+            const conio_cell_t* c = conio_vterm_cell(&cnt.vt, x, y);
+            const conio_cell_t* b = &__conio_def.scr.back[(size_t)(y - 1) * COLS + (x - 1)];
+            if (c->ch != b->ch || c->attr != b->attr) {
+                fprintf(stderr, "%s (caps %u): cell %d,%d differs\n", what, caps, (int)x, (int)y);
+                failures++;
+                return;
+            }
+        }
+    }
+}
+
+/* A window with a border, a title and a separator */
+static void draw_window(cpos_t x0, cpos_t y0, cpos_t w, cpos_t h, uint32_t attr) {
+    cpos_t x, y;
+    for (x = x0; x < x0 + w; x++) {
+        conio_screen_putc(x, y0, 0x2500, attr);           /* Horizontal line */
+        conio_screen_putc(x, y0 + 2, '-', attr);
+        conio_screen_putc(x, y0 + h - 1, 0x2500, attr);
+    }
+    for (y = y0; y < y0 + h; y++) {
+        conio_screen_putc(x0, y, 0x2502, attr);           /* Vertical line */
+        conio_screen_putc(x0 + w - 1, y, 0x2502, attr);
+    }
+    conio_screen_puts(x0 + 2, y0 + 1, "Status", attr | CONIO_ATTR_BOLD);
+}
+
+/* Presents a sequence of frames, returns the bytes written */
+static size_t frames(unsigned int caps) {
+    int i;
+    conio_setcaps(caps);
+    conio_screen_clear(CONIO_ATTR_DEFAULT);
+    conio_screen_invalidate();
+    conio_present();
+    cnt.bytes = 0;
+
+    /* A border-heavy screen */
+    draw_window(1, 1, COLS, ROWS, CONIO_FG(6));
+    draw_window(5, 6, 30, 10, CONIO_FG(3) | CONIO_BG(4));
+    conio_present();
+    expect_screen("windows", caps);
+
+    /* Blank areas, some with a background color */
+    for (i = 4; i < 20; i++) conio_screen_puts(2, (cpos_t)i, "                                                  ", CONIO_BG(4));
+    conio_screen_puts(40, 20, "                                        ", CONIO_ATTR_DEFAULT);
+    conio_present();
+    expect_screen("blanks", caps);
+
+    /* Everything cleared */
+    conio_screen_clear(CONIO_BG(2));
+    conio_present();
+    expect_screen("clear", caps);
+
+    /* Random runs */
+    srand(7);
+    for (i = 0; i < 200 && !failures; i++) {
+        cpos_t x = (cpos_t)(1 + rand() % COLS), y = (cpos_t)(1 + rand() % ROWS);
+        int k, n = rand() % 30;
+        uint32_t ch = (rand() % 3) ? ' ' : (uint32_t)('a' + rand() % 3);
+        uint32_t attr = (rand() % 2) ? CONIO_BG(rand() % 3) : CONIO_ATTR_UNDERLINE;
+        for (k = 0; k < n; k++) conio_screen_putc(x + k, y, ch, attr);
+        if (rand() % 4 == 0) conio_present();
+    }
+    conio_present();
+    expect_screen("random", caps);
+    return cnt.bytes;
+}
+
+int main(void) {
+    char buf[CONIO_ENC_MAX];
+    size_t plain, erase, all;
+
+    puts("Test: conio_setcaps, conio_present with EL, ECH and REP\n");
+    if (memcmp(buf, "\033[5X", conio_enc_ech(buf, 5)) != 0
+        || memcmp(buf, "\033[b", conio_enc_rep(buf, 1)) != 0) {
+        fputs("conio_enc_ech, conio_enc_rep: unexpected sequences\n", stderr);
+        failures++;
+    }
+    if (conio_getcaps() != CONIO_CAP_DEFAULT) {
+        fputs("conio_getcaps: unexpected default\n", stderr);
+        failures++;
+    }
+
+    if (tb_init(&cnt, COLS, ROWS) != 0) return 1;
+    conio_set_backend(&cnt.backend);
+    conio_cursor_track(1);
+    if (conio_screen_init(0, 0) != 0) return 1;
+
+    plain = frames(0);
+    erase = frames(CONIO_CAP_EL | CONIO_CAP_ECH);
+    all = frames(CONIO_CAP_EL | CONIO_CAP_ECH | CONIO_CAP_REP);
+    frames(CONIO_CAP_REP);
+    frames(CONIO_CAP_ECH);
+    printf("bytes: literal %d, EL/ECH %d, EL/ECH/REP %d\n", (int)plain, (int)erase, (int)all);
+    if (!(all < erase && erase < plain)) {
+        fputs("the capabilities do not reduce the output\n", stderr);
+        failures++;
+    }
+
+    conio_setcaps(CONIO_CAP_DEFAULT);
+    conio_screen_free();
+    conio_cursor_track(0);
+    conio_set_backend(NULL);
+    conio_vterm_free(&cnt.vt);
+
+    return test_result();
+}
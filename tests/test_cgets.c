@@ -4,9 +4,9 @@
  * @brief Test for the `cgets` function.
  */
 
+#include "../conio_lt.h"
 #include <stdio.h>
 #include <string.h>
-#include "../conio_lt.h"
 
 int main(void) {
     char buffer[50];
@@ -4,8 +4,8 @@
  * @brief Test for `gotoxy`, `wherex`, `wherey` and `wherexy` functions.
  */
 
-#include <stdio.h>
 #include "../conio_lt.h"
+#include <stdio.h>
 
 int main(void) {
     puts("Test: gotoxy, wherex, wherey\n");
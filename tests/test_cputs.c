@@ -4,8 +4,8 @@
  * @brief Test for the `cputs` function.
  */
 
-#include <stdio.h>
 #include "../conio_lt.h"
+#include <stdio.h>
 
 int main(void) {
     cputs("Hello, World! This is a test for cputs.\n");
@@ -4,9 +4,9 @@
  * @brief Test for scanf() function.
  */
 
+#include "../conio_lt.h"
 #include <stdio.h>
 #include <string.h>
-#include "../conio_lt.h"
 
 int main(void) {
     char str[256];
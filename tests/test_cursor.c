@@ -0,0 +1,32 @@
+/**
+ * @file test_cursor.c
+ *
+ * @brief Test for `conio_cursor_track` and `conio_cursor_sync` functions.
+ */
+
+#include "../conio_lt.h"
+#include <stdio.h>
+
+int main(void) {
+    cpos_t x, y;
+    puts("Test: conio_cursor_track, conio_cursor_sync\n");
+
+    /* Query the terminal once, after that the position is computed locally */
+    conio_cursor_track(1);
+
+    gotoxy(10, 5);
+    cputs("Hello");
+    wherexy(&x, &y);  /* No terminal round trip */
+    cputs("\n");
+    printf("Tracked position after \"Hello\" at X:10 Y:5 => X:%d Y:%d\n", x, y);
+
+    /* `printf` is not seen by the cursor model, resynchronise it */
+    conio_cursor_sync();
+    wherexy(&x, &y);
+    printf("Synchronised position: X:%d Y:%d\n", x, y);
+
+    conio_cursor_track(0);
+
+    printf("\n[Test Passed]\n");
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file test_cursor_query.c
+ *
+ * @brief Test for the cursor position queries (`conio_cursor_query()`,
+ *        `conio_cursor_reply()`) and `wherexy()`.
+ *
+ * The in-memory terminal answers the queries, possibly one byte at a time and
+ * mixed with key presses; another one answers nothing or answers late.
+ * This test runs unattended.
+ */
+
+#define CONIO_QUERY_TIMEOUT  100  /* Keep the waits for the mute terminal short */
+
+#include "test_util.h"
+
+/* Waits out the timeouts like a terminal, optionally ignoring the queries or serving
+ * one byte per read */
+static int ans_init(test_backend_t* a, int mute, int bytewise) {
+    if (tb_init(a, 80, 24) != 0) return -1;
+    a->mute = mute;
+    a->bytewise = bytewise;
+    a->wait = 1;
+    return 0;
+}
+
+int main(void) {
+    test_backend_t fast, slow, mute, trickle, gone;
+    conio_term_t *t2, *t3, *t4;
+    cpos_t x = 0, y = 0;
+    unsigned long start;
+    int i, ok;
+
+    puts("Test: conio_cursor_query, conio_cursor_reply\n");
+    if (ans_init(&fast, 0, 0) != 0 || ans_init(&slow, 0, 1) != 0 || ans_init(&mute, 1, 0) != 0
+        || ans_init(&trickle, 1, 1) != 0 || ans_init(&gone, 1, 0) != 0) return 1;
+
+    /* Several queries are resolved with one read, the keys typed meanwhile are kept */
+    conio_set_backend(&fast.backend);
+    gotoxy(3, 2);
+    check(conio_cursor_query() == 0, "conio_cursor_query: failed");
+    conio_vterm_feed(&fast.vt, "k", 1);
+    cputs("ab");
+    check(conio_cursor_query() == 0, "conio_cursor_query: failed");
+    check(conio_cursor_reply(&x, &y, 100) == 1 && x == 3 && y == 2, "conio_cursor_reply: wrong first reply");
+    check(conio_cursor_reply(&x, &y, 100) == 1 && x == 5 && y == 2, "conio_cursor_reply: wrong second reply");
+    check(fast.reads == 1, "conio_cursor_reply: expected one read");
+    check(conio_cursor_reply(&x, &y, 100) == -1, "conio_cursor_reply: no query is outstanding");
+    check(getch() == 'k' && !kbhit(), "conio_cursor_reply: the key typed meanwhile was lost");
+
+    /* A reply alone is not a key press */
+    check(conio_cursor_query() == 0 && !kbhit(), "kbhit: the reply was taken for a key");
+    check(conio_cursor_reply(NULL, NULL, 0) == 1, "conio_cursor_reply: the reply was not kept");
+    conio_set_backend(NULL);
+
+    /* A reply split across reads, around key presses */
+    t2 = conio_term_new(-1, -1);
+    conio_set_backend_ctx(t2, &slow.backend);
+    gotoxy_ctx(t2, 12, 7);
+    conio_vterm_feed(&slow.vt, "a", 1);
+    wherexy_ctx(t2, &x, &y);
+    check(x == 12 && y == 7, "wherexy_ctx: wrong position");
+    conio_vterm_feed(&slow.vt, "b", 1);
+    check(getch_ctx(t2) == 'a' && getch_ctx(t2) == 'b', "wherexy_ctx: the keys were lost");
+
+    /* A terminal that answers nothing: the waits end, late replies are not keys */
+    t3 = conio_term_new(-1, -1);
+    conio_set_backend_ctx(t3, &mute.backend);
+    check(conio_cursor_query_ctx(t3) == 0, "conio_cursor_query_ctx: failed");
+    start = __conio_now_ms();
+    check(conio_cursor_reply_ctx(t3, &x, &y, 30) == 0, "conio_cursor_reply_ctx: expected the timeout");
+    check(__conio_now_ms() - start >= 20, "conio_cursor_reply_ctx: returned too early");
+    conio_vterm_feed(&mute.vt, "\033[4;6R", 6);
+    check(conio_cursor_reply_ctx(t3, &x, &y, 0) == 1 && x == 6 && y == 4,
+          "conio_cursor_reply_ctx: wrong late reply");
+
+    x = y = 99;
+    start = __conio_now_ms();
+    wherexy_ctx(t3, &x, &y);
+    check(x == 99 && y == 99, "wherexy_ctx: position changed without a reply");
+    check(__conio_now_ms() - start < 1000, "wherexy_ctx: waited past the timeout");
+    conio_vterm_feed(&mute.vt, "\033[7;9Rz", 7);
+    check(getch_ctx(t3) == 'z', "wherexy_ctx: the late reply reached getch()");
+    check(conio_cursor_reply_ctx(t3, &x, &y, 0) == -1, "wherexy_ctx: the late reply was queued");
+
+    /* A reply read alone does not end the wait for a key */
+    conio_set_backend(&trickle.backend);
+    check(conio_cursor_query() == 0, "conio_cursor_query: failed");
+    conio_vterm_feed(&trickle.vt, "\033[3;4Rk", 7);
+    check(getch() == 'k', "getch: the key after the reply was not returned");
+    check(conio_cursor_reply(&x, &y, 0) == 1 && x == 4 && y == 3, "conio_cursor_reply: wrong reply");
+    check(conio_cursor_query() == 0, "conio_cursor_query: failed");
+    conio_vterm_feed(&trickle.vt, "\033[3;4Rj", 7);
+    check(getch_timeout(1000) == 'j', "getch_timeout: the key after the reply was not returned");
+    check(conio_cursor_query() == 0, "conio_cursor_query: failed");
+    conio_vterm_feed(&trickle.vt, "\033[3;4R", 6);
+    start = __conio_now_ms();
+    check(getch_timeout(50) == CONIO_TIMEOUT && __conio_now_ms() - start >= 40,
+          "getch_timeout: returned before the timeout");
+    check(conio_cursor_reply(NULL, NULL, 0) == 1 && conio_cursor_reply(NULL, NULL, 0) == 1,
+          "conio_cursor_reply: the replies were lost");
+    conio_set_backend(NULL);
+
+    /* Queries abandoned while the terminal answers nothing (a detached tmux) do not
+     * use up the limit, and the replies are taken again once it answers */
+    t4 = conio_term_new(-1, -1);
+    conio_set_backend_ctx(t4, &gone.backend);
+    for (i = 0; i < CONIO_CPR_MAX + 2; i++) wherexy_ctx(t4, &x, &y);
+    check(gone.queries == CONIO_CPR_MAX + 2, "wherexy_ctx: the queries were not sent");
+    gone.mute = 0;
+    usleep(CONIO_QUERY_TIMEOUT * 1000);
+    x = y = 0;
+    gotoxy_ctx(t4, 5, 7);
+    wherexy_ctx(t4, &x, &y);
+    check(x == 5 && y == 7, "wherexy_ctx: no position once the terminal answers again");
+    check(conio_cursor_query_ctx(t4) == 0 && conio_cursor_reply_ctx(t4, &x, &y, 100) == 1,
+          "conio_cursor_query_ctx: no query once the terminal answers again");
+
+    /* The number of outstanding queries is bounded */
+    for (i = 0, ok = 1; i < CONIO_CPR_MAX; i++) ok &= (conio_cursor_query_ctx(t3) == 0);
+    check(ok && conio_cursor_query_ctx(t3) == -1, "conio_cursor_query_ctx: expected the limit");
+
+    conio_term_free(t2);
+    conio_term_free(t3);
+    conio_term_free(t4);
+    conio_vterm_free(&fast.vt);
+    conio_vterm_free(&slow.vt);
+    conio_vterm_free(&mute.vt);
+    conio_vterm_free(&trickle.vt);
+    conio_vterm_free(&gone.vt);
+
+    return test_result();
+}
@@ -0,0 +1,128 @@
+/**
+ * @file test_dirty.c
+ *
+ * @brief Test for the dirty row tracking of the off-screen buffer.
+ *
+ * `conio_present()` must only look at the rows written since the previous frame,
+ * and the terminal must still show the buffer after any mix of writes. The output
+ * goes to the in-memory terminal, this test runs unattended.
+ */
+
+#include "test_util.h"
+#include <stdlib.h>
+
+#define COLS  200
+#define ROWS  60
+
+static int visits = 0;
+static __conio_row_span_fn compare;
+static conio_vterm_t vt;
+
+/* Counts the rows compared by conio_present() */
+static int counting_span(const conio_cell_t* a, const conio_cell_t* b, cpos_t n,
+                         cpos_t* first, cpos_t* last) {
+    visits++;
+    return compare(a, b, n, first, last);
+}
+
+/* Presents and returns the number of row comparisons */
+static int present(void) {
+    visits = 0;
+    conio_present();
+    return visits;
+}
+
+static void expect_screen(const char* what) {
+    cpos_t x, y;
+    for (y = 1; y <= ROWS; y++) {
+        for (x = 1; x <= COLS; x++) {
+            const conio_cell_t* c = conio_vterm_cell(&vt, x, y);
+            const conio_cell_t* b = &__conio_def.scr.back[(size_t)(y - 1) * COLS + (x - 1)];
+            if (c->ch != b->ch || c->attr != b->attr) {
+                fprintf(stderr, "%s: cell %d,%d differs\n", what, (int)x, (int)y);
+                failures++;
+                return;
+            }
+        }
+    }
+}
+
+int main(void) {
+    char buf[32];
+    int i, n;
+
+    puts("Test: dirty rows of the off-screen buffer\n");
+    if (conio_vterm_init(&vt, COLS, ROWS) != 0) return 1;
+    conio_set_backend(&vt.backend);
+    if (conio_screen_init(0, 0) != 0) return 1;
+
+    /* Choose the implementation for the processor, then count its calls */
+    __conio_row_span(NULL, NULL, 0, NULL, NULL);
+    compare = __conio_row_span;
+    __conio_row_span = counting_span;
+
+    /* A dashboard: a frame, then a few counters per update */
+    for (i = 1; i <= ROWS; i += 5) conio_screen_puts(1, (cpos_t)i, "metric:", CONIO_ATTR_BOLD);
+    present();
+    expect_screen("first frame");
+    if ((n = present()) != 0) {
+        fprintf(stderr, "unchanged frame: %d rows compared\n", n);
+        failures++;
+    }
+    for (i = 0; i < 20; i++) {
+        snprintf(buf, sizeof(buf), "%d", i * 17);
+        conio_screen_puts(9, 1, buf, CONIO_FG(2));
+        conio_screen_puts(9, 31, buf, CONIO_FG(3));
+        conio_screen_putc(COLS, ROWS, (uint32_t)('a' + i), CONIO_ATTR_DEFAULT);
+        if ((n = present()) > 6) {
+            fprintf(stderr, "3 rows written: %d rows compared\n", n);
+            failures++;
+            break;
+        }
+    }
+    expect_screen("counters");
+
+    /* Rewriting the same cells writes nothing */
+    conio_screen_puts(1, 6, "metric:", CONIO_ATTR_BOLD);
+    present();
+    if ((n = present()) != 0) {
+        fprintf(stderr, "same cells: %d rows compared\n", n);
+        failures++;
+    }
+
+    /* Clearing and invalidating look at every row again */
+    conio_screen_clear(CONIO_ATTR_DEFAULT);
+    if ((n = present()) < ROWS) {
+        fprintf(stderr, "clear: %d rows compared\n", n);
+        failures++;
+    }
+    expect_screen("clear");
+    conio_screen_invalidate();
+    if ((n = present()) < ROWS) {
+        fprintf(stderr, "invalidate: %d rows compared\n", n);
+        failures++;
+    }
+    expect_screen("invalidate");
+
+    /* Random writes, including strings clipped at both edges */
+    srand(1);
+    for (i = 0; i < 300 && !failures; i++) {
+        int k, writes = rand() % 10;
+        for (k = 0; k < writes; k++) {
+            cpos_t x = (cpos_t)(rand() % (COLS + 20)) - 10, y = (cpos_t)(1 + rand() % ROWS);
+            snprintf(buf, sizeof(buf), "%*d", 1 + rand() % 20, rand());
+            if (rand() % 2) conio_screen_puts(x, y, buf, CONIO_FG(rand() % 8));
+            else conio_screen_putc(x, y, (uint32_t)('A' + rand() % 26), CONIO_ATTR_DEFAULT);
+        }
+        if (rand() % 50 == 0) conio_screen_clear(CONIO_BG(rand() % 8));
+        present();
+        expect_screen("random");
+    }
+
+    __conio_row_span = compare;
+    conio_screen_free();
+    conio_set_backend(NULL);
+    conio_vterm_free(&vt);
+
+    return test_result();
+}
@@ -0,0 +1,92 @@
+/**
+ * @file test_enc.c
+ *
+ * @brief Test for the escape sequence encoders (`conio_enc_*` functions).
+ *
+ * Every sequence is compared with the one formatted by `snprintf()`, around
+ * the changes in the number of digits. This test runs unattended.
+ */
+
+#include "test_util.h"
+#include <limits.h>
+
+/* Compares an encoded sequence with the expected one */
+static void check_enc(const char* what, long v, const char* buf, size_t len, const char* expected) {
+    if (len > CONIO_ENC_MAX || len != strlen(expected) || memcmp(buf, expected, len) != 0) {
+        fprintf(stderr, "%s(%ld): got \"%.*s\" (%u bytes), expected \"%s\"\n",
+                what, v, (int)(len < CONIO_ENC_MAX ? len : CONIO_ENC_MAX), buf, (unsigned int)len, expected);
+        failures++;
+    }
+}
+
+/* Reference SGR sequence for the attributes */
+static void sgr_ref(char* s, size_t size, uint32_t attr) {
+    static const int styles[] = { 1, 2, 3, 4, 5, 7 };
+    static const int base[] = { 30, 90, 40, 100 };
+    unsigned int color[2];
+    size_t n;
+    int i;
+
+    color[0] = attr & 0x1FF;
+    color[1] = (attr >> 9) & 0x1FF;
+    n = (size_t)snprintf(s, size, "\033[0");
+    for (i = 0; i < 6; i++) {
+        if (attr & (CONIO_ATTR_BOLD << i)) n += (size_t)snprintf(s + n, size - n, ";%d", styles[i]);
+    }
+    for (i = 0; i < 2; i++) {
+        unsigned int c = color[i];
+        if (c-- == 0) continue;
+        if (c < 16) n += (size_t)snprintf(s + n, size - n, ";%u", base[i * 2 + (c >= 8)] + c % 8);
+        else n += (size_t)snprintf(s + n, size - n, ";%d8;5;%u", i ? 4 : 3, c);
+    }
+    snprintf(s + n, size - n, "m");
+}
+
+int main(void) {
+    static const long values[] = { 0, 1, 9, 10, 99, 100, 999, 1000, 9999, 10000, 32767, 65535, INT_MAX };
+    char buf[CONIO_ENC_MAX + 16], expected[64];
+    uint32_t attr;
+    size_t i, j;
+
+    puts("Test: conio_enc_*\n");
+
+    for (i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        long v = values[i];
+        cpos_t p = (cpos_t)(v > 32767 ? 32767 : v);  /* Positions are 16-bit */
+
+        for (j = 0; j < sizeof(values) / sizeof(values[0]); j++) {
+            cpos_t q = (cpos_t)(values[j] > 32767 ? 32767 : values[j]);
+            snprintf(expected, sizeof(expected), "\033[%d;%dH", q, p);
+            check_enc("conio_enc_cup", v, buf, conio_enc_cup(buf, p, q), expected);
+        }
+
+        /* The parameter is omitted when it is the default */
+        snprintf(expected, sizeof(expected), (p == 1) ? "\033[G" : "\033[%dG", p);
+        check_enc("conio_enc_cha", v, buf, conio_enc_cha(buf, p), expected);
+        snprintf(expected, sizeof(expected), (p == 1) ? "\033[d" : "\033[%dd", p);
+        check_enc("conio_enc_vpa", v, buf, conio_enc_vpa(buf, p), expected);
+        snprintf(expected, sizeof(expected), (v == 0) ? "\033[J" : "\033[%ldJ", v);
+        check_enc("conio_enc_ed", v, buf, conio_enc_ed(buf, (int)v), expected);
+        snprintf(expected, sizeof(expected), (v == 0) ? "\033[K" : "\033[%ldK", v);
+        check_enc("conio_enc_el", v, buf, conio_enc_el(buf, (int)v), expected);
+    }
+
+    /* Negative values are clamped to zero */
+    check_enc("conio_enc_cup", -5, buf, conio_enc_cup(buf, -5, -1), "\033[0;0H");
+    check_enc("conio_enc_cha", -5, buf, conio_enc_cha(buf, -5), "\033[0G");
+    check_enc("conio_enc_ed", -5, buf, conio_enc_ed(buf, -5), "\033[J");
+
+    /* Every color with every style, and all the bits set */
+    for (i = 0; i <= 256; i++) {
+        for (j = 0; j < 64; j++) {
+            attr = (uint32_t)(j * CONIO_ATTR_BOLD) | (i ? CONIO_FG(i - 1) | CONIO_BG(256 - i) : 0);
+            sgr_ref(expected, sizeof(expected), attr);
+            check_enc("conio_enc_sgr", (long)attr, buf, conio_enc_sgr(buf, attr), expected);
+        }
+    }
+    attr = 0xFFFFFFFFU;
+    sgr_ref(expected, sizeof(expected), attr);
+    check_enc("conio_enc_sgr", (long)attr, buf, conio_enc_sgr(buf, attr), expected);
+
+    return test_result();
+}
@@ -0,0 +1,46 @@
+/**
+ * @file test_event.c
+ *
+ * @brief Test for `conio_read_event` and `conio_read_events` functions.
+ */
+
+#include "../conio_lt.h"
+#include <stdio.h>
+
+static const char* key_name(conio_key_t key) {
+    static const char* names[] = {
+        "none", "char", "enter", "tab", "backspace", "escape", "up", "down",
+        "right", "left", "home", "end", "insert", "delete", "pageup", "pagedown",
+        "F1", "F2", "F3", "F4", "F5", "F6", "F7", "F8", "F9", "F10", "F11", "F12",
+        "unknown"
+    };
+    return names[key];
+}
+
+int main(void) {
+    conio_event_t events[16];
+    int i, n, done = 0;
+
+    puts("Test: conio_read_event, conio_read_events\n");
+    puts("Press keys (arrows, function keys, Ctrl/Alt combinations), 'q' to quit.");
+
+    conio_session_begin();
+    while (!done && (n = conio_read_events(events, 16)) > 0) {
+        for (i = 0; i < n; i++) {
+            conio_event_t* ev = &events[i];
+            printf("key: %-9s mods:%s%s%s%s", key_name(ev->key),
+                   (ev->mods & CONIO_MOD_SHIFT) ? " shift" : "",
+                   (ev->mods & CONIO_MOD_ALT)   ? " alt"   : "",
+                   (ev->mods & CONIO_MOD_CTRL)  ? " ctrl"  : "",
+                   (ev->mods & CONIO_MOD_META)  ? " meta"  : "");
+            if (ev->key == CONIO_KEY_CHAR) printf(" codepoint: U+%04X", (unsigned int)ev->codepoint);
+            printf("  (%d event(s) in this read)\n", n);
+
+            if (ev->key == CONIO_KEY_CHAR && ev->codepoint == 'q' && ev->mods == 0) done = 1;
+        }
+    }
+    conio_session_end();
+
+    printf("\n[Test Passed]\n");
+    return 0;
+}
@@ -0,0 +1,32 @@
+/**
+ * @file test_flush.c
+ *
+ * @brief Test for `conio_flush`, `conio_setflush` and `conio_setbuf` functions.
+ */
+
+#include "../conio_lt.h"
+#include <stdio.h>
+
+int main(void) {
+    int i;
+    puts("Test: conio_flush, conio_setflush, conio_setbuf\n");
+
+    /* Only write the output when requested (or when input is awaited) */
+    conio_setflush(CONIO_FLUSH_ON_INPUT, 0);
+    conio_setbuf(64 * 1024);
+
+    clrscr();
+    for (i = 1; i <= 10; i++) {
+        gotoxy(i * 2, i);
+        cputs("frame");
+    }
+    gotoxy(1, 12);
+    cputs("The frame above has been written at once.\n");
+    conio_flush();
+
+    /* Restore the default policy */
+    conio_setflush(CONIO_FLUSH_IMMEDIATE | CONIO_FLUSH_ON_INPUT, 0);
+
+    printf("\n[Test Passed]\n");
+    return 0;
+}
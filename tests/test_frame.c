@@ -0,0 +1,139 @@
+/**
+ * @file test_frame.c
+ *
+ * @brief Test for the frames (`conio_frame_begin()`, `conio_frame_end()`) and the
+ *        probe of synchronized output.
+ *
+ * The output goes to in-memory terminals, some of which ignore the mode query or
+ * every query. This test runs unattended.
+ */
+
+#include "test_util.h"
+
+/* Passes the output to the emulator, which answers every query (answer 2), all but
+ * the mode queries (1) or none (0) */
+static int rec_filter(test_backend_t* rec, const char* s, size_t n) {
+    static const char decrqm[] = "\033[?2026$p", da[] = "\033[c";
+    size_t i = 0;
+
+    /* The probe is written alone, beginning with the device attributes request */
+    if (n >= sizeof(da) - 1 && memcmp(s, da, sizeof(da) - 1) == 0) {
+        rec->probes++;
+        if (rec->answer == 0) return 0;
+    }
+    /* Mode queries the terminal does not answer are not passed to the emulator */
+    while (i < n) {
+        if (n - i >= sizeof(decrqm) - 1 && memcmp(s + i, decrqm, sizeof(decrqm) - 1) == 0) {
+            if (rec->answer >= 2) conio_vterm_write(&rec->vt, s + i, sizeof(decrqm) - 1);
+            i += sizeof(decrqm) - 1;
+        } else {
+            conio_vterm_write(&rec->vt, s + i++, 1);
+        }
+    }
+    return 0;
+}
+
+static int rec_init(test_backend_t* rec, int answer) {
+    if (tb_init(rec, 40, 30) != 0) return -1;
+    rec->filter = rec_filter;
+    rec->answer = answer;
+    return 0;
+}
+
+static int starts_with(const test_backend_t* rec, const char* s) {
+    return rec->len >= strlen(s) && memcmp(rec->out, s, strlen(s)) == 0;
+}
+
+static int ends_with(const test_backend_t* rec, const char* s) {
+    return rec->len >= strlen(s) && memcmp(rec->out + rec->len - strlen(s), s, strlen(s)) == 0;
+}
+
+/* Draws a frame of 30 lines */
+static void draw(conio_term_t* term, int n) {
+    char line[32];
+    cpos_t y;
+    for (y = 1; y <= 30; y++) {
+        snprintf(line, sizeof(line), "frame %d, line %d", n, (int)y);
+        gotoxy_ctx(term, 1, y);
+        cputs_ctx(term, line);
+    }
+}
+
+int main(void) {
+    test_backend_t full, noquery, mute, declared;
+    conio_term_t *t2, *t3, *t4;
+    char line[64];
+
+    puts("Test: conio_frame_begin, conio_frame_end\n");
+    if (rec_init(&full, 2) != 0 || rec_init(&noquery, 1) != 0
+        || rec_init(&mute, 0) != 0 || rec_init(&declared, 2) != 0) return 1;
+
+    /* A terminal supporting synchronized output, with a key pressed before the probe */
+    conio_set_backend(&full.backend);
+    conio_setbuf(128);
+    conio_vterm_feed(&full.vt, "x", 1);
+    check(conio_frame_begin() == 1, "conio_frame_begin: synchronized output not detected");
+    check(full.probes == 1, "conio_frame_begin: expected one query");
+    check((conio_getcaps() & CONIO_CAP_SYNC) != 0, "conio_getcaps: CONIO_CAP_SYNC not set");
+    full.len = 0;
+    full.writes = 0;
+    draw(conio_term_default(), 1);
+    check(full.vt.sync == 1, "conio_frame_begin: the terminal is not in synchronized output");
+    check(conio_frame_end() == 0, "conio_frame_end: failed");
+    check(full.writes > 1, "conio_frame_end: expected a frame larger than the buffer");
+    check(starts_with(&full, "\033[?2026h") && ends_with(&full, "\033[?2026l"),
+          "conio_frame_end: the frame is not wrapped in synchronized output");
+    check(full.vt.sync == 0, "conio_frame_end: synchronized output not reset");
+    conio_vterm_row(&full.vt, 30, line, sizeof(line));
+    check(strcmp(line, "frame 1, line 30") == 0, "conio_frame_end: the frame is incomplete");
+    check(getch() == 'x', "conio_frame_begin: the key pressed during the probe was lost");
+
+    /* Probed once; nested frames are written by the outermost one */
+    conio_setbuf(0);
+    full.writes = 0;
+    conio_frame_begin();
+    conio_frame_begin();
+    draw(conio_term_default(), 2);
+    conio_frame_end();
+    check(full.writes == 0, "conio_frame_end: a nested frame was written");
+    conio_frame_end();
+    check(full.writes == 1 && full.probes == 1, "conio_frame_end: expected one write and no query");
+    check(conio_frame_end() == 0 && full.writes == 1, "conio_frame_end: written without a frame");
+    conio_set_backend(NULL);
+
+    /* A terminal that ignores the mode query: the frame is only buffered */
+    t2 = conio_term_new(-1, -1);
+    conio_set_backend_ctx(t2, &noquery.backend);
+    check(conio_frame_begin_ctx(t2) == 0, "conio_frame_begin_ctx: unexpected synchronized output");
+    noquery.len = 0;
+    noquery.writes = 0;
+    draw(t2, 3);
+    conio_frame_end_ctx(t2);
+    check(noquery.writes == 1 && !strstr(noquery.out, "2026"), "conio_frame_end_ctx: expected one plain write");
+    conio_vterm_row(&noquery.vt, 30, line, sizeof(line));
+    check(strcmp(line, "frame 3, line 30") == 0, "conio_frame_end_ctx: the frame is incomplete");
+
+    /* A terminal that answers nothing does not block the probe */
+    t3 = conio_term_new(-1, -1);
+    conio_set_backend_ctx(t3, &mute.backend);
+    check(conio_frame_begin_ctx(t3) == 0, "conio_frame_begin_ctx: unexpected synchronized output");
+    conio_frame_end_ctx(t3);
+
+    /* Declared capabilities are not probed */
+    t4 = conio_term_new(-1, -1);
+    conio_set_backend_ctx(t4, &declared.backend);
+    conio_setcaps_ctx(t4, CONIO_CAP_EL | CONIO_CAP_SYNC);
+    check(conio_frame_begin_ctx(t4) == 1, "conio_frame_begin_ctx: declared synchronized output not used");
+    conio_frame_end_ctx(t4);
+    check(declared.probes == 0, "conio_frame_begin_ctx: unexpected query");
+
+    conio_term_free(t2);
+    conio_term_free(t3);
+    conio_term_free(t4);
+    conio_vterm_free(&full.vt);
+    conio_vterm_free(&noquery.vt);
+    conio_vterm_free(&mute.vt);
+    conio_vterm_free(&declared.vt);
+
+    return test_result();
+}
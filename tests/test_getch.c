@@ -4,8 +4,8 @@
  * @brief Test for `getch` and `getche` functions.
  */
 
-#include <stdio.h>
 #include "../conio_lt.h"
+#include <stdio.h>
 
 int main(void) {
     puts("Test: getch, getche, putch\n");
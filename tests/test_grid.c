@@ -0,0 +1,131 @@
+/**
+ * @file test_grid.c
+ *
+ * @brief Test for the cell grids (`conio_grid_*` functions).
+ *
+ * The changed columns reported by `conio_grid_diff()` are checked against a cell
+ * by cell comparison, with every row comparison the processor supports. This test
+ * runs unattended.
+ */
+
+#include "test_util.h"
+#include <stdlib.h>
+
+/* Reference: the changed columns found cell by cell */
+static void reference(const conio_grid_t* a, const conio_grid_t* b, cpos_t y, conio_span_t* span) {
+    cpos_t x;
+    span->first = span->last = 0;
+    for (x = 1; x <= a->cols; x++) {
+        const conio_cell_t* p = conio_grid_at(a, x, y);
+        const conio_cell_t* q = conio_grid_at(b, x, y);
+        if (p->ch != q->ch || p->attr != q->attr) {
+            if (!span->first) span->first = x;
+            span->last = x;
+        }
+    }
+}
+
+static void check_grid(const char* name, cpos_t cols, cpos_t rows) {
+    conio_grid_t a, b;
+    conio_span_t* spans = (conio_span_t*)malloc((size_t)rows * sizeof(conio_span_t));
+    int round, changed, expected;
+    cpos_t y;
+
+    if (!spans || conio_grid_init(&a, cols, rows) != 0 || conio_grid_init(&b, cols, rows) != 0) {
+        fprintf(stderr, "%s: allocation failed\n", name);
+        failures++;
+        return;
+    }
+    if ((uintptr_t)a.cells % CONIO_GRID_ALIGN != 0 || (a.stride * sizeof(conio_cell_t)) % CONIO_GRID_ALIGN != 0) {
+        fprintf(stderr, "%s: the rows are not aligned\n", name);
+        failures++;
+    }
+    if (conio_grid_diff(&a, &b, spans) != 0) {
+        fprintf(stderr, "%s: new grids differ\n", name);
+        failures++;
+    }
+
+    for (round = 0; round < 200; round++) {
+        int k, n = rand() % 8;
+        for (k = 0; k < n; k++) {
+            /* Change the character, the attributes, or restore a cell */
+            conio_cell_t* c = conio_grid_at(&a, 1 + rand() % cols, 1 + rand() % rows);
+            switch (rand() % 3) {
+            case 0:  c->ch = 'a' + rand() % 26; break;
+            case 1:  c->attr = CONIO_FG(rand() % 8); break;
+            default: *c = *conio_grid_at(&b, 1, 1); break;
+            }
+        }
+        changed = conio_grid_diff(&a, &b, spans);
+        for (y = 1, expected = 0; y <= rows; y++) {
+            conio_span_t ref;
+            reference(&a, &b, y, &ref);
+            expected += (ref.first != 0);
+            if (ref.first != spans[y - 1].first || ref.last != spans[y - 1].last) {
+                fprintf(stderr, "%s (%dx%d): row %d: expected %d-%d, got %d-%d\n", name,
+                        (int)cols, (int)rows, (int)y, (int)ref.first, (int)ref.last,
+                        (int)spans[y - 1].first, (int)spans[y - 1].last);
+                failures++;
+                round = 200;
+                break;
+            }
+        }
+        if (changed != expected) {
+            fprintf(stderr, "%s: expected %d changed rows, got %d\n", name, expected, changed);
+            failures++;
+        }
+        if (rand() % 4 == 0) {  /* Start over with equal grids */
+            for (y = 1; y <= rows; y++) {
+                cpos_t x;
+                for (x = 1; x <= cols; x++) *conio_grid_at(&a, x, y) = *conio_grid_at(&b, x, y);
+            }
+        }
+    }
+
+    conio_grid_free(&a);
+    conio_grid_free(&b);
+    free(spans);
+}
+
+static void check_sizes(const char* name) {
+    static const cpos_t widths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 33, 80, 401 };
+    size_t i;
+    for (i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) check_grid(name, widths[i], 6);
+}
+
+int main(void) {
+    conio_grid_t a, b;
+    conio_span_t span;
+
+    puts("Test: conio_grid_init, conio_grid_diff\n");
+    srand(1);
+
+    check_sizes("default");
+    __conio_row_span = __conio_row_span_scalar;
+    check_sizes("scalar");
+#ifdef CONIO_HAVE_SIMD
+    if (__builtin_cpu_supports("sse2")) {
+        __conio_row_span = __conio_row_span_sse2;
+        check_sizes("sse2");
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        __conio_row_span = __conio_row_span_avx2;
+        check_sizes("avx2");
+    }
+#endif  /* CONIO_HAVE_SIMD */
+
+    /* Grids of different sizes cannot be compared */
+    if (conio_grid_init(&a, 10, 2) != 0 || conio_grid_init(&b, 11, 2) != 0) return 1;
+    if (conio_grid_diff(&a, &b, &span) != -1 || conio_grid_at(&a, 11, 1) != NULL) {
+        fputs("conio_grid_diff: different sizes accepted\n", stderr);
+        failures++;
+    }
+    conio_grid_free(&a);
+    conio_grid_free(&b);
+    if (conio_grid_init(&a, 0, 2) != -1) {
+        fputs("conio_grid_init: empty grid accepted\n", stderr);
+        failures++;
+    }
+
+    return test_result();
+}
@@ -0,0 +1,98 @@
+/**
+ * @file test_input.c
+ *
+ * @brief Test for the input read-ahead buffer shared by `getch()`, `kbhit()`,
+ *        `ungetch()`, `cgets()` and `cscanf()`, and for the reads with a timeout
+ *        (`getch_timeout()`, `getch_n()`).
+ *
+ * The input is queued in the in-memory terminal or written to a pipe, this test
+ * runs unattended.
+ */
+
+#include "test_util.h"
+#include <unistd.h>
+
+int main(void) {
+    static char paste[10240];
+    test_backend_t c;
+    char buf[16], word[16];
+    conio_term_t* term;
+    unsigned long start;
+    int i, n, pos, fds[2];
+
+    puts("Test: input read-ahead\n");
+    if (tb_init(&c, 80, 24) != 0) return 1;
+    conio_set_backend(&c.backend);
+
+    /* A paste is read in chunks of the buffer size */
+    for (i = 0; i < (int)sizeof(paste); i++) paste[i] = (char)('a' + i % 26);
+    conio_vterm_feed(&c.vt, paste, sizeof(paste));
+    for (i = 0, n = 0; i < (int)sizeof(paste); i++) n += (getch() == paste[i]);
+    check(n == (int)sizeof(paste), "getch: the paste was altered");
+    check(c.reads <= (int)((sizeof(paste) + CONIO_INBUF_SIZE - 1) / CONIO_INBUF_SIZE),
+          "getch: too many reads for the paste");
+    check(!kbhit(), "kbhit: unexpected input");
+
+    /* A line longer than the buffer of cgets() is left for the next call */
+    conio_vterm_feed(&c.vt, "0123456789abcdefXYZ\nshort\n", 26);
+    buf[0] = (char)sizeof(buf);
+    check(cgets(buf) && strcmp(buf, "0123456789abcde") == 0, "cgets: wrong first part");
+    buf[0] = (char)sizeof(buf);
+    check(cgets(buf) && strcmp(buf, "fXYZ") == 0, "cgets: wrong rest");
+    buf[0] = (char)sizeof(buf);
+    check(cgets(buf) && strcmp(buf, "short") == 0, "cgets: wrong second line");
+
+    /* Pushed-back characters come first */
+    conio_vterm_feed(&c.vt, "ne\n", 3);
+    check(ungetch('o') == 'o' && kbhit(), "ungetch: nothing pushed back");
+    buf[0] = (char)sizeof(buf);
+    check(cgets(buf) && strcmp(buf, "one") == 0, "cgets: the pushed-back character was lost");
+
+    /* cscanf() drops the rest of a line longer than its buffer */
+    memset(paste, 'w', 300);
+    paste[300] = '\n';
+    conio_vterm_feed(&c.vt, paste, 301);
+    conio_vterm_feed(&c.vt, "17 next\n", 8);
+    check(cscanf((char*)"%15s", word) == 1 && word[0] == 'w', "cscanf: wrong long line");
+    check(cscanf((char*)"%d %15s", &n, word) == 2 && n == 17 && strcmp(word, "next") == 0,
+          "cscanf: the rest of the long line was not dropped");
+    check(getch() == EOF, "getch: expected the end of the input");
+
+    /* cscanf() reads on when the line runs out before the format */
+    conio_vterm_feed(&c.vt, "1\n\n 2 rest\n3\n", 13);
+    check(cscanf((char*)"%d %d%n", &n, &i, &pos) == 2 && n == 1 && i == 2 && pos == 5,
+          "cscanf: the input on the next lines was not read");
+    check(cscanf((char*)"%d", &n) == 1 && n == 3, "cscanf: the rest of the line was not dropped");
+    conio_vterm_feed(&c.vt, "x\n", 2);
+    check(cscanf((char*)"%d", &n) == 0, "cscanf: expected a matching failure");
+    check(cscanf((char*)"%d", &n) == EOF, "cscanf: expected the end of the input");
+
+    /* Reads with a timeout return what is available */
+    conio_vterm_feed(&c.vt, "k", 1);
+    check(getch_timeout(0) == 'k', "getch_timeout: expected a key");
+    check(getch_timeout(0) == CONIO_TIMEOUT, "getch_timeout: expected the timeout");
+    conio_vterm_feed(&c.vt, "abcdef", 6);
+    check(getch_n(buf, 4, 0) == 4 && memcmp(buf, "abcd", 4) == 0, "getch_n: expected 4 characters");
+    check(getch_n(buf, sizeof(buf), 0) == 2 && memcmp(buf, "ef", 2) == 0, "getch_n: expected the rest");
+    check(getch_n(buf, sizeof(buf), 0) == 0, "getch_n: expected the timeout");
+    conio_set_backend(NULL);
+
+    /* The timeout is honoured on a file descriptor, and the wait ends with the input */
+    if (pipe(fds) != 0 || !(term = conio_term_new(fds[0], STDOUT_FILENO))) return 1;
+    start = __conio_now_ms();
+    check(getch_timeout_ctx(term, 50) == CONIO_TIMEOUT, "getch_timeout_ctx: expected the timeout");
+    check(__conio_now_ms() - start >= 40, "getch_timeout_ctx: returned too early");
+    check(write(fds[1], "xyz", 3) == 3, "write: failed");
+    start = __conio_now_ms();
+    check(getch_n_ctx(term, buf, sizeof(buf), 5000) == 3 && memcmp(buf, "xyz", 3) == 0,
+          "getch_n_ctx: expected 3 characters");
+    check(__conio_now_ms() - start < 1000, "getch_n_ctx: waited despite the input");
+    close(fds[1]);
+    check(getch_n_ctx(term, buf, sizeof(buf), 5000) == -1, "getch_n_ctx: expected the end of the input");
+    conio_term_free(term);
+    close(fds[0]);
+
+    conio_vterm_free(&c.vt);
+
+    return test_result();
+}
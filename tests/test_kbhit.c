@@ -1,5 +1,5 @@
-#include <stdio.h>
 #include "../conio_lt.h"
+#include <stdio.h>
 
 int main(void) {
     long x = 1;
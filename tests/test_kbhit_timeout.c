@@ -0,0 +1,23 @@
+/**
+ * @file test_kbhit_timeout.c
+ *
+ * @brief Test for the `kbhit_timeout` function.
+ */
+
+#include "../conio_lt.h"
+#include <stdio.h>
+
+int main(void) {
+    int ticks = 0;
+    puts("Test: kbhit_timeout\n");
+    printf("Press any key to pass the test (ticking every 500 ms)...\n");
+
+    /* Sleep until a key is pressed or half a second has passed */
+    while (!kbhit_timeout(500)) {
+        printf("tick %d\n", ++ticks);
+    }
+    printf("Keyboard pressed: '%c'\n", getch());
+
+    printf("\n[Test Passed]\n");
+    return 0;
+}
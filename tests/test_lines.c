@@ -0,0 +1,144 @@
+/**
+ * @file test_lines.c
+ *
+ * @brief Test for the line functions (`dellines()`, `insline()`, `deletelines()`
+ *        and `scroll_region()`).
+ *
+ * The output goes to the in-memory terminal, this test runs unattended. The number
+ * of writes is counted to check that a range of lines is cleared at once.
+ */
+
+#include "test_util.h"
+
+static test_backend_t cnt;
+
+static void expect_row(cpos_t y, const char* expected) {
+    char line[128];
+    conio_vterm_row(&cnt.vt, y, line, sizeof(line));
+    if (strcmp(line, expected) != 0) {
+        fprintf(stderr, "row %d: expected \"%s\", got \"%s\"\n", (int)y, expected, line);
+        failures++;
+    }
+}
+
+static void expect_cursor(cpos_t x, cpos_t y) {
+    if (cnt.vt.x != x || cnt.vt.y != y) {
+        fprintf(stderr, "cursor: expected %d,%d, got %d,%d\n",
+                (int)x, (int)y, (int)cnt.vt.x, (int)cnt.vt.y);
+        failures++;
+    }
+}
+
+/* Writes "line N" on every row */
+static void fill(void) {
+    char buf[16];
+    cpos_t y;
+    for (y = 1; y <= cnt.vt.rows; y++) {
+        gotoxy(1, y);
+        snprintf(buf, sizeof(buf), "line %d", (int)y);
+        cputs(buf);
+    }
+}
+
+static void run(int tracked) {
+    fill();
+    gotoxy(5, 3);
+
+    /* A range in the middle of the screen, written at once without queries */
+    cnt.writes = cnt.queries = 0;
+    dellines(8, 4);
+    if (cnt.writes != 1 || cnt.queries != 0) {
+        fprintf(stderr, "dellines (tracked: %d): %d writes, %d queries\n",
+                tracked, cnt.writes, cnt.queries);
+        failures++;
+    }
+    expect_row(3, "line 3");
+    expect_row(4, "");
+    expect_row(8, "");
+    expect_row(9, "line 9");
+    expect_row(12, "line 12");
+    expect_cursor(1, 3);
+
+    /* A single line, and a range reaching the bottom of the screen */
+    dellines(2, 2);
+    expect_row(1, "line 1");
+    expect_row(2, "");
+    dellines(10, 100);
+    expect_row(9, "line 9");
+    expect_row(10, "");
+    expect_row(12, "");
+    expect_cursor(1, 3);
+    if (wherey() != 3) {
+        fprintf(stderr, "wherey (tracked: %d): expected 3\n", tracked);
+        failures++;
+    }
+
+    /* Inserting and deleting lines at the cursor */
+    fill();
+    gotoxy(4, 2);
+    insline();
+    expect_row(2, "");
+    expect_row(3, "line 2");
+    expect_row(12, "line 11");
+    expect_cursor(1, 2);
+    deletelines(3);
+    expect_row(2, "line 4");
+    expect_row(9, "line 11");
+    expect_row(10, "");
+    deletelines(0);  /* Nothing */
+    expect_row(2, "line 4");
+
+    /* Scrolling inside a region, the rows outside stay */
+    fill();
+    scroll_region(3, 6);
+    expect_cursor(1, 1);
+    gotoxy(1, 6);
+    cputs((char*)"\nnew");
+    expect_row(2, "line 2");
+    expect_row(3, "line 4");
+    expect_row(5, "line 6");
+    expect_row(6, "new");
+    expect_row(7, "line 7");
+    gotoxy(1, 4);
+    deletelines(10);
+    expect_row(3, "line 4");
+    expect_row(4, "");
+    expect_row(7, "line 7");
+    if (wherex() != cnt.vt.x || wherey() != cnt.vt.y) {
+        fprintf(stderr, "scroll_region (tracked: %d): the cursor is lost\n", tracked);
+        failures++;
+    }
+
+    /* Clearing lines keeps the region */
+    fill();
+    gotoxy(1, 4);
+    dellines(9, 10);
+    expect_row(9, "");
+    gotoxy(1, 6);
+    cputs((char*)"\nnext");
+    expect_row(5, "line 6");
+    expect_row(6, "next");
+    expect_row(7, "line 7");
+
+    scroll_region(0, 0);
+    if (cnt.vt.top != 1 || cnt.vt.bottom != cnt.vt.rows) {
+        fprintf(stderr, "scroll_region(0, 0): the region was not removed\n");
+        failures++;
+    }
+}
+
+int main(void) {
+    puts("Test: dellines, insline, deletelines, scroll_region\n");
+    if (tb_init(&cnt, 40, 12) != 0) return 1;
+    conio_set_backend(&cnt.backend);
+
+    run(0);
+    conio_cursor_track(1);
+    run(1);
+    conio_cursor_track(0);
+
+    conio_set_backend(NULL);
+    conio_vterm_free(&cnt.vt);
+
+    return test_result();
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test_loop.c
+ *
+ * @brief Test for the `conio_loop_*` event loop functions.
+ *
+ * The keys are read from a pipe, which also ends the loop when it is closed.
+ * This test runs unattended.
+ */
+
+#define CONIO_ESC_DELAY  200  /* Long enough to tell waiting from dispatching */
+#include "test_util.h"
+
+#ifdef CONIO_HAVE_LOOP
+typedef struct {
+    int  input;         /* Write end of the key pipe */
+    int  data;          /* Read end of the application pipe */
+    int  once;          /* Identifier of the one-shot timer */
+    int  tick;          /* Identifier of the periodic timer */
+    int  doomed;        /* Identifier of the timer removed before it expires */
+    int  ticks;         /* Expirations of the periodic timer */
+    int  onces;         /* Expirations of the one-shot timer */
+    int  dooms;         /* Expirations of the removed timer */
+    int  reads;         /* Events of the application pipe */
+    char keys[16];      /* Keys received, ESC as 'E' */
+    int  nkeys;
+} state_t;
+
+static void on_key(conio_loop_t* loop, const conio_event_t* ev, void* user) {
+    state_t* st = (state_t*)user;
+    (void)loop;
+    if (st->nkeys < (int)sizeof(st->keys) - 1)
+        st->keys[st->nkeys++] = (ev->key == CONIO_KEY_CHAR) ? (char)ev->codepoint
+                              : (ev->key == CONIO_KEY_ESCAPE) ? 'E' : '?';
+}
+
+/* Removes itself after the third expiration */
+static void on_tick(conio_loop_t* loop, int id, void* user) {
+    state_t* st = (state_t*)user;
+    check(id == st->tick, "on_tick: wrong timer identifier");
+    if (++st->ticks == 3)
+        check(conio_loop_remove_timer(loop, id) == 0, "conio_loop_remove_timer: periodic timer not removed");
+}
+
+static void on_doomed(conio_loop_t* loop, int id, void* user) {
+    (void)loop; (void)id;
+    ((state_t*)user)->dooms++;
+}
+
+/* Ends the input, after checking that the identifier is not reused by a new timer */
+static void on_once(conio_loop_t* loop, int id, void* user) {
+    state_t* st = (state_t*)user;
+    int other;
+
+    st->onces++;
+    check(id == st->once, "on_once: wrong timer identifier");
+    other = conio_loop_add_timer(loop, 1000, 0, on_doomed, st);
+    check(other > 0 && other != id && other != st->tick && other != st->doomed,
+          "conio_loop_add_timer: identifier reused");
+    check(conio_loop_remove_timer(loop, id) == -1, "conio_loop_remove_timer: one-shot timer still registered");
+    check(conio_loop_remove_timer(loop, other) == 0, "conio_loop_remove_timer: new timer not removed");
+    close(st->input);
+}
+
+/* Removes the file descriptor and the doomed timer on the first event */
+static void on_data(conio_loop_t* loop, int fd, int events, void* user) {
+    state_t* st = (state_t*)user;
+    char c;
+
+    st->reads++;
+    check(fd == st->data && (events & CONIO_LOOP_READ) && read(fd, &c, 1) == 1 && c == 'z',
+          "on_data: wrong event");
+    check(conio_loop_remove_fd(loop, fd) == 0, "conio_loop_remove_fd: not removed");
+    check(conio_loop_remove_timer(loop, st->doomed) == 0, "conio_loop_remove_timer: timer not removed");
+}
+#endif  /* CONIO_HAVE_LOOP */
+
+int main(void) {
+#ifdef CONIO_HAVE_LOOP
+    int keys[2], data[2], null;
+    unsigned long start;
+    conio_term_t* term;
+    conio_loop_t* loop;
+    state_t st;
+
+    puts("Test: conio_loop\n");
+    null = open("/dev/null", O_WRONLY);
+    if (null < 0 || pipe(keys) != 0 || pipe(data) != 0) return 1;
+    memset(&st, 0, sizeof(st));
+    st.input = keys[1];
+    st.data = data[0];
+
+    term = conio_term_new(keys[0], null);
+    loop = conio_loop_new_ctx(term);
+    if (!term || !loop) return 1;
+    check(conio_loop_on_key(loop, on_key, &st) == 0, "conio_loop_on_key: input not watched");
+
+    /* A lone escape waits for the rest of a sequence without blocking the loop */
+    if (write(keys[1], "\033", 1) != 1) return 1;
+    start = __conio_now_ms();
+    conio_loop_run_once(loop, 0);
+    check(__conio_now_ms() - start < CONIO_ESC_DELAY / 2 && st.nkeys == 0,
+          "conio_loop_run_once: blocked on an escape");
+    while (st.nkeys == 0 && __conio_now_ms() - start < 5 * CONIO_ESC_DELAY) conio_loop_run_once(loop, -1);
+    check(st.nkeys == 1 && st.keys[0] == 'E' && __conio_now_ms() - start >= CONIO_ESC_DELAY,
+          "conio_loop_run_once: escape not delivered after the delay");
+
+    /* Timers and file descriptors, removed by the callbacks; the end of the input stops the loop */
+    st.tick = conio_loop_add_timer(loop, 10, 1, on_tick, &st);
+    st.once = conio_loop_add_timer(loop, 200, 0, on_once, &st);
+    st.doomed = conio_loop_add_timer(loop, 100, 0, on_doomed, &st);
+    check(st.tick > 0 && st.once > 0 && st.doomed > 0, "conio_loop_add_timer: failed");
+    check(conio_loop_add_fd(loop, data[0], CONIO_LOOP_READ, on_data, &st) == 0, "conio_loop_add_fd: failed");
+    if (write(keys[1], "ab", 2) != 2 || write(data[1], "zz", 2) != 2) return 1;
+    check(conio_loop_run(loop) == 0, "conio_loop_run: failed");
+
+    st.keys[st.nkeys] = '\0';
+    check(strcmp(st.keys, "Eab") == 0, "conio_loop_run: wrong keys");
+    check(st.ticks == 3, "conio_loop_run: periodic timer not run three times");
+    check(st.onces == 1 && st.dooms == 0, "conio_loop_run: wrong one-shot timers run");
+    check(st.reads == 1, "conio_loop_run: removed file descriptor still watched");
+    check(conio_loop_on_key(loop, NULL, NULL) == 0 && conio_loop_run_once(loop, 0) == 0,
+          "conio_loop_run_once: events left after the end of the input");
+
+    conio_loop_free(loop);
+    conio_term_free(term);
+    close(keys[0]);
+    close(data[0]);
+    close(data[1]);
+    close(null);
+
+    return test_result();
+#else
+    puts("Test: conio_loop (not available on this platform)");
+    return 0;
+#endif  /* CONIO_HAVE_LOOP */
+}
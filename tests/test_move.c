@@ -0,0 +1,94 @@
+/**
+ * @file test_move.c
+ *
+ * @brief Test for the cursor movements chosen by `gotoxy()` and `conio_present()`
+ *        when the cursor position is tracked.
+ *
+ * The output goes to the in-memory terminal, this test runs unattended.
+ */
+
+#include "test_util.h"
+#include <stdlib.h>
+
+static test_backend_t rec;
+
+/* Moves the cursor and checks the bytes written for it */
+static void expect_move(cpos_t x, cpos_t y, const char* expected) {
+    rec.len = 0;
+    gotoxy(x, y);
+    rec.out[rec.len] = '\0';
+    if (strcmp(rec.out, expected) != 0) {
+        fprintf(stderr, "gotoxy(%d, %d): expected %d bytes, got %d\n",
+                (int)x, (int)y, (int)strlen(expected), (int)rec.len);
+        failures++;
+    }
+}
+
+int main(void) {
+    int i;
+
+    puts("Test: cursor movements\n");
+    if (tb_init(&rec, 80, 24) != 0) return 1;
+    conio_set_backend(&rec.backend);
+    conio_cursor_track(1);
+
+    gotoxy(10, 5);
+    expect_move(10, 5, "");                 /* Already there */
+    expect_move(11, 5, "\033[C");           /* One column to the right */
+    expect_move(9, 5, "\b\b");              /* Two columns to the left */
+    expect_move(1, 6, "\n");                /* Start of the next line */
+    expect_move(1, 5, "\033[A");            /* One row up */
+    expect_move(40, 5, "\033[40G");         /* Same row, far away */
+    expect_move(40, 20, "\033[15B");        /* Same column, far away */
+    expect_move(3, 21, "\n\033[3G");        /* Next line, a few columns in */
+    expect_move(70, 2, "\033[2;70H");       /* Nothing shorter than an absolute position */
+
+    /* Random movements always end up where the terminal is */
+    srand(1);
+    for (i = 0; i < 2000; i++) {
+        cpos_t x = (cpos_t)(rand() % 82), y = (cpos_t)(rand() % 26);
+        gotoxy(x, y);
+        if (i % 3 == 0) cputs((char*)"ab");
+        if (rec.vt.x != wherex() || rec.vt.y != wherey()) {
+            fprintf(stderr, "move %d: the terminal is at %d,%d, tracked %d,%d\n",
+                    i, (int)rec.vt.x, (int)rec.vt.y, (int)wherex(), (int)wherey());
+            failures++;
+            break;
+        }
+    }
+
+    /* Presenting rewrites the unchanged cells in between when that is shorter */
+    conio_screen_init(0, 0);
+    conio_screen_puts(1, 1, "load: 1", CONIO_ATTR_DEFAULT);
+    conio_screen_puts(1, 2, "ab-", CONIO_ATTR_DEFAULT);
+    conio_present();
+    conio_screen_puts(7, 1, "2", CONIO_ATTR_DEFAULT);
+    conio_screen_puts(3, 2, "+", CONIO_ATTR_DEFAULT);
+    rec.len = 0;
+    conio_present();
+    rec.out[rec.len] = '\0';
+    if (!strstr(rec.out, "2\nab+")) {
+        fprintf(stderr, "conio_present: unexpected movements\n");
+        failures++;
+    }
+    {
+        char line[128];
+        conio_vterm_row(&rec.vt, 1, line, sizeof(line));
+        if (strcmp(line, "load: 2") != 0) {
+            fprintf(stderr, "conio_present: got \"%s\"\n", line);
+            failures++;
+        }
+        conio_vterm_row(&rec.vt, 2, line, sizeof(line));
+        if (strcmp(line, "ab+") != 0) {
+            fprintf(stderr, "conio_present: got \"%s\"\n", line);
+            failures++;
+        }
+    }
+    conio_screen_free();
+
+    conio_cursor_track(0);
+    conio_set_backend(NULL);
+    conio_vterm_free(&rec.vt);
+
+    return test_result();
+}
@@ -0,0 +1,118 @@
+/**
+ * @file test_probe.c
+ *
+ * @brief Test for the capability probe (`conio_probe()`).
+ *
+ * The in-memory terminal answers the probe; its replies arrive one byte at a time,
+ * mixed with key presses. Other terminals answer like a VT100 or not at all.
+ * This test runs unattended.
+ */
+
+#include "test_util.h"
+
+enum { ANSWER_ALL, ANSWER_VT100, ANSWER_VT100_ALT_P, ANSWER_NONE };
+
+/* Passes the output to the emulator, which answers the probe in the given way */
+static int pr_filter(test_backend_t* t, const char* s, size_t n) {
+    if (n >= 3 && memcmp(s, "\033[c", 3) == 0) {
+        t->probes++;
+        if (t->answer == ANSWER_VT100_ALT_P) conio_vterm_feed(&t->vt, "\033P", 2);  /* Alt+Shift+P */
+        if (t->answer == ANSWER_VT100 || t->answer == ANSWER_VT100_ALT_P) {
+            conio_vterm_feed(&t->vt, "\033[?1;2c\033[1;1R", 13);
+            return 0;
+        }
+        if (t->answer == ANSWER_NONE) return 0;
+        conio_vterm_feed(&t->vt, "a", 1);  /* Typed while the probe is under way */
+        conio_vterm_write(&t->vt, s, n);
+        conio_vterm_feed(&t->vt, "b", 1);
+        return 0;
+    }
+    conio_vterm_write(&t->vt, s, n);
+    return 0;
+}
+
+/* The replies are served one byte at a time */
+static int pr_init(test_backend_t* t, int answer) {
+    if (tb_init(t, 80, 24) != 0) return -1;
+    t->filter = pr_filter;
+    t->bytewise = 1;
+    t->answer = answer;
+    return 0;
+}
+
+int main(void) {
+    test_backend_t full, vt100, alt_p, mute;
+    conio_term_t *t2, *t3, *t4;
+    conio_probe_t info, again;
+    unsigned long start;
+    conio_event_t ev;
+    cpos_t x = 0, y = 0;
+
+    puts("Test: conio_probe\n");
+    if (pr_init(&full, ANSWER_ALL) != 0 || pr_init(&vt100, ANSWER_VT100) != 0
+        || pr_init(&alt_p, ANSWER_VT100_ALT_P) != 0 || pr_init(&mute, ANSWER_NONE) != 0) return 1;
+
+    /* Every reply is parsed, the keys typed meanwhile are kept */
+    conio_set_backend(&full.backend);
+    gotoxy(5, 3);
+    check(conio_probe(&info) == 0 && info.answered, "conio_probe: no answer");
+    check(info.level == 62 && info.type == 1 && info.version == 10, "conio_probe: wrong device attributes");
+    check(strcmp(info.name, "conio_vterm") == 0, "conio_probe: wrong name");
+    check(info.sync == 2 && info.paste == 0 && info.altscreen == 0 && info.focus == 0,
+          "conio_probe: wrong modes");
+    check(info.x == 5 && info.y == 3, "conio_probe: wrong cursor position");
+    check(info.caps == (CONIO_CAP_EL | CONIO_CAP_ECH | CONIO_CAP_REP | CONIO_CAP_SYNC)
+          && conio_getcaps() == info.caps, "conio_probe: wrong capabilities");
+    check(getch() == 'a' && getch() == 'b', "conio_probe: the keys typed meanwhile were lost");
+
+    /* The results are cached */
+    check(conio_probe(&again) == 0 && full.probes == 1, "conio_probe: probed twice");
+    check(memcmp(&info, &again, sizeof(info)) == 0, "conio_probe: different cached results");
+    check(conio_frame_begin() == 1 && full.probes == 1, "conio_frame_begin: probed again");
+    conio_frame_end();
+    conio_set_backend(NULL);
+
+    /* A VT100 only answers the device attributes and cursor position requests */
+    t2 = conio_term_new(-1, -1);
+    conio_set_backend_ctx(t2, &vt100.backend);
+    check(conio_probe_ctx(t2, &info) == 0, "conio_probe_ctx: no answer from the VT100");
+    check(info.level == 1 && info.type == -1 && info.name[0] == '\0' && info.sync == 0,
+          "conio_probe_ctx: wrong VT100 replies");
+    check(conio_getcaps_ctx(t2) == CONIO_CAP_EL, "conio_probe_ctx: wrong VT100 capabilities");
+    check(!kbhit_ctx(t2), "conio_probe_ctx: replies left in the input");
+
+    /* Alt+Shift+P ("\033P") is a key, not the beginning of a device control string */
+    t4 = conio_term_new(-1, -1);
+    conio_set_backend_ctx(t4, &alt_p.backend);
+    start = __conio_now_ms();
+    check(conio_probe_ctx(t4, &info) == 0 && info.level == 1, "conio_probe_ctx: no answer after Alt+Shift+P");
+    check(__conio_now_ms() - start < CONIO_QUERY_TIMEOUT, "conio_probe_ctx: waited for a string terminator");
+    check(getch_ctx(t4) == 0x1B && getch_ctx(t4) == 'P' && !kbhit_ctx(t4), "conio_probe_ctx: Alt+Shift+P was lost");
+
+    /* A terminal that answers nothing keeps the declared capabilities */
+    t3 = conio_term_new(-1, -1);
+    conio_set_backend_ctx(t3, &mute.backend);
+    conio_setcaps_ctx(t3, CONIO_CAP_EL | CONIO_CAP_ECH);
+    check(conio_probe_ctx(t3, &info) == -1 && !info.answered, "conio_probe_ctx: unexpected answer");
+    check(conio_getcaps_ctx(t3) == (CONIO_CAP_EL | CONIO_CAP_ECH), "conio_probe_ctx: capabilities changed");
+    check(conio_probe_ctx(t3, NULL) == -1 && mute.probes == 1, "conio_probe_ctx: probed twice");
+
+    /* The replies arriving after the timeout are neither keys nor answers to later queries */
+    conio_vterm_feed(&mute.vt, "\033[?62;22c\033[>1;10;0c\033P>|late\033\\\033[5;1R", 35);
+    gotoxy_ctx(t3, 7, 4);
+    wherexy_ctx(t3, &x, &y);
+    check(x == 7 && y == 4, "conio_probe_ctx: the late position report answered wherexy");
+    conio_vterm_feed(&mute.vt, "x", 1);
+    check(conio_read_event_ctx(t3, &ev) == 0 && ev.key == CONIO_KEY_CHAR && ev.codepoint == 'x'
+          && !kbhit_ctx(t3), "conio_probe_ctx: late replies read as keys");
+
+    conio_term_free(t2);
+    conio_term_free(t3);
+    conio_term_free(t4);
+    conio_vterm_free(&full.vt);
+    conio_vterm_free(&vt100.vt);
+    conio_vterm_free(&alt_p.vt);
+    conio_vterm_free(&mute.vt);
+
+    return test_result();
+}
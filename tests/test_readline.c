@@ -0,0 +1,119 @@
+/**
+ * @file test_readline.c
+ *
+ * @brief Test for the line editor (`conio_readline()`).
+ *
+ * The keys are queued in an in-memory terminal, which records what is written to
+ * it; the screen is checked after every line. This test runs unattended.
+ */
+
+#include "test_util.h"
+#include <unistd.h>
+
+static test_backend_t rec;
+static char buf[66];
+
+/* Types the keys at a prompt on a cleared screen and reads the line */
+static const char* edit(const char* keys) {
+    clrscr();
+    cputs("> ");
+    rec.len = 0;
+    conio_vterm_feed(&rec.vt, keys, strlen(keys));
+    buf[0] = 64;
+    buf[1] = 0;
+    return conio_readline(buf);
+}
+
+static int row_is(cpos_t y, const char* s) {
+    char line[64];
+    conio_vterm_row(&rec.vt, y, line, sizeof(line));
+    return strcmp(line, s) == 0;
+}
+
+int main(void) {
+    const char* line;
+    conio_term_t* term;
+    char small[8];
+    cpos_t x = 0, y = 0;
+    int fds[2];
+
+    puts("Test: conio_readline\n");
+    if (tb_init(&rec, 20, 6) != 0) return 1;
+    conio_set_backend(&rec.backend);
+
+    /* Typed characters are echoed as they are, the line goes to the buffer */
+    line = edit("abd\033[Dc\r");
+    check(line == buf + 2 && strcmp(line, "abcd") == 0 && buf[1] == 4, "conio_readline: wrong line");
+    check(rec.len == 14 && memcmp(rec.out, "\033[6nabd\bcd\bd\r\n", 14) == 0,
+          "conio_readline: the redraw is not minimal");
+    check(row_is(1, "> abcd") && rec.vt.y == 2 && rec.vt.x == 1, "conio_readline: wrong screen");
+
+    /* Moves and insertions */
+    line = edit("wrld\033[D\033[D\033[Do\033[Hhello \033[F!\r");
+    check(strcmp(line, "hello world!") == 0 && row_is(1, "> hello world!"), "conio_readline: wrong edit");
+
+    /* Words, kill and yank; what is left of the longer line is erased */
+    line = edit("one two three\027\001\031\033[1;5C\033[1;5C\013\r");
+    check(strcmp(line, "threeone two") == 0 && row_is(1, "> threeone two"), "conio_readline: wrong kill and yank");
+    line = edit("alpha beta\033b\033d\177\r");
+    check(strcmp(line, "alpha") == 0 && row_is(1, "> alpha"), "conio_readline: wrong word deletion");
+
+    /* History, with the new line kept while browsing */
+    line = edit("\033[A\033[A\r");
+    check(strcmp(line, "threeone two") == 0 && row_is(1, "> threeone two"), "conio_readline: wrong history");
+    line = edit("new\033[A\033[A\033[B\033[B\r");
+    check(strcmp(line, "new") == 0 && row_is(1, "> new"), "conio_readline: the new line was lost");
+    line = edit("\020\020\020\020\020\r");
+    check(strcmp(line, "hello world!") == 0, "conio_readline: wrong older line");
+
+    /* A line wrapping across rows, edited at the start and shortened */
+    line = edit("0123456789abcdefghijklmnopqrstuv\033[HX\033[F\177\177\177\177\177\177\177\177\177\177\177\177\177\177\177\r");
+    check(strcmp(line, "X0123456789abcdefg") == 0, "conio_readline: wrong long line");
+    check(row_is(1, "> X0123456789abcdefg") && row_is(2, ""), "conio_readline: wrong wrapped screen");
+    line = edit("0123456789abcdefghijklmnopq\033[H\033[3~\r");
+    check(strcmp(line, "123456789abcdefghijklmnopq") == 0, "conio_readline: wrong deletion");
+    check(row_is(1, "> 123456789abcdefghi") && row_is(2, "jklmnopq"), "conio_readline: wrong wrapped deletion");
+
+    /* The length is bounded, the end of the input ends the line */
+    clrscr();
+    conio_vterm_feed(&rec.vt, "abcdefgh", 8);
+    small[0] = 5;
+    small[1] = 0;
+    check((line = conio_readline(small)) && strcmp(line, "abcd") == 0 && small[1] == 4,
+          "conio_readline: the maximum length was exceeded");
+    check(edit("") == NULL, "conio_readline: expected the end of the input");
+
+    /* Existing text is edited in place */
+    clrscr();
+    conio_vterm_feed(&rec.vt, "\033[D!\r", 5);
+    memcpy(buf + 2, "draft", 5);
+    buf[0] = 64;
+    buf[1] = 5;
+    check((line = conio_readline(buf)) && strcmp(line, "draf!t") == 0 && row_is(1, "draf!t"),
+          "conio_readline: the existing text was not edited");
+
+    /* A reply that has not come when the line ends is dropped when it comes */
+    rec.mute = 1;
+    line = edit("ok\r");
+    rec.mute = 0;
+    conio_vterm_feed(&rec.vt, "\033[1;3Rk", 7);
+    check(line && strcmp(line, "ok") == 0 && getch() == 'k', "conio_readline: wrong line without the reply");
+    check(conio_cursor_query() == 0 && conio_cursor_reply(&x, &y, 100) == 1 && x == 1 && y == 2,
+          "conio_readline: the late reply was taken for the next one");
+    conio_set_backend(NULL);
+
+    /* Input that is not a terminal is read without editing */
+    if (pipe(fds) != 0 || !(term = conio_term_new(fds[0], fds[1]))) return 1;
+    check(write(fds[1], "plain\033[D\nrest", 13) == 13, "write: failed");
+    close(fds[1]);
+    buf[0] = 64;
+    buf[1] = 0;
+    check((line = conio_readline_ctx(term, buf)) && strcmp(line, "plain\033[D") == 0 && buf[1] == 8,
+          "conio_readline_ctx: wrong line from a pipe");
+    conio_term_free(term);
+    close(fds[0]);
+
+    conio_vterm_free(&rec.vt);
+
+    return test_result();
+}
@@ -0,0 +1,37 @@
+/**
+ * @file test_screen.c
+ *
+ * @brief Test for the off-screen buffer and `conio_present` function.
+ */
+
+#include "../conio_lt.h"
+#include <stdio.h>
+
+int main(void) {
+    int i;
+    char counter[32];
+
+    if (conio_screen_init(40, 8) != 0) {
+        puts("Unable to allocate the off-screen buffer.");
+        return 1;
+    }
+
+    clrscr();
+    conio_screen_puts(1, 1, "Test: conio_present", CONIO_ATTR_BOLD);
+    conio_screen_puts(1, 3, "Counter:", CONIO_ATTR_DEFAULT);
+    conio_screen_puts(1, 5, "Press any key to increment...", CONIO_FG(2));
+    conio_present();  /* The first frame is written in full */
+
+    for (i = 1; i <= 5; i++) {
+        getch();
+        /* Only the digits of the counter are written to the terminal */
+        snprintf(counter, sizeof(counter), "%d", i * 100);
+        conio_screen_puts(10, 3, counter, CONIO_FG(3) | CONIO_ATTR_REVERSE);
+        conio_present();
+    }
+
+    conio_screen_free();
+    gotoxy(1, 7);
+    printf("\n[Test Passed]\n");
+    return 0;
+}
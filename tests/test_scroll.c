@@ -0,0 +1,123 @@
+/**
+ * @file test_scroll.c
+ *
+ * @brief Test for the scroll detection of `conio_present()`.
+ *
+ * A log view scrolls one line per frame; only about one line should be written
+ * per frame, and the terminal must always show the off-screen buffer. The output
+ * goes to the in-memory terminal, this test runs unattended.
+ */
+
+#include "test_util.h"
+#include <stdlib.h>
+
+#define COLS  60
+#define ROWS  20
+
+static test_backend_t cnt;
+static char lines[ROWS][COLS + 1];
+
+/* Draws the lines into the off-screen buffer and presents them */
+static size_t draw(const char* what) {
+    cpos_t y, x;
+    char row[COLS + 1];
+
+    conio_screen_clear(CONIO_ATTR_DEFAULT);
+    for (y = 1; y <= ROWS; y++) conio_screen_puts(1, y, lines[y - 1], CONIO_ATTR_DEFAULT);
+    cnt.bytes = 0;
+    conio_present();
+
+    for (y = 1; y <= ROWS; y++) {
+        conio_vterm_row(&cnt.vt, y, row, sizeof(row));
+        if (strcmp(row, lines[y - 1]) != 0) {
+            fprintf(stderr, "%s: row %d: expected \"%s\", got \"%s\"\n",
+                    what, (int)y, lines[y - 1], row);
+            failures++;
+            break;
+        }
+    }
+    x = wherex();
+    if (x != cnt.vt.x || wherey() != cnt.vt.y) {
+        fprintf(stderr, "%s: the cursor is lost\n", what);
+        failures++;
+    }
+    return cnt.bytes;
+}
+
+/* Moves the lines first..last of the log up by one and adds a new one */
+static void log_line(int first, int last, int n) {
+    memmove(lines[first - 1], lines[first], (size_t)(last - first) * sizeof(lines[0]));
+    snprintf(lines[last - 1], sizeof(lines[0]), "%05d  request served in %d ms", n, n % 97);
+}
+
+int main(void) {
+    size_t bytes, most = 0;
+    int i, y;
+
+    puts("Test: conio_present scroll detection\n");
+    if (tb_init(&cnt, COLS, ROWS) != 0) return 1;
+    conio_set_backend(&cnt.backend);
+    conio_cursor_track(1);
+    if (conio_screen_init(0, 0) != 0) return 1;
+
+    /* The whole screen scrolls */
+    for (y = 1; y <= ROWS; y++) log_line(1, ROWS, y);
+    bytes = draw("first frame");
+    for (i = 0; i < 50; i++) {
+        log_line(1, ROWS, ROWS + 1 + i);
+        bytes = draw("full screen");
+        if (bytes > most) most = bytes;
+    }
+    if (most > 2 * COLS) {
+        fprintf(stderr, "full screen: up to %d bytes per frame\n", (int)most);
+        failures++;
+    }
+
+    /* A header and a status line stay, the lines in between scroll */
+    snprintf(lines[0], sizeof(lines[0]), "== server log ==");
+    snprintf(lines[ROWS - 1], sizeof(lines[0]), "status: ok");
+    draw("header");
+    most = 0;
+    for (i = 0; i < 50; i++) {
+        log_line(2, ROWS - 1, 100 + i);
+        bytes = draw("region");
+        if (bytes > most) most = bytes;
+    }
+    if (most > 2 * COLS) {
+        fprintf(stderr, "region: up to %d bytes per frame\n", (int)most);
+        failures++;
+    }
+
+    /* Scrolling back down */
+    memmove(lines[2], lines[1], (size_t)(ROWS - 3) * sizeof(lines[0]));
+    snprintf(lines[1], sizeof(lines[0]), "older line");
+    bytes = draw("down");
+    if (bytes > 2 * COLS) {
+        fprintf(stderr, "down: %d bytes\n", (int)bytes);
+        failures++;
+    }
+
+    /* Random changes, the terminal always shows the buffer */
+    srand(1);
+    for (i = 0; i < 500; i++) {
+        int a = 1 + rand() % ROWS, b = 1 + rand() % ROWS, k = 1 + rand() % 3;
+        if (a > b) { y = a; a = b; b = y; }
+        if (rand() % 2 && b - a > k) {
+            for (y = 0; y < k; y++) log_line(a, b, 1000 + i);
+        } else {
+            for (y = a; y <= b; y++) {
+                if (rand() % 2) snprintf(lines[y - 1], sizeof(lines[0]), "edit %d", rand() % 10);
+                else lines[y - 1][0] = '\0';
+            }
+        }
+        draw("random");
+        if (failures) break;
+    }
+
+    conio_screen_free();
+    conio_cursor_track(0);
+    conio_set_backend(NULL);
+    conio_vterm_free(&cnt.vt);
+
+    return test_result();
+}
@@ -0,0 +1,93 @@
+/**
+ * @file test_server.c
+ *
+ * @brief Test for terminals served by the event loop (`conio_loop_add_term`).
+ *
+ * The terminals are socket pairs, this test runs unattended.
+ */
+
+#include "test_util.h"
+
+#ifdef CONIO_HAVE_LOOP
+#include <sys/socket.h>
+
+#define NTERMS  3
+
+static int hangups = 0;
+
+/* Echoes every key at the top left corner of its terminal */
+static void on_key(conio_loop_t* loop, conio_term_t* term, const conio_event_t* ev, void* user) {
+    (void)loop; (void)user;
+    if (!ev) {
+        hangups++;
+        conio_term_free(term);
+        return;
+    }
+    gotoxy_ctx(term, 1, 1);
+    if (ev->key == CONIO_KEY_CHAR) putch_ctx(term, (int)ev->codepoint);
+    else if (ev->key == CONIO_KEY_UP) cputs_ctx(term, (char*)"UP");
+    else cputs_ctx(term, (char*)"ESC");
+}
+
+/* Reads what the loop wrote to a client */
+static void expect(int fd, const char* expected) {
+    char buf[64];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    buf[n > 0 ? n : 0] = '\0';
+    if (strcmp(buf, expected) != 0) {
+        fprintf(stderr, "fd %d: expected \"%s\", got \"%s\"\n", fd, expected, buf);
+        failures++;
+    }
+}
+#endif  /* CONIO_HAVE_LOOP */
+
+int main(void) {
+#ifdef CONIO_HAVE_LOOP
+    int fds[NTERMS][2], i;
+    conio_term_t* terms[NTERMS];
+    conio_loop_t* loop;
+
+    puts("Test: conio_loop_add_term, conio_loop_remove_term\n");
+    loop = conio_loop_new();
+    if (!loop) return 1;
+    for (i = 0; i < NTERMS; i++) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]) != 0) return 1;
+        terms[i] = conio_term_new(fds[i][1], fds[i][1]);
+        if (!terms[i] || conio_loop_add_term(loop, terms[i], on_key, NULL) != 0) return 1;
+    }
+
+    /* Keys of each client are answered on its own terminal, in one write */
+    if (write(fds[0][0], "a", 1) != 1 || write(fds[2][0], "\033[A", 3) != 3) return 1;
+    while (conio_loop_run_once(loop, 100) > 0) {}
+    expect(fds[0][0], "\033[1;1Ha");
+    expect(fds[2][0], "\033[1;1HUP");
+
+    /* A lone escape is delivered once the escape delay has passed */
+    if (write(fds[1][0], "\033", 1) != 1) return 1;
+    conio_loop_run_once(loop, 100);
+    conio_loop_run_once(loop, 100);
+    expect(fds[1][0], "\033[1;1HESC");
+
+    /* A client that goes away is hung up */
+    close(fds[1][0]);
+    conio_loop_run_once(loop, 100);
+    if (hangups != 1) {
+        fprintf(stderr, "expected 1 hang-up, got %d\n", hangups);
+        failures++;
+    }
+
+    conio_loop_free(loop);
+    for (i = 0; i < NTERMS; i++) {
+        if (i != 1) {  /* The other one has been freed by its callback */
+            conio_term_free(terms[i]);
+            close(fds[i][0]);
+        }
+        close(fds[i][1]);
+    }
+
+    return test_result();
+#else
+    puts("Test: conio_loop_add_term (not available on this platform)");
+    return 0;
+#endif  /* CONIO_HAVE_LOOP */
+}
@@ -0,0 +1,34 @@
+/**
+ * @file test_session.c
+ *
+ * @brief Test for `conio_session_begin` and `conio_session_end` functions.
+ */
+
+#include "../conio_lt.h"
+#include <stdio.h>
+
+int main(void) {
+    puts("Test: conio_session_begin, conio_session_end\n");
+
+    if (conio_session_begin() != 0) {
+        puts("Standard input is not a terminal, skipping.");
+        return 0;
+    }
+
+    /* Inside a session, the terminal is configured only once
+     * and every `getch` call reads from the configured terminal.
+     */
+    printf("Type some keys, press 'q' to stop: ");
+    int c;
+    while ((c = getch()) != 'q') {
+        putch(c);
+    }
+
+    conio_session_end();  /* Terminal settings are restored here */
+
+    printf("\nSession ended, input is line-buffered again: ");
+    getchar();
+
+    printf("\n[Test Passed]\n");
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file test_size.c
+ *
+ * @brief Test for the cached terminal size (`conio_getsize()`) and the resize
+ *        callback (`conio_on_resize()`).
+ *
+ * The terminal is a pseudo terminal (`openpty()`) resized by this process, which
+ * raises `SIGWINCH` itself. This test runs unattended.
+ *
+ * Build (on Linux): `cc -o test_size tests/test_size.c -lutil`
+ */
+
+#include "test_util.h"
+#include <pty.h>
+
+static int app_winch = 0;  /* SIGWINCH received by the handler of the application */
+static int resizes = 0;
+static cpos_t last_cols = 0, last_rows = 0;
+
+static void app_handler(int sig) {
+    (void)sig;
+    app_winch++;
+}
+
+static int info_winch = 0;  /* SIGWINCH received with its information by an SA_SIGINFO handler */
+
+static void app_info_handler(int sig, siginfo_t* info, void* uc) {
+    if (info && info->si_signo == sig && uc) info_winch++;
+}
+
+static void on_size(conio_term_t* term, cpos_t cols, cpos_t rows, void* user) {
+    (void)term; (void)user;
+    resizes++;
+    last_cols = cols;
+    last_rows = rows;
+}
+
+static void set_size(int fd, int cols, int rows) {
+    struct winsize ws;
+    memset(&ws, 0, sizeof(ws));
+    ws.ws_col = (unsigned short)cols;
+    ws.ws_row = (unsigned short)rows;
+    ioctl(fd, TIOCSWINSZ, &ws);
+}
+
+int main(void) {
+    conio_term_t *term, *t2, *t3;
+    conio_vterm_t vt;
+    struct sigaction current;
+    cpos_t cols = 0, rows = 0;
+    int master, slave, fds[2];
+
+    puts("Test: conio_getsize, conio_on_resize\n");
+    if (openpty(&master, &slave, NULL, NULL, NULL) != 0 || pipe(fds) != 0) return 1;
+    set_size(master, 80, 24);
+    signal(SIGWINCH, app_handler);
+
+    term = conio_term_new(slave, slave);
+    check(conio_getsize_ctx(term, &cols, &rows) == 0 && cols == 80 && rows == 24,
+          "conio_getsize_ctx: wrong size");
+    conio_on_resize_ctx(term, on_size, NULL);
+
+    /* The size is cached until the terminal signals a resize */
+    set_size(master, 100, 30);
+    check(conio_getsize_ctx(term, &cols, &rows) == 0 && cols == 80 && rows == 24 && resizes == 0,
+          "conio_getsize_ctx: the size was read again without a signal");
+    raise(SIGWINCH);
+    check(app_winch == 1, "SIGWINCH: the handler of the application was not called");
+    check(conio_getsize_ctx(term, &cols, &rows) == 0 && cols == 100 && rows == 30,
+          "conio_getsize_ctx: the new size was not read");
+    check(resizes == 1 && last_cols == 100 && last_rows == 30, "conio_on_resize_ctx: wrong callback");
+
+    /* The callback is only called when the size changes */
+    raise(SIGWINCH);
+    check(conio_getsize_ctx(term, NULL, NULL) == 0 && resizes == 1, "conio_on_resize_ctx: no change");
+
+    /* Not a terminal */
+    t2 = conio_term_new(fds[0], fds[1]);
+    check(conio_getsize_ctx(t2, &cols, &rows) == -1, "conio_getsize_ctx: expected an unknown size");
+
+    /* The size of a backend */
+    t3 = conio_term_new(-1, -1);
+    if (conio_vterm_init(&vt, 40, 10) != 0) return 1;
+    conio_set_backend_ctx(t3, &vt.backend);
+    check(conio_getsize_ctx(t3, &cols, &rows) == 0 && cols == 40 && rows == 10,
+          "conio_getsize_ctx: wrong size of the backend");
+
+    /* The handler of the application is restored with the last context */
+    conio_term_free(term);
+    conio_term_free(t2);
+    conio_term_free(t3);
+    sigaction(SIGWINCH, NULL, &current);
+    check(current.sa_handler == app_handler, "conio_term_free: the previous handler was not restored");
+
+    /* The information is passed on to a handler taking it */
+    memset(&current, 0, sizeof(current));
+    current.sa_sigaction = app_info_handler;
+    current.sa_flags = SA_SIGINFO;
+    sigemptyset(&current.sa_mask);
+    sigaction(SIGWINCH, &current, NULL);
+    term = conio_term_new(slave, slave);
+    check(conio_getsize_ctx(term, &cols, &rows) == 0, "conio_getsize_ctx: failed");
+    raise(SIGWINCH);
+    check(info_winch == 1, "SIGWINCH: the signal information was not passed on");
+    conio_term_free(term);
+
+    conio_vterm_free(&vt);
+    close(master);
+    close(slave);
+    close(fds[0]);
+    close(fds[1]);
+
+    return test_result();
+}
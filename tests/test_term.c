@@ -0,0 +1,106 @@
+/**
+ * @file test_term.c
+ *
+ * @brief Test for the terminal contexts (`conio_term_*` and the `_ctx` functions).
+ *
+ * Two contexts drive two in-memory terminals side by side. Like `test_vterm.c`,
+ * this test does not need a terminal and runs unattended.
+ */
+
+#include "test_util.h"
+
+static void expect_row(conio_vterm_t* vt, cpos_t y, const char* expected) {
+    char line[256];
+    conio_vterm_row(vt, y, line, sizeof(line));
+    if (strcmp(line, expected) != 0) {
+        fprintf(stderr, "row %d: expected \"%s\", got \"%s\"\n", (int)y, expected, line);
+        failures++;
+    }
+}
+
+int main(void) {
+    conio_vterm_t vt1, vt2;
+    conio_term_t *t1, *t2;
+    cpos_t x = 0, y = 0;
+    char buf[16];
+
+    puts("Test: conio_term_new, conio_term_free, _ctx functions\n");
+    if (conio_vterm_init(&vt1, 20, 5) != 0 || conio_vterm_init(&vt2, 10, 3) != 0) return 1;
+    t1 = conio_term_new(-1, -1);
+    t2 = conio_term_new(-1, -1);
+    if (!t1 || !t2) return 1;
+    conio_set_backend_ctx(t1, &vt1.backend);
+    conio_set_backend_ctx(t2, &vt2.backend);
+
+    /* Output goes to the terminal of its context only */
+    conio_setflush_ctx(t2, 0, 0);
+    gotoxy_ctx(t1, 2, 2); cputs_ctx(t1, "first");
+    gotoxy_ctx(t2, 1, 3); cputs_ctx(t2, "second");
+    expect_row(&vt1, 2, " first");
+    expect_row(&vt2, 3, "");  /* Still buffered */
+    conio_flush_ctx(t2);
+    expect_row(&vt2, 3, "second");
+    expect_row(&vt1, 3, "");
+
+    /* Each context tracks its own cursor */
+    conio_session_begin_ctx(t1);
+    conio_cursor_track_ctx(t1, 1);
+    wherexy_ctx(t1, &x, &y);
+    if (x != 7 || y != 2) {
+        fprintf(stderr, "wherexy_ctx(t1): expected 7,2, got %d,%d\n", (int)x, (int)y);
+        failures++;
+    }
+    wherexy_ctx(t2, &x, &y);
+    if (x != 7 || y != 3) {
+        fprintf(stderr, "wherexy_ctx(t2): expected 7,3, got %d,%d\n", (int)x, (int)y);
+        failures++;
+    }
+
+    /* Input is read from the terminal of its context only */
+    conio_vterm_feed(&vt1, "a", 1);
+    conio_vterm_feed(&vt2, "b", 1);
+    if (getch_ctx(t2) != 'b' || getch_ctx(t1) != 'a' || kbhit_ctx(t1) || kbhit_ctx(t2)) {
+        fputs("getch_ctx: the keys were mixed up\n", stderr);
+        failures++;
+    }
+    conio_vterm_feed(&vt2, "42\n", 3);
+    if (cscanf_ctx(t2, (char*)"%15s", buf) != 1 || strcmp(buf, "42") != 0) {
+        fputs("cscanf_ctx: expected \"42\"\n", stderr);
+        failures++;
+    }
+
+    /* Off-screen buffers are independent */
+    conio_screen_init_ctx(t1, 0, 0);
+    conio_screen_init_ctx(t2, 0, 0);
+    conio_screen_puts_ctx(t1, 1, 1, "one", CONIO_ATTR_DEFAULT);
+    conio_screen_puts_ctx(t2, 1, 1, "two", CONIO_ATTR_DEFAULT);
+    conio_present_ctx(t1);
+    conio_present_ctx(t2);
+    expect_row(&vt1, 1, "one");
+    expect_row(&vt2, 1, "two");
+
+    /* Control characters are stored as blanks, never written as is */
+    conio_screen_putc_ctx(t1, 4, 1, 0x1B, CONIO_ATTR_DEFAULT);
+    conio_screen_putc_ctx(t1, 5, 1, 0x7F, CONIO_ATTR_DEFAULT);
+    conio_screen_puts_ctx(t1, 6, 1, "\a!", CONIO_ATTR_DEFAULT);
+    conio_present_ctx(t1);
+    expect_row(&vt1, 1, "one   !");
+
+    /* The default context is unaffected */
+    if (conio_term_default()->be != NULL) {
+        fputs("conio_term_default: unexpected backend\n", stderr);
+        failures++;
+    }
+
+    /* Freeing flushes and ends the session */
+    conio_setflush_ctx(t1, 0, 0);
+    gotoxy_ctx(t1, 1, 5); cputs_ctx(t1, "bye");
+    conio_term_free(t1);
+    conio_term_free(t2);
+    expect_row(&vt1, 5, "bye");
+
+    conio_vterm_free(&vt1);
+    conio_vterm_free(&vt2);
+
+    return test_result();
+}
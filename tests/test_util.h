@@ -0,0 +1,103 @@
+/**
+ * @file test_util.h
+ *
+ * @brief Helpers shared by the unattended tests: the failure counter and a backend
+ *        that records the output and counts the calls before passing them to an
+ *        in-memory terminal.
+ *
+ * Include it in place of `conio_lt.h`.
+ */
+
+#ifndef CONIO_TEST_UTIL_H_
+#define CONIO_TEST_UTIL_H_
+
+#include "../conio_lt.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+/* Reports the failure if the condition does not hold */
+static inline void check(int ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+/* Prints the result of the test, returns the exit status */
+static inline int test_result(void) {
+    if (failures) {
+        printf("\n[Test Failed] %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("\n[Test Passed]\n");
+    return 0;
+}
+
+typedef struct test_backend test_backend_t;
+
+/* Backend that records the output and counts the calls before passing them to the emulator */
+struct test_backend {
+    conio_backend_t backend;
+    conio_vterm_t   vt;
+    char            out[4096];  /* The output since `len` was reset, while it fits */
+    size_t          len;
+    size_t          bytes;      /* Number of bytes written */
+    int             writes;     /* Number of writes */
+    int             reads;      /* Number of reads */
+    int             queries;    /* Number of cursor position queries written */
+    int             mute;       /* Non-zero to ignore the cursor position query ending a write */
+    int             bytewise;   /* Non-zero to serve one byte per read */
+    int             wait;       /* Non-zero to wait out the timeout of a read without input */
+    int             answer;     /* How the filter answers the queries, up to the test */
+    int             probes;     /* Number of probes seen by the filter */
+    /* Passes the output to the emulator in place of the default, may be `NULL` */
+    int (*filter)(test_backend_t* tb, const char* s, size_t n);
+};
+
+static inline int tb_output(conio_backend_t* be, const char* s, size_t n) {
+    test_backend_t* tb = (test_backend_t*)be;
+    size_t i;
+
+    tb->writes++;
+    tb->bytes += n;
+    if (tb->len + n < sizeof(tb->out)) {
+        memcpy(tb->out + tb->len, s, n);
+        tb->len += n;
+        tb->out[tb->len] = '\0';
+    }
+    for (i = 0; i + 4 <= n; i++) {
+        if (memcmp(s + i, "\033[6n", 4) == 0) tb->queries++;
+    }
+    if (tb->filter) return tb->filter(tb, s, n);
+    if (tb->mute && n >= 4 && memcmp(s + n - 4, "\033[6n", 4) == 0) n -= 4;
+    conio_vterm_write(&tb->vt, s, n);
+    return 0;
+}
+
+static inline int tb_input(conio_backend_t* be, unsigned char* buf, size_t n, int timeout_ms) {
+    test_backend_t* tb = (test_backend_t*)be;
+    int r;
+
+    tb->reads++;
+    r = tb->vt.backend.input(&tb->vt.backend, buf, tb->bytewise ? 1 : n, timeout_ms);
+    if (r == 0 && tb->wait && timeout_ms > 0) usleep((useconds_t)timeout_ms * 1000);  /* Like a terminal */
+    return r;
+}
+
+static inline int tb_getsize(conio_backend_t* be, cpos_t* cols, cpos_t* rows) {
+    test_backend_t* tb = (test_backend_t*)be;
+    return tb->vt.backend.getsize(&tb->vt.backend, cols, rows);
+}
+
+/* Sets up the backend with an emulator of the given size, returns 0 on success */
+static inline int tb_init(test_backend_t* tb, cpos_t cols, cpos_t rows) {
+    memset(tb, 0, sizeof(*tb));
+    tb->backend.output = tb_output;
+    tb->backend.input = tb_input;
+    tb->backend.getsize = tb_getsize;
+    return conio_vterm_init(&tb->vt, cols, rows);
+}
+
+#endif  /* CONIO_TEST_UTIL_H_ */
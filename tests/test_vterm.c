@@ -0,0 +1,86 @@
+/**
+ * @file test_vterm.c
+ *
+ * @brief Test for the in-memory terminal backend (`conio_vterm_*` and `conio_set_backend`).
+ *
+ * Unlike the other tests, this test does not need a terminal and runs unattended.
+ */
+
+#include "test_util.h"
+
+static void expect_row(conio_vterm_t* vt, cpos_t y, const char* expected) {
+    char line[256];
+    conio_vterm_row(vt, y, line, sizeof(line));
+    if (strcmp(line, expected) != 0) {
+        fprintf(stderr, "row %d: expected \"%s\", got \"%s\"\n", (int)y, expected, line);
+        failures++;
+    }
+}
+
+int main(void) {
+    conio_vterm_t vt;
+    cpos_t x = 0, y = 0;
+
+    puts("Test: conio_set_backend, conio_vterm\n");
+    if (conio_vterm_init(&vt, 20, 5) != 0) return 1;
+    conio_set_backend(&vt.backend);
+
+    /* Drawing with gotoxy and cputs */
+    clrscr();
+    gotoxy(3, 2); cputs("Hello");
+    gotoxy(1, 4); cputs("line four");
+    expect_row(&vt, 1, "");
+    expect_row(&vt, 2, "  Hello");
+    expect_row(&vt, 4, "line four");
+
+    /* Cursor position queries are answered locally */
+    wherexy(&x, &y);
+    if (x != 10 || y != 4) {
+        fprintf(stderr, "wherexy: expected 10,4, got %d,%d\n", (int)x, (int)y);
+        failures++;
+    }
+
+    /* Line deletion */
+    gotoxy(5, 2); delline();
+    expect_row(&vt, 2, "");
+    dellines(4, 4);
+    expect_row(&vt, 4, "");
+
+    /* Wrapping and scrolling */
+    gotoxy(1, 5); cputs("0123456789abcdefghijKL");
+    expect_row(&vt, 4, "0123456789abcdefghij");
+    expect_row(&vt, 5, "KL");
+
+    /* Attributes */
+    conio_screen_init(0, 0);
+    conio_screen_puts(1, 1, "Err", CONIO_FG(1) | CONIO_ATTR_BOLD);
+    conio_present();
+    expect_row(&vt, 1, "Err");
+    if (conio_vterm_cell(&vt, 2, 1)->attr != (CONIO_FG(1) | CONIO_ATTR_BOLD)) {
+        fputs("attributes of cell 2,1 do not match\n", stderr);
+        failures++;
+    }
+    conio_screen_free();
+
+    /* Input */
+    conio_vterm_feed(&vt, "q" ESC "[A", 4);
+    if (!kbhit() || getch() != 'q') {
+        fputs("getch: expected 'q'\n", stderr);
+        failures++;
+    } else {
+        conio_event_t ev;
+        if (conio_read_event(&ev) != 0 || ev.key != CONIO_KEY_UP) {
+            fputs("conio_read_event: expected the up key\n", stderr);
+            failures++;
+        }
+    }
+    if (kbhit()) {
+        fputs("kbhit: expected no input\n", stderr);
+        failures++;
+    }
+
+    conio_set_backend(NULL);
+    conio_vterm_free(&vt);
+
+    return test_result();
+}